@@ -18,6 +18,9 @@
  */
 
 #include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
 
@@ -131,7 +134,7 @@ static int encode_n4(const struct osmo_conv_code *code,
 		output[4 * i + 0] = PARITY(reg & gen[0]);
 		output[4 * i + 1] = PARITY(reg & gen[1]);
 		output[4 * i + 2] = PARITY(reg & gen[2]);
-		output[4 * i + 3] = PARITY(reg & gen[2]);
+		output[4 * i + 3] = PARITY(reg & gen[3]);
 		reg = reg >> 1;
 	}
 
@@ -142,7 +145,7 @@ static int encode_n4(const struct osmo_conv_code *code,
 		output[4 * i + 0] = PARITY(reg & gen[0]);
 		output[4 * i + 1] = PARITY(reg & gen[1]);
 		output[4 * i + 2] = PARITY(reg & gen[2]);
-		output[4 * i + 3] = PARITY(reg & gen[2]);
+		output[4 * i + 3] = PARITY(reg & gen[3]);
 		reg = reg >> 1;
 	}
 
@@ -230,7 +233,7 @@ static int encode_rec_n4(const struct osmo_conv_code *code,
 		output[4 * i + m0] = input[i];
 		output[4 * i + m1] = PARITY(reg & gen[m1]);
 		output[4 * i + m2] = PARITY(reg & gen[m2]);
-		output[4 * i + m3] = PARITY(reg & gen[m2]);
+		output[4 * i + m3] = PARITY(reg & gen[m3]);
 		reg = reg >> 1;
 	}
 
@@ -241,7 +244,7 @@ static int encode_rec_n4(const struct osmo_conv_code *code,
 		output[4 * i + m0] = PARITY(reg & rgen);
 		output[4 * i + m1] = PARITY(reg & gen[m1]);
 		output[4 * i + m2] = PARITY(reg & gen[m2]);
-		output[4 * i + m3] = PARITY(reg & gen[m2]);
+		output[4 * i + m3] = PARITY(reg & gen[m3]);
 		reg = reg >> 1;
 	}
 
@@ -289,16 +292,16 @@ static int encode_rec_gen(const struct osmo_conv_code *code,
 	int n = code->N;
 	int len = code->len;
 	int i, j, k = code->K;
-	int p[n];
+	unsigned p = 0;
 
 	for (i = 0; i < n; i++)
-		p[i] = POPCNT(gen[i]) == 1;
+		p |= (POPCNT(gen[i]) == 1) << i;
 
 	for (i = 0; i < len; i++) {
 		reg |= (PARITY((reg & rgen)) ^ input[i]) << (k - 1);
 
 		for (j = 0; j < n; j++) {
-			if (p[j])
+			if ((p >> j) & 1)
 				output[n * i + j] = input[i];
 			else
 				output[n * i + j] = PARITY(reg & gen[j]);
@@ -311,7 +314,7 @@ static int encode_rec_gen(const struct osmo_conv_code *code,
 
 	for (i = len; i < len + k - 1; i++) {
 		for (j = 0; j < n; j++) {
-			if (p[j])
+			if ((p >> j) & 1)
 				output[n * i + j] = PARITY(reg & rgen);
 			else
 				output[n * i + j] = PARITY(reg & gen[j]);
@@ -324,11 +327,10 @@ static int encode_rec_gen(const struct osmo_conv_code *code,
 
 static int conv_encode(const struct osmo_conv_code *code,
 		       const unsigned *gen, const ubit_t *input,
-		       ubit_t *output)
+		       ubit_t *output, ubit_t *unpunct)
 {
 	int l;
 	ubit_t *_output;
-	ubit_t unpunct[(code->len + code->K - 1) * code->N];
 
 	if (code->puncture)
 		_output = unpunct;
@@ -358,11 +360,11 @@ static int conv_encode(const struct osmo_conv_code *code,
 
 static int conv_encode_rec(const struct osmo_conv_code *code,
 			   const unsigned rgen, const unsigned *gen,
-			   const ubit_t *input, ubit_t *output)
+			   const ubit_t *input, ubit_t *output,
+			   ubit_t *unpunct)
 {
 	int l, pos = -1, cnt = 0;
 	ubit_t *_output;
-	ubit_t unpunct[(code->len + code->K - 1) * code->N];
 
 	if (code->term == CONV_TERM_TAIL_BITING)
 		return -ENOTSUP;
@@ -408,15 +410,703 @@ puncture:
 	return code->N * l;
 }
 
+/* Encoder workspace size
+ *     Punctured codes are encoded into an unpunctured buffer before the
+ *     puncturing pass. Other codes write the output directly and need no
+ *     workspace.
+ */
+int conv_encode_workspace_size(const struct osmo_conv_code *code)
+{
+	if ((code->N < 2) || (code->K < 3))
+		return -EINVAL;
+
+	if (!code->puncture)
+		return 0;
+
+	return (code->len + code->K - 1) * code->N * sizeof(ubit_t);
+}
+
+/* Encode with a caller provided workspace
+ *     No heap allocation is made and stack use does not depend on the
+ *     frame length. The workspace must hold at least
+ *     conv_encode_workspace_size() bytes.
+ */
+int test_conv_encode_ws(const struct osmo_conv_code *code,
+			const unsigned rgen, const unsigned *gen,
+			const ubit_t *input, ubit_t *output,
+			void *ws, size_t size)
+{
+	int len = conv_encode_workspace_size(code);
+
+	if (len < 0)
+		return len;
+	if (size < (size_t) len)
+		return -ENOSPC;
+
+	if (code->next_term_output)
+		return conv_encode_rec(code, rgen, gen, input, output, ws);
+
+	return conv_encode(code, gen, input, output, ws);
+}
+
 int test_conv_encode(const struct osmo_conv_code *code,
 		     const unsigned rgen, const unsigned *gen,
 		     const ubit_t *input, ubit_t *output)
 {
-	if ((code->N < 2) || (code->K < 5))
+	int rc, len;
+	ubit_t *unpunct = NULL;
+
+	len = conv_encode_workspace_size(code);
+	if (len < 0)
+		return len;
+
+	if (len) {
+		unpunct = (ubit_t *) malloc(len);
+		if (!unpunct)
+			return -ENOMEM;
+	}
+
+	rc = test_conv_encode_ws(code, rgen, gen, input, output, unpunct, len);
+	free(unpunct);
+
+	return rc;
+}
+
+/* Packed Encoder
+ *     Table driven encoder operating on packed input and output bits. Each
+ *     table step advances the encoder by four input bits. Remaining input
+ *     bits and the flush are encoded one bit at a time.
+ *
+ *     n      - Code order
+ *     k      - Constraint length
+ *     len    - Number of input bits
+ *     term   - Termination type
+ *     rgen   - Feedback generator or zero if the code is not recursive
+ *     out4   - Output bits of four input bits, indexed by state and nibble
+ *     next4  - Next state after four input bits
+ *     out1   - Output bits of one input bit, indexed by state and bit
+ *     next1  - Next state after one input bit
+ *     keep4  - Kept output bits of each four bit step or NULL
+ *     keep1  - Kept output bits of each single bit step or NULL
+ *     pext   - Kept bits of a nibble compacted, indexed by mask and value
+ */
+struct vencoder {
+	int n;
+	int k;
+	int len;
+	int term;
+	unsigned rgen;
+	uint16_t *out4;
+	uint8_t *next4;
+	uint8_t *out1;
+	uint8_t *next1;
+	uint16_t *keep4;
+	uint8_t *keep1;
+	uint8_t pext[256];
+};
+
+/* Bit writer for MSB first packed output */
+struct vbitwriter {
+	pbit_t *out;
+	unsigned acc;
+	int bits;
+	int cnt;
+};
+
+static const uint8_t nibble_bits[16] = {
+	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+};
+
+/* Single encoder step shared by the table generation
+ *     Returns the 'n' output bits with the first output in the most
+ *     significant position and advances the state. Systematic outputs of
+ *     recursive codes carry the input bit.
+ */
+static unsigned encode_step(const struct osmo_conv_code *code,
+			    unsigned rgen, const unsigned *gen,
+			    unsigned *state, int bit)
+{
+	unsigned reg, out = 0;
+	int j, k = code->K;
+
+	if (rgen)
+		reg = *state | ((PARITY(*state & rgen) ^ bit) << (k - 1));
+	else
+		reg = *state | (bit << (k - 1));
+
+	for (j = 0; j < code->N; j++) {
+		out <<= 1;
+		if (rgen && (POPCNT(gen[j]) == 1))
+			out |= bit;
+		else
+			out |= PARITY(reg & gen[j]);
+	}
+
+	*state = reg >> 1;
+
+	return out;
+}
+
+/* Generate output and next state tables for one and four bit steps */
+static int gen_encoder_tables(struct vencoder *enc,
+			      const struct osmo_conv_code *code,
+			      const unsigned *gen)
+{
+	unsigned s, v, state, out;
+	int i, ns = 1 << (enc->k - 1);
+
+	enc->out4 = (uint16_t *) malloc(sizeof(uint16_t) * ns * 16);
+	enc->next4 = (uint8_t *) malloc(ns * 16);
+	enc->out1 = (uint8_t *) malloc(ns * 2);
+	enc->next1 = (uint8_t *) malloc(ns * 2);
+	if (!enc->out4 || !enc->next4 || !enc->out1 || !enc->next1)
+		return -ENOMEM;
+
+	for (s = 0; s < ns; s++) {
+		for (v = 0; v < 2; v++) {
+			state = s;
+			enc->out1[2 * s + v] = encode_step(code, enc->rgen,
+							   gen, &state, v);
+			enc->next1[2 * s + v] = state;
+		}
+
+		for (v = 0; v < 16; v++) {
+			state = s;
+			out = 0;
+			for (i = 3; i >= 0; i--) {
+				out <<= enc->n;
+				out |= encode_step(code, enc->rgen, gen,
+						   &state, (v >> i) & 1);
+			}
+			enc->out4[16 * s + v] = out;
+			enc->next4[16 * s + v] = state;
+		}
+	}
+
+	return 0;
+}
+
+/* Generate puncturing keep-masks
+ *     Walk the negative value terminated puncturing matrix once and record
+ *     the transmitted output bits of every step, first output bit in the
+ *     most significant position.
+ */
+static int gen_encoder_keep(struct vencoder *enc, const int *punc, int steps)
+{
+	int i, j, n = enc->n;
+
+	enc->keep1 = (uint8_t *) malloc(steps);
+	enc->keep4 = (uint16_t *) malloc(sizeof(uint16_t) * (steps / 4 + 1));
+	if (!enc->keep1 || !enc->keep4)
+		return -ENOMEM;
+
+	for (i = 0; i < steps; i++) {
+		enc->keep1[i] = 0;
+		for (j = 0; j < n; j++) {
+			enc->keep1[i] <<= 1;
+			if (i * n + j == *punc)
+				punc++;
+			else
+				enc->keep1[i] |= 1;
+		}
+	}
+
+	for (i = 0; i < steps / 4; i++) {
+		enc->keep4[i] = 0;
+		for (j = 0; j < 4; j++) {
+			enc->keep4[i] <<= n;
+			enc->keep4[i] |= enc->keep1[4 * i + j];
+		}
+	}
+
+	return 0;
+}
+
+void conv_encoder_free(struct vencoder *enc)
+{
+	if (!enc)
+		return;
+
+	free(enc->keep4);
+	free(enc->keep1);
+	free(enc->next1);
+	free(enc->out1);
+	free(enc->next4);
+	free(enc->out4);
+	free(enc);
+}
+
+/* Packed encoder creation
+ *     Output tables are derived from the generator polynomials for the
+ *     constraint lengths of the decoder, K = 3 to 9. Recursive codes require
+ *     at least one systematic output and, as with the unpacked encoder, are
+ *     not supported with tail-biting termination.
+ */
+struct vencoder *conv_encoder_create(const struct osmo_conv_code *code,
+				     const unsigned rgen, const unsigned *gen)
+{
+	int i, m, v, cnt = 0, steps;
+	struct vencoder *enc;
+
+	if ((code->N < 2) || (code->N > 4) || (code->K < 3) || (code->K > 9))
+		return NULL;
+
+	if (code->next_term_output) {
+		if (code->term == CONV_TERM_TAIL_BITING)
+			return NULL;
+		for (i = 0; i < code->N; i++)
+			cnt += POPCNT(gen[i]) == 1;
+		if (cnt < 1)
+			return NULL;
+	}
+
+	enc = (struct vencoder *) calloc(1, sizeof(struct vencoder));
+	if (!enc)
+		return NULL;
+
+	enc->n = code->N;
+	enc->k = code->K;
+	enc->len = code->len;
+	enc->term = code->term;
+	enc->rgen = code->next_term_output ? rgen : 0;
+
+	if (gen_encoder_tables(enc, code, gen) < 0)
+		goto fail;
+
+	steps = code->len;
+	if (code->term == CONV_TERM_FLUSH)
+		steps += code->K - 1;
+
+	if (code->puncture &&
+	    (gen_encoder_keep(enc, code->puncture, steps) < 0))
+		goto fail;
+
+	for (m = 0; m < 16; m++) {
+		for (v = 0; v < 16; v++) {
+			enc->pext[16 * m + v] = 0;
+			for (i = 3; i >= 0; i--) {
+				if (!(m & (1 << i)))
+					continue;
+				enc->pext[16 * m + v] <<= 1;
+				enc->pext[16 * m + v] |= (v >> i) & 1;
+			}
+		}
+	}
+
+	return enc;
+fail:
+	conv_encoder_free(enc);
+	return NULL;
+}
+
+static inline void put_bits(struct vbitwriter *w, unsigned val, int n)
+{
+	w->acc = (w->acc << n) | val;
+	w->bits += n;
+	w->cnt += n;
+
+	while (w->bits >= 8) {
+		w->bits -= 8;
+		*w->out++ = w->acc >> w->bits;
+	}
+}
+
+/* Write the kept bits of 'n' output bits, a multiple of four, by nibble */
+static inline void put_punct(const struct vencoder *enc, struct vbitwriter *w,
+			     unsigned val, unsigned keep, int n)
+{
+	unsigned m;
+
+	if (keep == (1U << n) - 1) {
+		put_bits(w, val, n);
+		return;
+	}
+
+	for (n -= 4; n >= 0; n -= 4) {
+		m = (keep >> n) & 0xf;
+		put_bits(w, enc->pext[16 * m + ((val >> n) & 0xf)],
+			 nibble_bits[m]);
+	}
+}
+
+static inline int get_bit(const pbit_t *in, int i)
+{
+	return (in[i >> 3] >> (7 - (i & 7))) & 1;
+}
+
+/* Packed encode
+ *     Input and output bits are packed MSB first. Returns the number of
+ *     output bits written. The last output byte is zero padded.
+ */
+int conv_encoder_run(struct vencoder *enc,
+		     const pbit_t *input, pbit_t *output)
+{
+	unsigned state = 0, idx;
+	int i, bit, end, n = enc->n, len = enc->len;
+	struct vbitwriter w = { .out = output };
+
+	end = len;
+	if (enc->term == CONV_TERM_FLUSH)
+		end += enc->k - 1;
+
+	if (enc->term == CONV_TERM_TAIL_BITING) {
+		for (i = 0; i < enc->k - 1; i++)
+			state |= get_bit(input, len - 1 - i) << (enc->k - 2 - i);
+	}
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		idx = 16 * state + ((input[i >> 3] >> (4 - (i & 4))) & 0xf);
+		if (enc->keep4)
+			put_punct(enc, &w, enc->out4[idx],
+				  enc->keep4[i / 4], 4 * n);
+		else
+			put_bits(&w, enc->out4[idx], 4 * n);
+		state = enc->next4[idx];
+	}
+
+	for (; i < end; i++) {
+		if (i < len)
+			bit = get_bit(input, i);
+		else
+			bit = enc->rgen ? PARITY(state & enc->rgen) : 0;
+
+		idx = 2 * state + bit;
+		if (enc->keep1)
+			put_punct(enc, &w, enc->out1[idx], enc->keep1[i], 4);
+		else
+			put_bits(&w, enc->out1[idx], n);
+		state = enc->next1[idx];
+	}
+
+	if (w.bits)
+		*w.out = w.acc << (8 - w.bits);
+
+	return w.cnt;
+}
+
+/* Bit-sliced Batch Encoder
+ *     Encode 64, 128 or 256 frames of the same code together with one frame
+ *     per bit of 64-bit words. Frames are transposed so that each word holds
+ *     one bit position of 64 frames. Each output is then the XOR of shifted
+ *     copies of the register input sequence, computed one tap at a time over
+ *     the whole frame. Only the feedback of recursive codes is serial.
+ *
+ *     n       - Code order
+ *     k       - Constraint length
+ *     len     - Number of input bits
+ *     term    - Termination type
+ *     steps   - Number of encoder steps including the flush
+ *     width   - Number of frames per batch
+ *     words   - Number of 64 frame words
+ *     ntaps   - Number of register taps of each output
+ *     taps    - Register delays tapped by each output
+ *     sys     - Set to '1' for systematic outputs of recursive codes
+ *     nfb     - Number of feedback taps or zero if the code is not recursive
+ *     fb      - Register delays tapped by the feedback
+ *     src     - Unpunctured output word of each punctured output bit
+ *     out_len - Number of output bits per frame after puncturing
+ *     x       - Transposed input after K - 1 initial register words
+ *     u       - Register input sequence after K - 1 initial words
+ *     y       - Unpunctured output, 'steps' words per output
+ *     o       - Transposed output, one word per output bit
+ */
+struct vencbatch {
+	int n;
+	int k;
+	int len;
+	int term;
+	int steps;
+	int width;
+	int words;
+	int ntaps[4];
+	int taps[4][16];
+	int sys[4];
+	int nfb;
+	int fb[16];
+	int *src;
+	int out_len;
+	uint64_t *x;
+	uint64_t *u;
+	uint64_t *y;
+	uint64_t *o;
+};
+
+/* 64x64 bit matrix transpose
+ *     Column 'c' of row 'r' is bit 63 - c of word 'r'. Word 'c' of the
+ *     result holds the column with row 'r' as bit 63 - r. Each stage swaps
+ *     'j' by 'j' bit blocks, with fixed strides so the compiler can unroll
+ *     and vectorize the inner loops.
+ */
+static inline void transpose_stage(uint64_t *a, int j, uint64_t m)
+{
+	int k, l;
+	uint64_t t;
+
+	for (k = 0; k < 64; k += 2 * j) {
+		for (l = k; l < k + j; l++) {
+			t = (a[l] ^ (a[l + j] >> j)) & m;
+			a[l] ^= t;
+			a[l + j] ^= t << j;
+		}
+	}
+}
+
+static void transpose64(uint64_t *a)
+{
+	transpose_stage(a, 32, 0x00000000ffffffffULL);
+	transpose_stage(a, 16, 0x0000ffff0000ffffULL);
+	transpose_stage(a, 8, 0x00ff00ff00ff00ffULL);
+	transpose_stage(a, 4, 0x0f0f0f0f0f0f0f0fULL);
+	transpose_stage(a, 2, 0x3333333333333333ULL);
+	transpose_stage(a, 1, 0x5555555555555555ULL);
+}
+
+void conv_encoder_batch_free(struct vencbatch *batch)
+{
+	if (!batch)
+		return;
+
+	free(batch->o);
+	free(batch->y);
+	if (batch->u != batch->x)
+		free(batch->u - batch->k + 1);
+	if (batch->x)
+		free(batch->x - batch->k + 1);
+	free(batch->src);
+	free(batch);
+}
+
+/* Batch encoder creation
+ *     Supported batch widths are 64, 128 and 256 frames and constraint
+ *     lengths are 3 to 16. Register taps are taken from the generator
+ *     polynomials as delays from the current input. The feedback excludes
+ *     the current input, as in the unpacked recursive encoder. Non-recursive
+ *     codes use the input directly as the register input sequence.
+ */
+struct vencbatch *conv_encoder_batch_create(const struct osmo_conv_code *code,
+					    const unsigned rgen,
+					    const unsigned *gen, int width)
+{
+	int i, j, d, p = 0, cnt = 0, k = code->K;
+	const int *punc = code->puncture;
+	struct vencbatch *batch;
+	uint64_t *buf;
+
+	if ((code->N < 2) || (code->N > 4) || (k < 3) || (k > 16))
+		return NULL;
+	if ((width != 64) && (width != 128) && (width != 256))
+		return NULL;
+
+	if (code->next_term_output) {
+		if (code->term == CONV_TERM_TAIL_BITING)
+			return NULL;
+		for (i = 0; i < code->N; i++)
+			cnt += POPCNT(gen[i]) == 1;
+		if (cnt < 1)
+			return NULL;
+	}
+
+	batch = (struct vencbatch *) calloc(1, sizeof(struct vencbatch));
+	if (!batch)
+		return NULL;
+
+	batch->n = code->N;
+	batch->k = k;
+	batch->len = code->len;
+	batch->term = code->term;
+	batch->width = width;
+	batch->words = width / 64;
+
+	batch->steps = code->len;
+	if (code->term == CONV_TERM_FLUSH)
+		batch->steps += k - 1;
+
+	for (j = 0; j < batch->n; j++) {
+		batch->sys[j] = code->next_term_output && (POPCNT(gen[j]) == 1);
+		for (d = 0; d < k; d++) {
+			if (gen[j] & (1 << (k - 1 - d)))
+				batch->taps[j][batch->ntaps[j]++] = d;
+		}
+	}
+
+	if (code->next_term_output) {
+		for (d = 1; d < k; d++) {
+			if (rgen & (1 << (k - 1 - d)))
+				batch->fb[batch->nfb++] = d;
+		}
+	}
+
+	batch->src = (int *) malloc(sizeof(int) * batch->steps * batch->n);
+	if (!batch->src)
+		goto fail;
+
+	for (i = 0; i < batch->steps; i++) {
+		for (j = 0; j < batch->n; j++) {
+			if (punc && (i * batch->n + j == *punc))
+				punc++;
+			else
+				batch->src[p++] = j * batch->steps + i;
+		}
+	}
+	batch->out_len = p;
+
+	/* Input words are loaded 64 bit positions at a time */
+	buf = (uint64_t *) calloc(k - 1 + ((batch->steps + 63) & ~63),
+				  sizeof(uint64_t));
+	if (!buf)
+		goto fail;
+	batch->x = buf + k - 1;
+	batch->u = batch->x;
+
+	if (batch->nfb) {
+		buf = (uint64_t *) calloc(k - 1 + batch->steps,
+					  sizeof(uint64_t));
+		if (!buf)
+			goto fail;
+		batch->u = buf + k - 1;
+	}
+
+	batch->y = (uint64_t *) malloc(sizeof(uint64_t) *
+				       batch->steps * batch->n);
+	batch->o = (uint64_t *) malloc(sizeof(uint64_t) * ((p + 63) & ~63));
+	if (!batch->y || !batch->o)
+		goto fail;
+
+	return batch;
+fail:
+	conv_encoder_batch_free(batch);
+	return NULL;
+}
+
+/* Transpose the input bits of 64 frames into one word per bit position
+ *     Frames are read 64 bits at a time with the first bit in the most
+ *     significant position. Frame 'f' becomes bit 63 - f of each word.
+ *     Flush positions are cleared.
+ */
+static void batch_load_bits(struct vencbatch *batch,
+			    const pbit_t * const *input)
+{
+	int b, f, n, bytes = (batch->len + 7) / 8;
+	uint64_t v, *x;
+
+	for (b = 0; b < bytes; b += 8) {
+		x = &batch->x[8 * b];
+		n = bytes - b < 8 ? bytes - b : 8;
+
+		for (f = 0; f < 64; f++) {
+			v = 0;
+			if (n == 8)
+				memcpy(&v, &input[f][b], 8);
+			else
+				memcpy(&v, &input[f][b], n);
+			x[f] = __builtin_bswap64(v);
+		}
+
+		transpose64(x);
+	}
+
+	for (b = batch->len; b < batch->steps; b++)
+		batch->x[b] = 0;
+}
+
+/* Transpose one word per output bit back into packed frame output
+ *     Whole 64-bit chunks are copied with fixed size moves, and only the last
+ *     partial chunk of each frame takes a variable length copy.
+ */
+static void batch_store_bits(struct vencbatch *batch, uint64_t *o,
+			     pbit_t **output)
+{
+	int b, f, n, bytes = (batch->out_len + 7) / 8;
+	uint64_t v;
+
+	for (b = 0; b < bytes; b += 8) {
+		n = bytes - b < 8 ? bytes - b : 8;
+
+		transpose64(&o[8 * b]);
+		for (f = 0; f < 64; f++) {
+			v = __builtin_bswap64(o[8 * b + f]);
+			if (n == 8)
+				memcpy(&output[f][b], &v, 8);
+			else
+				memcpy(&output[f][b], &v, n);
+		}
+	}
+}
+
+/* Encode 64 frames held in the transposed input
+ *     Flush steps of recursive codes take the feedback as input, which
+ *     clears the register and is sent on the systematic outputs.
+ */
+static void batch_encode_word(struct vencbatch *batch)
+{
+	int i, j, t, d, k = batch->k, steps = batch->steps;
+	uint64_t fb, *x = batch->x, *u = batch->u, *y;
+
+	for (i = 1; i < k; i++) {
+		if (batch->term == CONV_TERM_TAIL_BITING)
+			u[-i] = x[batch->len - i];
+		else
+			u[-i] = 0;
+	}
+
+	if (batch->nfb) {
+		for (i = 0; i < steps; i++) {
+			fb = 0;
+			for (t = 0; t < batch->nfb; t++)
+				fb ^= u[i - batch->fb[t]];
+
+			if (i < batch->len) {
+				u[i] = x[i] ^ fb;
+			} else {
+				x[i] = fb;
+				u[i] = 0;
+			}
+		}
+	}
+
+	for (j = 0; j < batch->n; j++) {
+		y = &batch->y[j * steps];
+
+		if (batch->sys[j]) {
+			memcpy(y, x, sizeof(uint64_t) * steps);
+			continue;
+		}
+
+		d = batch->taps[j][0];
+		for (i = 0; i < steps; i++)
+			y[i] = u[i - d];
+
+		for (t = 1; t < batch->ntaps[j]; t++) {
+			d = batch->taps[j][t];
+			for (i = 0; i < steps; i++)
+				y[i] ^= u[i - d];
+		}
+	}
+
+	for (i = 0; i < batch->out_len; i++)
+		batch->o[i] = batch->y[batch->src[i]];
+	for (; i & 63; i++)
+		batch->o[i] = 0;
+}
+
+/* Encode a batch of frames
+ *     Encode 'width' frames of packed input into packed output. Returns the
+ *     number of output bits of each frame. The last output byte of each
+ *     frame is zero padded.
+ */
+int conv_encoder_batch_run(struct vencbatch *batch,
+			   const pbit_t * const *input, pbit_t **output)
+{
+	int w;
+
+	if (!batch)
 		return -EINVAL;
 
-	if (code->next_term_output)
-		return conv_encode_rec(code, rgen, gen, input, output);
+	for (w = 0; w < batch->words; w++) {
+		batch_load_bits(batch, &input[64 * w]);
+		batch_encode_word(batch);
+		batch_store_bits(batch, batch->o, &output[64 * w]);
+	}
 
-	return conv_encode(code, gen, input, output);
+	return batch->out_len;
 }
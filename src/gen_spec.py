@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# Decoder specialization generator
+#
+# Read the convolutional code definitions from a C source file, such as
+# tests/codes.c, and write a header with one specialization entry per unique
+# combination of order, constraint length, frame length, termination and
+# puncturing pattern. The header is included by viterbi.c, which expands
+# each entry into forward and traceback routines for every kernel set.
+#
+# Puncturing is resolved here into runs of trellis steps that share the same
+# erased symbols, so the forward recursion walks a short constant table
+# instead of checking every step at run time.
+#
+# usage: gen_spec.py <codes.c> [output]
+#
+
+import re
+import sys
+
+TERMS = {
+    'CONV_TERM_FLUSH': 'CONV_TERM_FLUSH',
+    'CONV_TERM_TRUNCATION': 'CONV_TERM_TRUNCATION',
+    'CONV_TERM_TAIL_BITING': 'CONV_TERM_TAIL_BITING',
+}
+
+RE_ARRAY = re.compile(r'static\s+(?:const\s+)?int\s+(\w+)\s*\[\s*\]\s*=\s*'
+                      r'\{([^}]*)\}\s*;')
+RE_CODE = re.compile(r'(?:/\*\s*(.*?)\s*\*/\s*)?'
+                     r'const\s+struct\s+osmo_conv_code\s+(\w+)\s*=\s*'
+                     r'\{([^}]*)\}\s*;')
+RE_FIELD = re.compile(r'\.(\w+)\s*=\s*([^,]+),')
+
+
+def strip_comments(src):
+    return re.sub(r'//[^\n]*', '', src)
+
+
+def parse_arrays(src):
+    arrays = {}
+    for m in RE_ARRAY.finditer(src):
+        body = re.sub(r'/\*.*?\*/', '', m.group(2), flags=re.S)
+        arrays[m.group(1)] = [int(v, 0) for v in body.replace(',', ' ').split()]
+    return arrays
+
+
+def parse_codes(src, arrays):
+    codes = []
+    for m in RE_CODE.finditer(src):
+        fields = dict((f, v.strip()) for f, v in RE_FIELD.findall(m.group(3) + ','))
+        try:
+            n = int(fields['N'], 0)
+            k = int(fields['K'], 0)
+            length = int(fields['len'], 0)
+        except (KeyError, ValueError):
+            continue
+
+        term = TERMS.get(fields.get('term', 'CONV_TERM_FLUSH'))
+        if term is None:
+            continue
+
+        punc = None
+        if 'puncture' in fields:
+            punc = arrays.get(fields['puncture'])
+            if punc is None:
+                continue
+
+        codes.append({
+            'title': m.group(1) or m.group(2),
+            'n': n,
+            'k': k,
+            'len': length,
+            'term': term,
+            'rec': 1 if 'next_term_output' in fields else 0,
+            'punc': punc,
+        })
+    return codes
+
+
+# Group trellis steps into runs with the same erased symbols, following
+# gen_punc_map() in viterbi.c
+def punc_runs(punc, n, steps):
+    runs = []
+    p = 0
+    off = 0
+    for i in range(steps):
+        erase = 0
+        start = off
+        for j in range(n):
+            if p < len(punc) and punc[p] >= 0 and i * n + j == punc[p]:
+                erase |= 1 << j
+                p += 1
+            else:
+                off += 1
+
+        if runs and runs[-1]['erase'] == erase:
+            runs[-1]['count'] += 1
+        else:
+            runs.append({
+                'count': 1,
+                'off': start,
+                'stride': off - start,
+                'erase': erase,
+            })
+    return runs
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write('usage: %s <codes.c> [output]\n' % sys.argv[0])
+        return 1
+
+    with open(sys.argv[1]) as f:
+        src = strip_comments(f.read())
+
+    arrays = parse_arrays(src)
+    specs = []
+    for code in parse_codes(src, arrays):
+        if code['n'] < 2 or code['n'] > 4 or code['k'] < 3 or code['k'] > 9:
+            continue
+
+        key = (code['n'], code['k'], code['len'], code['term'], code['rec'],
+               tuple(code['punc']) if code['punc'] else None)
+        for spec in specs:
+            if spec['key'] == key:
+                spec['titles'].append(code['title'])
+                break
+        else:
+            spec = dict(code)
+            spec['key'] = key
+            spec['titles'] = [code['title']]
+            specs.append(spec)
+
+    out = []
+    out.append('/*')
+    out.append(' * Decoder specializations')
+    out.append(' *')
+    out.append(' * Generated by gen_spec.py from tests/codes.c, do not edit.')
+    out.append(' * Regenerate with \'make -C src specs\'.')
+    out.append(' */')
+    out.append('')
+
+    for i, spec in enumerate(specs):
+        if not spec['punc']:
+            continue
+
+        steps = spec['len']
+        if spec['term'] == 'CONV_TERM_FLUSH':
+            steps += spec['k'] - 1
+
+        out.append('/* %s */' % ', '.join(spec['titles']))
+        out.append('static const int conv_spec_punc_%i[] = {' % i)
+        vals = [v for v in spec['punc'] if v >= 0] + [-1]
+        for j in range(0, len(vals), 12):
+            out.append('\t' + ' '.join('%i,' % v for v in vals[j:j + 12]))
+        out.append('};')
+        out.append('')
+        out.append('static const struct vrun conv_spec_runs_%i[] = {' % i)
+        for run in punc_runs(spec['punc'], spec['n'], steps):
+            out.append('\t{ %3i, %4i, %i, 0x%x },' %
+                       (run['count'], run['off'], run['stride'], run['erase']))
+        out.append('\t{ %3i, %4i, %i, 0x%x },' % (0, 0, 0, 0))
+        out.append('};')
+        out.append('')
+
+    out.append('/* Specialization list')
+    out.append(' *     X(ID, N, K, LEN, TERM, REC, PUNC, RUNS, ...)')
+    out.append(' */')
+    out.append('#define CONV_SPEC_LIST(X, ...) \\')
+    for i, spec in enumerate(specs):
+        if spec['punc']:
+            punc = 'conv_spec_punc_%i, conv_spec_runs_%i' % (i, i)
+        else:
+            punc = 'NULL, NULL'
+        out.append('\tX(%i, %i, %i, %i, %s, %i, %s, __VA_ARGS__) \\' %
+                   (i, spec['n'], spec['k'], spec['len'], spec['term'],
+                    spec['rec'], punc))
+    out.append('')
+    out.append('#define CONV_SPEC_COUNT\t%i' % len(specs))
+
+    text = '\n'.join(out) + '\n'
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
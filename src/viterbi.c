@@ -21,21 +21,113 @@
 #include <malloc.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 #include <osmocom/core/conv.h>
 
-/* Forward Metric Units */
-void gen_metrics_k5_n2(const int8_t *seq, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm);
-void gen_metrics_k5_n3(const int8_t *seq, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm);
-void gen_metrics_k5_n4(const int8_t *seq, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm);
-void gen_metrics_k7_n2(const int8_t *seq, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm);
-void gen_metrics_k7_n3(const int8_t *seq, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm);
-void gen_metrics_k7_n4(const int8_t *seq, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm);
+/* Forward Metric Units
+ *     Generic units have no suffix. SIMD units are built once per supported
+ *     instruction set with the set name appended.
+ */
+#define DECLARE_UNITS(K,SUFFIX) \
+void gen_metrics_k##K##_n2##SUFFIX(const int8_t *seq, const int16_t *out, \
+				   int16_t *sums, int16_t *paths, int norm); \
+void gen_metrics_k##K##_n3##SUFFIX(const int8_t *seq, const int16_t *out, \
+				   int16_t *sums, int16_t *paths, int norm); \
+void gen_metrics_k##K##_n4##SUFFIX(const int8_t *seq, const int16_t *out, \
+				   int16_t *sums, int16_t *paths, int norm); \
+void gen_metrics_mod_k##K##_n2##SUFFIX(const int8_t *seq, const int16_t *out, \
+				       int16_t *sums, int16_t *paths, int norm); \
+void gen_metrics_mod_k##K##_n3##SUFFIX(const int8_t *seq, const int16_t *out, \
+				       int16_t *sums, int16_t *paths, int norm); \
+void gen_metrics_mod_k##K##_n4##SUFFIX(const int8_t *seq, const int16_t *out, \
+				       int16_t *sums, int16_t *paths, int norm);
+
+#define DECLARE_METRICS(SUFFIX) \
+DECLARE_UNITS(3,SUFFIX) \
+DECLARE_UNITS(4,SUFFIX) \
+DECLARE_UNITS(5,SUFFIX) \
+DECLARE_UNITS(6,SUFFIX) \
+DECLARE_UNITS(7,SUFFIX) \
+DECLARE_UNITS(8,SUFFIX) \
+DECLARE_UNITS(9,SUFFIX) \
+void gen_batch_metrics##SUFFIX(int ns, int n, int lanes, \
+			       const int16_t *val, const uint8_t *bidx, \
+			       const int16_t *sums, int16_t *new_sums, \
+			       uint8_t *paths, int norm); \
+int gen_metrics8_k5_n2##SUFFIX(const int8_t *seq, const int16_t *out, \
+			       int8_t *sums, int16_t *paths); \
+int gen_metrics8_k5_n3##SUFFIX(const int8_t *seq, const int16_t *out, \
+			       int8_t *sums, int16_t *paths); \
+int gen_metrics8_k5_n4##SUFFIX(const int8_t *seq, const int16_t *out, \
+			       int8_t *sums, int16_t *paths); \
+int gen_metrics8_k7_n2##SUFFIX(const int8_t *seq, const int16_t *out, \
+			       int8_t *sums, int16_t *paths); \
+int gen_metrics8_k7_n3##SUFFIX(const int8_t *seq, const int16_t *out, \
+			       int8_t *sums, int16_t *paths); \
+int gen_metrics8_k7_n4##SUFFIX(const int8_t *seq, const int16_t *out, \
+			       int8_t *sums, int16_t *paths); \
+int gen_frame_k5_n2##SUFFIX(const int8_t *seq, const int16_t *out, \
+			    int16_t *sums, int16_t *paths, int len, \
+			    int intrvl, int norm); \
+int gen_frame_k5_n3##SUFFIX(const int8_t *seq, const int16_t *out, \
+			    int16_t *sums, int16_t *paths, int len, \
+			    int intrvl, int norm); \
+int gen_frame_k5_n4##SUFFIX(const int8_t *seq, const int16_t *out, \
+			    int16_t *sums, int16_t *paths, int len, \
+			    int intrvl, int norm);
+
+/* Register exchange units
+ *     Forward metric units that update the survivor histories of all states
+ *     in place of storing path decisions. Only SIMD kernel sets provide them.
+ */
+#define DECLARE_REX_UNIT(K,N,SUFFIX) \
+void gen_rex_k##K##_n##N##SUFFIX(const int8_t *seq, const int16_t *out, \
+				 int16_t *sums, const uint64_t *hist, \
+				 uint64_t *next, const uint64_t *bits, \
+				 int norm);
+
+#define DECLARE_REX_UNITS(K,SUFFIX) \
+DECLARE_REX_UNIT(K,2,SUFFIX) \
+DECLARE_REX_UNIT(K,3,SUFFIX) \
+DECLARE_REX_UNIT(K,4,SUFFIX)
+
+#define DECLARE_REX(SUFFIX) \
+DECLARE_REX_UNITS(3,SUFFIX) \
+DECLARE_REX_UNITS(4,SUFFIX) \
+DECLARE_REX_UNITS(5,SUFFIX) \
+DECLARE_REX_UNITS(6,SUFFIX) \
+DECLARE_REX_UNITS(7,SUFFIX) \
+DECLARE_REX_UNITS(8,SUFFIX) \
+DECLARE_REX_UNITS(9,SUFFIX)
+
+DECLARE_METRICS()
+#ifdef HAVE_SSSE3
+DECLARE_METRICS(_ssse3)
+DECLARE_REX(_ssse3)
+#endif
+#ifdef HAVE_SSE4_1
+DECLARE_METRICS(_sse41)
+DECLARE_REX(_sse41)
+#endif
+#ifdef HAVE_AVX2
+DECLARE_METRICS(_avx2)
+DECLARE_REX(_avx2)
+
+/* AVX2 256-bit units (K=6 and above, and batch) */
+DECLARE_UNITS(6,_ymm)
+DECLARE_UNITS(7,_ymm)
+DECLARE_UNITS(8,_ymm)
+DECLARE_UNITS(9,_ymm)
+DECLARE_REX_UNITS(6,_ymm)
+DECLARE_REX_UNITS(7,_ymm)
+DECLARE_REX_UNITS(8,_ymm)
+DECLARE_REX_UNITS(9,_ymm)
+void gen_batch_metrics_ymm(int ns, int n, int lanes,
+			   const int16_t *val, const uint8_t *bidx,
+			   const int16_t *sums, int16_t *new_sums,
+			   uint8_t *paths, int norm);
+#endif
+
 /* Trellis State
  *     state - Internal lshift register value
  *     prev  - Register values of previous 0 and 1 states
@@ -46,131 +138,623 @@ struct vstate {
 };
 
 /* Trellis Object
+ *     Read-only after generation and shared between decoders of the same
+ *     code through the trellis cache.
+ *
  *     num_states - Number of states in the trellis
- *     sums       - Accumulated path metrics
  *     outputs    - Trellis ouput values
  *     vals       - Input value that led to each state
+ *     bmidx      - Branch metric index word of each butterfly
  */
 struct vtrellis {
 	int num_states;
-	int16_t *sums;
 	int16_t *outputs;
 	uint8_t *vals;
+	int16_t *bmidx;
+};
+
+/* Trellis Cache Entry
+ *     n, k        - Code order and constraint length
+ *     next_output - Copy of the code output table used as lookup key
+ *     term_output - Copy of the recursive termination table or NULL
+ *     refs        - Number of decoders holding the trellis
+ *     trellis     - Shared trellis object
+ *     next        - Next cache entry
+ */
+struct vtrellis_entry {
+	int n;
+	int k;
+	uint8_t (*next_output)[2];
+	uint8_t *term_output;
+	int refs;
+	struct vtrellis *trellis;
+	struct vtrellis_entry *next;
+};
+
+/* Puncturing Run
+ *     Consecutive trellis steps of a generated specialization with the same
+ *     punctured symbols. Runs are terminated by a zero count.
+ *
+ *     count  - Number of steps in the run
+ *     off    - Input offset of the first transmitted symbol of the run
+ *     stride - Number of transmitted symbols per step
+ *     erase  - Bitmask of punctured symbols within each step
+ */
+struct vrun {
+	int count;
+	int off;
+	int stride;
+	int erase;
+};
+
+/* Code Specialization
+ *     Generated by gen_spec.py from the code definitions in tests/codes.c. A
+ *     decoder with 16-bit path metrics uses the specialized routines of its
+ *     kernel set when every field matches its code.
+ *
+ *     n, k      - Code order and constraint length
+ *     len       - Number of decoded output bits
+ *     term      - Termination type
+ *     recursive - Set to '1' if the code is recursive
+ *     puncture  - Copy of the puncturing matrix or NULL
+ */
+struct vspec {
+	int n;
+	int k;
+	int len;
+	int term;
+	int recursive;
+	const int *puncture;
+};
+
+/* Specialized Decoder Routines
+ *     forward   - Forward recursion over the whole trellis
+ *     traceback - Traceback of the decoded bits into unpacked output
+ */
+struct vspec_funcs {
+	void (*forward)(const int8_t *, const int16_t *, int16_t *, int16_t *);
+	unsigned (*traceback)(const int16_t *, const uint8_t *,
+			      unsigned, uint8_t *);
+};
+
+/* Kernel Set
+ *     name      - Instruction set name
+ *     supported - Returns non-zero if the running CPU supports the set
+ *     packed    - Set to '1' if path decisions are stored as bits
+ *     unique    - Set to '1' if 16-bit metric units of K = 6 and above read
+ *                 branch metric index words instead of trellis outputs
+ *     metrics   - Metric units indexed by K = 3 to 9 and N = 2, 3 and 4
+ *     mod       - Modulo metric units indexed by K = 3 to 9 and N = 2 to 4
+ *     batch     - Inter-frame metric unit for batch decoding
+ *     k5_8      - 8-bit metric units for K = 5 and N = 2, 3 and 4
+ *     k7_8      - 8-bit metric units for K = 7 and N = 2, 3 and 4
+ *     k5_frame  - Whole-frame metric units for K = 5 and N = 2, 3 and 4
+ *     specs     - Specialized routines in generated code order
+ */
+struct vkernels {
+	const char *name;
+	int (*supported)(void);
+	int packed;
+	int unique;
+
+	void (*metrics[7][3])(const int8_t *, const int16_t *,
+			      int16_t *, int16_t *, int);
+	void (*mod[7][3])(const int8_t *, const int16_t *,
+			  int16_t *, int16_t *, int);
+	void (*batch)(int, int, int, const int16_t *, const uint8_t *,
+		      const int16_t *, int16_t *, uint8_t *, int);
+	int (*k5_8[3])(const int8_t *, const int16_t *, int8_t *, int16_t *);
+	int (*k7_8[3])(const int8_t *, const int16_t *, int8_t *, int16_t *);
+	int (*k5_frame[3])(const int8_t *, const int16_t *, int16_t *,
+			   int16_t *, int, int, int);
+	void (*rex[7][3])(const int8_t *, const int16_t *, int16_t *,
+			  const uint64_t *, uint64_t *, const uint64_t *, int);
+	const struct vspec_funcs *specs;
+};
+
+/* Path metric arithmetic
+ *     VDEC_METRIC_16  - 16-bit saturating with interval normalization
+ *     VDEC_METRIC_8   - 8-bit saturating with adaptive renormalization
+ *     VDEC_METRIC_MOD - 16-bit wrap-around without normalization
+ */
+enum vdec_metric {
+	VDEC_METRIC_16,
+	VDEC_METRIC_8,
+	VDEC_METRIC_MOD,
+};
+
+/* Puncturing Map Step
+ *     off   - Input offset of the first transmitted symbol of the step
+ *     erase - Bitmask of punctured symbols within the step
+ */
+struct vstep {
+	int off;
+	int erase;
+};
+
+/* Decoder output format
+ *     VDEC_OUT_UBIT     - One byte per decoded bit
+ *     VDEC_OUT_PBIT_MSB - Packed bits, first bit in the most significant bit
+ *     VDEC_OUT_PBIT_LSB - Packed bits, first bit in the least significant bit
+ */
+enum vdec_output {
+	VDEC_OUT_UBIT,
+	VDEC_OUT_PBIT_MSB,
+	VDEC_OUT_PBIT_LSB,
 };
 
 /* Viterbi Decoder
  *     n         - Code order
  *     k         - Constraint length
  *     len       - Horizontal length of trellis
+ *     num_bits  - Number of decoded output bits
+ *     term      - Termination type
  *     recursive - Set to '1' if the code is recursive
  *     intrvl    - Normalization interval
- *     trellis   - Trellis object
- *     punc      - Puncturing sequence
+ *     trellis   - Shared trellis object
+ *     sums      - Accumulated path metrics
+ *     steps     - Puncturing map or NULL if the code is not punctured
+ *     packed    - Set to '1' if path decisions are stored as bits
  *     paths     - Trellis paths
+ *     metric    - Path metric arithmetic
+ *     saturated - Set to '1' if 8-bit path metrics saturated in the last run
+ *     scale8    - Soft input scaling table for 8-bit path metrics
+ *     max_iter  - Maximum number of tail-biting iterations
+ *     iters     - Number of trellis passes in the last run
+ *     rex       - Set to '1' to use register exchange survivors
+ *     hist      - Double buffered decoded bit history of each state
+ *     rex_bits  - Decoded bit of each state by surviving predecessor
+ *     spec      - Specialized routines for the code or NULL
+ *     use_spec  - Set to '1' to run the specialized routines
+ *     frame_func - Whole-frame metric unit or NULL if not available
+ *     rex_func  - Register exchange metric unit or NULL if not available
+ *     ws        - Set to '1' if storage is held in a caller workspace
+ *     unique    - Set to '1' if the metric unit reads branch metric indices
+ *     outputs   - Trellis table passed to the 16-bit metric units
  */
 struct vdecoder {
 	int n;
 	int k;
 	int len;
+	int num_bits;
+	int term;
 	int recursive;
 	int intrvl;
-	struct vtrellis *trellis;
-	int *punc;
+	const struct vtrellis *trellis;
+	int16_t *sums;
+	const struct vstep *steps;
+	int packed;
 	int16_t **paths;
+	enum vdec_metric metric;
+	int saturated;
+	int8_t *scale8;
+	int max_iter;
+	int iters;
+	int rex;
+	uint64_t *hist[2];
+	uint64_t *rex_bits;
+	const struct vspec_funcs *spec;
+	int use_spec;
+	int ws;
+	int unique;
+	const int16_t *outputs;
 
 	void (*metric_func)(const int8_t *, const int16_t *,
 			    int16_t *, int16_t *, int);
+	int (*metric8_func)(const int8_t *, const int16_t *,
+			    int8_t *, int16_t *);
+	int (*frame_func)(const int8_t *, const int16_t *, int16_t *,
+			  int16_t *, int, int, int);
+	void (*rex_func)(const int8_t *, const int16_t *, int16_t *,
+			 const uint64_t *, uint64_t *, const uint64_t *, int);
 };
 
 /* Aligned Memory Allocator
- *     SSE requires 16-byte memory alignment. We store relevant trellis values
- *     (accumulated sums, outputs, and path decisions) as 16 bit signed integers
- *     so the allocated memory is casted as such.
+ *     SSE requires 16-byte and AVX 32-byte memory alignment. We store relevant
+ *     trellis values (accumulated sums, outputs, and path decisions) as 16 bit
+ *     signed integers so the allocated memory is casted as such. The kernel
+ *     set is selected at runtime, so always align for the widest registers.
  */
-#define SSE_ALIGN	16
+#define SSE_ALIGN	32
 
 static int16_t *vdec_malloc(size_t n)
 {
-#ifdef HAVE_SSE3
 	return (int16_t *) memalign(SSE_ALIGN, sizeof(int16_t) * n);
-#else
-	return (int16_t *) malloc(sizeof(int16_t) * n);
-#endif
 }
 
-/* Accessor calls */
-inline int conv_code_recursive(const struct osmo_conv_code *code)
+/* CPU feature checks for runtime kernel selection */
+#if defined(__i386__) || defined(__x86_64__)
+#ifdef HAVE_SSSE3
+static int cpu_ssse3(void)
 {
-	return code->next_term_output ? 1 : 0;
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3");
 }
+#endif
+#ifdef HAVE_SSE4_1
+static int cpu_sse41(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.1");
+}
+#endif
+#ifdef HAVE_AVX2
+static int cpu_avx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+#endif
+#endif
+
+#define NUM_STATES(K) (1 << ((K) - 1))
+
+/* SIMD units read trellises of fewer than 16 states as 16 padded states */
+#define PAD_STATES(NS) ((NS) < 16 ? 16 : (NS))
 
 /* Left shift and mask for finding the previous state */
 static unsigned vstate_lshift(unsigned reg, int k, int val)
 {
-	unsigned mask;
-
-	if (k == 5)
-		mask = 0x0e;
-	else if (k == 7)
-		mask = 0x3e;
-	else
-		mask = 0;
+	unsigned mask = (1 << (k - 1)) - 2;
 
 	return ((reg << 1) & mask) | val;
 }
 
-/* Bit endian manipulators */
-inline unsigned bitswap2(unsigned v)
+/* Specialized Forward Recursion
+ *     Expanded for each generated code and kernel set with the code
+ *     parameters and the metric unit as constants. The trellis length,
+ *     normalization interval and path stride fold into the loops, and every
+ *     step calls the metric unit directly. Punctured codes walk the generated
+ *     runs, so only steps with erased symbols are gathered and no per-step
+ *     puncturing lookup is made.
+ */
+__always_inline static void spec_forward(const int8_t *seq,
+					 const int16_t *out, int16_t *sums,
+					 int16_t *paths, int n, int k, int len,
+					 const struct vrun *runs, int packed,
+					 void (*unit)(const int8_t *,
+						      const int16_t *,
+						      int16_t *, int16_t *,
+						      int),
+					 int (*frame)(const int8_t *,
+						      const int16_t *,
+						      int16_t *, int16_t *,
+						      int, int, int))
 {
-	return ((v & 0x02) >> 1) | ((v & 0x01) << 1);
+	int i, j, m, norm = 0;
+	int intrvl = INT16_MAX / (n * INT8_MAX) - k;
+	int stride = packed ? PAD_STATES(NUM_STATES(k)) / 16 : NUM_STATES(k);
+	int8_t val[4];
+	const int8_t *in;
+
+	if (!runs && frame) {
+		frame(seq, out, sums, paths, len, intrvl, 0);
+		return;
+	}
+
+	if (!runs) {
+		for (i = 0; i < len; i++) {
+			unit(&seq[n * i], out, sums, &paths[i * stride], !norm);
+			if (++norm == intrvl)
+				norm = 0;
+		}
+		return;
+	}
+
+	for (; runs->count; runs++) {
+		in = &seq[runs->off];
+
+		if (frame && !runs->erase) {
+			norm = frame(in, out, sums, paths, runs->count,
+				     intrvl, norm);
+			paths += runs->count * stride;
+			continue;
+		}
+
+		for (i = 0; i < runs->count; i++) {
+			if (runs->erase) {
+				for (j = 0, m = 0; j < n; j++) {
+					if (runs->erase & (1 << j))
+						val[j] = 0;
+					else
+						val[j] = in[m++];
+				}
+				unit(val, out, sums, paths, !norm);
+			} else {
+				unit(in, out, sums, paths, !norm);
+			}
+
+			in += runs->stride;
+			paths += stride;
+			if (++norm == intrvl)
+				norm = 0;
+		}
+	}
 }
 
-inline unsigned bitswap3(unsigned v)
+/* Specialized traceback
+ *     Walks the first 'len' trellis steps into unpacked output bits with the
+ *     path decision layout of the kernel set fixed at expansion. The path
+ *     row is stepped separately from the state, which keeps the address
+ *     arithmetic off the state dependency chain.
+ */
+__always_inline static unsigned spec_traceback(const int16_t *paths,
+					       const uint8_t *vals,
+					       unsigned state, uint8_t *out,
+					       int k, int len, int rec,
+					       int packed)
 {
-	return ((v & 0x04) >> 2) | ((v & 0x02) >> 0) |
-	       ((v & 0x01) << 2);
+	int i;
+	unsigned path;
+	int stride = packed ? PAD_STATES(NUM_STATES(k)) / 16 : NUM_STATES(k);
+
+	paths += len * stride;
+
+	for (i = len - 1; i >= 0; i--) {
+		paths -= stride;
+		if (packed)
+			path = !(((uint16_t) paths[state >> 4] >>
+				  (state & 0x0f)) & 0x01);
+		else
+			path = paths[state] + 1;
+
+		out[i] = rec ? path ^ vals[state] : vals[state];
+		state = vstate_lshift(state, k, path);
+	}
+
+	return state;
+}
+
+/* Metric unit of a kernel set, split by constraint length as in KERNEL_SET */
+#define SPEC_UNIT_3(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k3_n##N##SUFFIX
+#define SPEC_UNIT_4(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k4_n##N##SUFFIX
+#define SPEC_UNIT_5(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k5_n##N##SUFFIX
+#define SPEC_UNIT_6(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k6_n##N##WIDE_SUFFIX
+#define SPEC_UNIT_7(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k7_n##N##WIDE_SUFFIX
+#define SPEC_UNIT_8(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k8_n##N##WIDE_SUFFIX
+#define SPEC_UNIT_9(N,SUFFIX,WIDE_SUFFIX)	gen_metrics_k9_n##N##WIDE_SUFFIX
+#define SPEC_UNIT(K,N,SUFFIX,WIDE_SUFFIX) \
+	SPEC_UNIT_##K(N,SUFFIX,WIDE_SUFFIX)
+
+/* Whole-frame metric unit of a kernel set, available for K = 5 only */
+#define SPEC_FRAME_3(N,SUFFIX)	NULL
+#define SPEC_FRAME_4(N,SUFFIX)	NULL
+#define SPEC_FRAME_5(N,SUFFIX)	gen_frame_k5_n##N##SUFFIX
+#define SPEC_FRAME_6(N,SUFFIX)	NULL
+#define SPEC_FRAME_7(N,SUFFIX)	NULL
+#define SPEC_FRAME_8(N,SUFFIX)	NULL
+#define SPEC_FRAME_9(N,SUFFIX)	NULL
+#define SPEC_FRAME(K,N,SUFFIX)	SPEC_FRAME_##K(N,SUFFIX)
+
+#define SPEC_ROUTINES(ID,N,K,LEN,TERM,REC,PUNC,RUNS, \
+		      SUFFIX,WIDE_SUFFIX,PACKED) \
+static void spec_forward_##ID##SUFFIX(const int8_t *seq, \
+				      const int16_t *out, \
+				      int16_t *sums, int16_t *paths) \
+{ \
+	spec_forward(seq, out, sums, paths, N, K, \
+		     (TERM) == CONV_TERM_FLUSH ? (LEN) + (K) - 1 : (LEN), \
+		     RUNS, PACKED, SPEC_UNIT(K, N, SUFFIX, WIDE_SUFFIX), \
+		     SPEC_FRAME(K, N, SUFFIX)); \
+} \
+static unsigned spec_traceback_##ID##SUFFIX(const int16_t *paths, \
+					    const uint8_t *vals, \
+					    unsigned state, uint8_t *out) \
+{ \
+	return spec_traceback(paths, vals, state, out, K, LEN, REC, PACKED); \
+}
+
+#define SPEC_FUNCS(ID,N,K,LEN,TERM,REC,PUNC,RUNS, \
+		   SUFFIX,WIDE_SUFFIX,PACKED) \
+	{ spec_forward_##ID##SUFFIX, spec_traceback_##ID##SUFFIX },
+
+#define SPEC_KEY(ID,N,K,LEN,TERM,REC,PUNC,RUNS,...) \
+	{ N, K, LEN, TERM, REC, PUNC },
+
+#define SPEC_SET(SUFFIX,WIDE_SUFFIX,PACKED) \
+CONV_SPEC_LIST(SPEC_ROUTINES, SUFFIX, WIDE_SUFFIX, PACKED) \
+static const struct vspec_funcs vspec_funcs##SUFFIX[] = { \
+	CONV_SPEC_LIST(SPEC_FUNCS, SUFFIX, WIDE_SUFFIX, PACKED) \
+};
+
+/* Specialized routines of each kernel set, in generated code order */
+#include "viterbi_spec.h"
+
+static const struct vspec vspecs[] = {
+	CONV_SPEC_LIST(SPEC_KEY, )
+};
+
+#ifdef HAVE_AVX2
+SPEC_SET(_avx2, _ymm, 1)
+#endif
+#ifdef HAVE_SSE4_1
+SPEC_SET(_sse41, _sse41, 1)
+#endif
+#ifdef HAVE_SSSE3
+SPEC_SET(_ssse3, _ssse3, 1)
+#endif
+SPEC_SET(, , 0)
+#define METRIC_UNITS(NAME,K,SUFFIX) \
+	{ \
+		NAME##_k##K##_n2##SUFFIX, \
+		NAME##_k##K##_n3##SUFFIX, \
+		NAME##_k##K##_n4##SUFFIX, \
+	}
+
+#define REX_UNITS(SUFFIX,WIDE_SUFFIX) \
+	{ \
+		METRIC_UNITS(gen_rex, 3, SUFFIX), \
+		METRIC_UNITS(gen_rex, 4, SUFFIX), \
+		METRIC_UNITS(gen_rex, 5, SUFFIX), \
+		METRIC_UNITS(gen_rex, 6, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_rex, 7, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_rex, 8, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_rex, 9, WIDE_SUFFIX), \
+	}
+
+#define NO_REX_UNITS	{ { NULL } }
+
+#define KERNEL_SET(NAME,SUPPORTED,PACKED,SUFFIX,WIDE_SUFFIX,REX) \
+{ \
+	.name = NAME, \
+	.supported = SUPPORTED, \
+	.packed = PACKED, \
+	.unique = PACKED, \
+	.metrics = { \
+		METRIC_UNITS(gen_metrics, 3, SUFFIX), \
+		METRIC_UNITS(gen_metrics, 4, SUFFIX), \
+		METRIC_UNITS(gen_metrics, 5, SUFFIX), \
+		METRIC_UNITS(gen_metrics, 6, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_metrics, 7, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_metrics, 8, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_metrics, 9, WIDE_SUFFIX), \
+	}, \
+	.mod = { \
+		METRIC_UNITS(gen_metrics_mod, 3, SUFFIX), \
+		METRIC_UNITS(gen_metrics_mod, 4, SUFFIX), \
+		METRIC_UNITS(gen_metrics_mod, 5, SUFFIX), \
+		METRIC_UNITS(gen_metrics_mod, 6, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_metrics_mod, 7, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_metrics_mod, 8, WIDE_SUFFIX), \
+		METRIC_UNITS(gen_metrics_mod, 9, WIDE_SUFFIX), \
+	}, \
+	.batch = gen_batch_metrics##WIDE_SUFFIX, \
+	.k5_8 = METRIC_UNITS(gen_metrics8, 5, SUFFIX), \
+	.k7_8 = METRIC_UNITS(gen_metrics8, 7, SUFFIX), \
+	.k5_frame = METRIC_UNITS(gen_frame, 5, SUFFIX), \
+	.rex = REX, \
+	.specs = vspec_funcs##SUFFIX, \
 }
 
-inline unsigned bitswap4(unsigned v)
+/* Available kernel sets in order of preference
+ *     The SSE kernels pack path decisions into 16-bit words with one bit per
+ *     state, while the generic kernels store a full 16-bit value (-1 or 0)
+ *     per state. The AVX2 set uses 256-bit kernels for K=6 and above, where
+ *     16 butterflies fill a register, and for batch decoding, and 128-bit
+ *     kernels below that. 8-bit metric units are 128-bit for all sets. The
+ *     SSE and AVX2 units of K=6 and above compute the 2^N unique branch
+ *     metrics once per step and shuffle them into butterfly order. The
+ *     SIMD sets also provide register exchange units for all constraint
+ *     lengths, while the generic set updates survivors after each step.
+ */
+static const struct vkernels vkernels[] = {
+#ifdef HAVE_AVX2
+	KERNEL_SET("avx2", cpu_avx2, 1, _avx2, _ymm, REX_UNITS(_avx2, _ymm)),
+#endif
+#ifdef HAVE_SSE4_1
+	KERNEL_SET("sse41", cpu_sse41, 1, _sse41, _sse41,
+		   REX_UNITS(_sse41, _sse41)),
+#endif
+#ifdef HAVE_SSSE3
+	KERNEL_SET("ssse3", cpu_ssse3, 1, _ssse3, _ssse3,
+		   REX_UNITS(_ssse3, _ssse3)),
+#endif
+	KERNEL_SET("generic", NULL, 0, , , NO_REX_UNITS),
+};
+
+#define NUM_KERNEL_SETS	(sizeof(vkernels) / sizeof(vkernels[0]))
+
+/* Kernel set for new decoders
+ *     Initialized to the best set supported by the CPU, or the set named by
+ *     the CONV_TEST_SIMD environment variable if present and supported.
+ */
+static pthread_once_t vkernels_once = PTHREAD_ONCE_INIT;
+static const struct vkernels *vkernels_active;
+
+static const struct vkernels *find_kernels(const char *name)
 {
-	return ((v & 0x08) >> 3) | ((v & 0x04) >> 1) |
-	       ((v & 0x02) << 1) | ((v & 0x01) << 3);
+	int i;
+
+	for (i = 0; i < NUM_KERNEL_SETS; i++) {
+		if (vkernels[i].supported && !vkernels[i].supported())
+			continue;
+		if (!name || !strcmp(name, vkernels[i].name))
+			return &vkernels[i];
+	}
+
+	return NULL;
 }
 
-inline unsigned bitswap5(unsigned v)
+static void init_kernels(void)
 {
-	return ((v & 0x10) >> 4) | ((v & 0x08) >> 2) | ((v & 0x04) >> 0) |
-	       ((v & 0x02) << 2) | ((v & 0x01) << 4);
+	const char *name = getenv("CONV_TEST_SIMD");
+
+	if (name)
+		vkernels_active = find_kernels(name);
+	if (!vkernels_active)
+		vkernels_active = find_kernels(NULL);
 }
 
-inline unsigned bitswap6(unsigned v)
+static const struct vkernels *get_kernels(void)
 {
-	return ((v & 0x20) >> 5) | ((v & 0x10) >> 3) | ((v & 0x08) >> 1) |
-	       ((v & 0x04) << 1) | ((v & 0x02) << 3) | ((v & 0x01) << 5);
+	pthread_once(&vkernels_once, init_kernels);
+	return vkernels_active;
 }
 
-static unsigned bitswap(unsigned v, unsigned n)
+/* Force a kernel set by name for subsequently created decoders
+ *     Passing NULL restores the best supported set. Returns -EINVAL for an
+ *     unknown set and -ENOTSUP if the CPU lacks the required instructions.
+ */
+int conv_simd_select(const char *name)
 {
-	switch (n) {
-	case 1:
-		return v;
-	case 2:
-		return bitswap2(v);
-	case 3:
-		return bitswap3(v);
-	case 4:
-		return bitswap4(v);
-	case 5:
-		return bitswap5(v);
-	case 6:
-		return bitswap6(v);
-	default:
-		break;
+	int i;
+	const struct vkernels *ks;
+
+	get_kernels();
+
+	ks = find_kernels(name);
+	if (!ks) {
+		for (i = 0; i < NUM_KERNEL_SETS; i++) {
+			if (!strcmp(name, vkernels[i].name))
+				return -ENOTSUP;
+		}
+		return -EINVAL;
 	}
 
+	vkernels_active = ks;
 	return 0;
 }
 
+/* Name of the kernel set used by new decoders */
+const char *conv_simd_current(void)
+{
+	return get_kernels()->name;
+}
+
+/* Enumerate kernel sets supported by the running CPU, best first */
+const char *conv_simd_variant(int idx)
+{
+	int i;
+
+	for (i = 0; i < NUM_KERNEL_SETS; i++) {
+		if (vkernels[i].supported && !vkernels[i].supported())
+			continue;
+		if (!idx--)
+			return vkernels[i].name;
+	}
+
+	return NULL;
+}
+
+/* Accessor calls */
+inline int conv_code_recursive(const struct osmo_conv_code *code)
+{
+	return code->next_term_output ? 1 : 0;
+}
+
+/* Bit endian manipulator
+ *     Reverse the order of the low 'n' bits.
+ */
+static unsigned bitswap(unsigned v, unsigned n)
+{
+	unsigned i, r = 0;
+
+	for (i = 0; i < n; i++)
+		r |= ((v >> i) & 0x01) << (n - 1 - i);
+
+	return r;
+}
+
 /* Generate non-recursive state output from generator state table
  *     Note that the shift register moves right (i.e. the most recent bit is
  *     shifted into the register at k-1 bit of the register), which is typical
@@ -248,8 +832,6 @@ static unsigned gen_recursive_output(struct vstate *state,
 	return out;
 }
 
-#define NUM_STATES(K) (K == 7 ? 64 : 16)
-
 /* Populate recursive trellis state
  *     The bit position of the systematic bit is not explicitly marked by the
  *     API, so it must be extracted from the generator table. Otherwise,
@@ -305,34 +887,68 @@ static void free_trellis(struct vtrellis *trellis)
 
 	free(trellis->vals);
 	free(trellis->outputs);
-	free(trellis->sums);
+	free(trellis->bmidx);
 	free(trellis);
 }
 
-/* Allocate and initialize the trellis object
+/* Trellis output values per state */
+#define TRELLIS_OLEN(N) ((N) == 2 ? 2 : 4)
+
+/* Branch metric index words per trellis, one per butterfly */
+#define TRELLIS_BMLEN(NS) (PAD_STATES(NS) / 2)
+
+/* Generate branch metric index words
+ *     SIMD units compute the 2^N unique branch metrics once per step and
+ *     shuffle them into butterfly order. Bit j of the metric index is set if
+ *     output j of the butterfly is negative. Each word holds the byte
+ *     indices of a 16-bit metric for a byte shuffle. Metrics 8-15 are held
+ *     in a second register, so their indices have the high bit of each byte
+ *     set. Padded butterflies select zero.
+ */
+static void fill_bmidx(struct vtrellis *trellis, int n)
+{
+	int i, j, c;
+	int ns = trellis->num_states;
+	int olen = TRELLIS_OLEN(n);
+	uint8_t lo;
+
+	for (i = 0; i < TRELLIS_BMLEN(ns); i++) {
+		if (i >= ns / 2) {
+			trellis->bmidx[i] = (int16_t) 0x8080;
+			continue;
+		}
+
+		for (j = 0, c = 0; j < n; j++) {
+			if (trellis->outputs[olen * i + j] < 0)
+				c |= 1 << j;
+		}
+
+		lo = c < 8 ? 2 * c : 0x80 | (2 * (c - 8));
+		trellis->bmidx[i] = (int16_t) (lo | ((lo + 1) << 8));
+	}
+}
+
+/* Initialize the trellis object
  *     Initialization consists of generating the outputs and output value of a
  *     given state. Due to trellis symmetry and anti-symmetry, only one of the
  *     transition paths is utilized by the butterfly operation in the forward
  *     recursion, so only one set of N outputs is required per state variable.
+ *     Output, value and index storage is provided by the caller.
  */
-static struct vtrellis *generate_trellis(const struct osmo_conv_code *code)
+static int fill_trellis(struct vtrellis *trellis,
+			const struct osmo_conv_code *code)
 {
 	int i, rc = -1;
-	struct vtrellis *trellis;
 	int16_t *outputs;
 
 	int ns = NUM_STATES(code->K);
 	int recursive = conv_code_recursive(code);
-	int olen = (code->N == 2) ? 2 : 4;
+	int olen = TRELLIS_OLEN(code->N);
 
-	trellis = (struct vtrellis *) calloc(1, sizeof(struct vtrellis));
 	trellis->num_states = ns;
-	trellis->sums =	vdec_malloc(ns);
-	trellis->outputs = vdec_malloc(ns * olen);
-	trellis->vals = (uint8_t *) malloc(ns * sizeof(uint8_t));
 
-	if (!trellis->sums || !trellis->outputs)
-		goto fail;
+	/* Zero outputs of padded states give zero branch metrics */
+	memset(trellis->outputs, 0, sizeof(int16_t) * PAD_STATES(ns) * olen);
 
 	/* Populate the trellis state objects */
 	for (i = 0; i < ns; i++) {
@@ -347,6 +963,31 @@ static struct vtrellis *generate_trellis(const struct osmo_conv_code *code)
 	}
 
 	if (rc < 0)
+		return rc;
+
+	fill_bmidx(trellis, code->N);
+
+	return 0;
+}
+
+/* Allocate and initialize the trellis object */
+static struct vtrellis *generate_trellis(const struct osmo_conv_code *code)
+{
+	struct vtrellis *trellis;
+	int ns = NUM_STATES(code->K);
+
+	trellis = (struct vtrellis *) calloc(1, sizeof(struct vtrellis));
+	if (!trellis)
+		return NULL;
+
+	trellis->outputs = vdec_malloc(PAD_STATES(ns) * TRELLIS_OLEN(code->N));
+	trellis->vals = (uint8_t *) malloc(ns * sizeof(uint8_t));
+	trellis->bmidx = vdec_malloc(TRELLIS_BMLEN(ns));
+
+	if (!trellis->outputs || !trellis->vals || !trellis->bmidx)
+		goto fail;
+
+	if (fill_trellis(trellis, code) < 0)
 		goto fail;
 
 	return trellis;
@@ -355,247 +996,1746 @@ fail:
 	return NULL;
 }
 
-/* Reset decoder
- *     Set accumulated path metrics to zero. For termination other than
- *     tail-biting, initialize the zero state as the encoder starting state.
- *     Intialize with the maximum accumulated sum at length equal to the
- *     constraint length.
+/* Process-wide trellis cache
+ *     Trellis tables depend only on the code order, constraint length and
+ *     generator tables, so decoders of identical codes share a single
+ *     read-only copy. Entries are held by the cache until explicitly
+ *     flushed so that short lived decoders do not regenerate the trellis.
  */
-static void reset_decoder(struct vdecoder *dec, int term)
-{
-	int ns = dec->trellis->num_states;
+static pthread_mutex_t trellis_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct vtrellis_entry *trellis_cache;
+static unsigned long trellis_cache_hits;
+static unsigned long trellis_cache_misses;
 
-	memset(dec->trellis->sums, 0, sizeof(int16_t) * ns);
+static int trellis_entry_match(const struct vtrellis_entry *entry,
+			       const struct osmo_conv_code *code)
+{
+	int ns = NUM_STATES(code->K);
 
-	if (term != CONV_TERM_TAIL_BITING)
-		dec->trellis->sums[0] = INT8_MAX * dec->n * dec->k;
+	if ((entry->n != code->N) || (entry->k != code->K))
+		return 0;
+	if (!entry->term_output != !code->next_term_output)
+		return 0;
+	if (memcmp(entry->next_output, code->next_output, ns * 2))
+		return 0;
+	if (entry->term_output &&
+	    memcmp(entry->term_output, code->next_term_output, ns))
+		return 0;
+
+	return 1;
 }
 
-static void _traceback(struct vdecoder *dec,
-		       unsigned state, uint8_t *out, int len)
+static void free_trellis_entry(struct vtrellis_entry *entry)
 {
-	int i;
-	unsigned path;
-
-	for (i = len - 1; i >= 0; i--) {
-		path = dec->paths[i][state] + 1;
-		out[i] = dec->trellis->vals[state];
-		state = vstate_lshift(state, dec->k, path);
-	}
+	free_trellis(entry->trellis);
+	free(entry->term_output);
+	free(entry->next_output);
+	free(entry);
 }
 
-static void _traceback_rec(struct vdecoder *dec,
-			   unsigned state, uint8_t *out, int len)
+static struct vtrellis_entry *alloc_trellis_entry(const struct osmo_conv_code *code)
 {
-	int i;
-	unsigned path;
+	int ns = NUM_STATES(code->K);
+	struct vtrellis_entry *entry;
 
-	for (i = len - 1; i >= 0; i--) {
-		path = dec->paths[i][state] + 1;
-		out[i] = path ^ dec->trellis->vals[state];
-		state = vstate_lshift(state, dec->k, path);
+	entry = (struct vtrellis_entry *) calloc(1, sizeof(*entry));
+	if (!entry)
+		return NULL;
+
+	entry->n = code->N;
+	entry->k = code->K;
+	entry->next_output = malloc(ns * 2);
+	if (!entry->next_output)
+		goto fail;
+	memcpy(entry->next_output, code->next_output, ns * 2);
+
+	if (code->next_term_output) {
+		entry->term_output = malloc(ns);
+		if (!entry->term_output)
+			goto fail;
+		memcpy(entry->term_output, code->next_term_output, ns);
 	}
+
+	entry->trellis = generate_trellis(code);
+	if (!entry->trellis)
+		goto fail;
+
+	return entry;
+fail:
+	free_trellis_entry(entry);
+	return NULL;
 }
 
-/* Traceback and generate decoded output
- *     Find the largest accumulated path metric at the final state except for
- *     the zero terminated case, where we assume the final state is always zero.
- */
-static int traceback(struct vdecoder *dec, uint8_t *out, int term, int len)
+/* Acquire a shared trellis, generating and caching it on first use */
+static const struct vtrellis *get_trellis(const struct osmo_conv_code *code)
 {
-	int i, sum, max = -1;
-	unsigned path, state = 0;
+	struct vtrellis_entry *entry;
 
-	if (term != CONV_TERM_FLUSH) {
-		for (i = 0; i < dec->trellis->num_states; i++) {
-			sum = dec->trellis->sums[i];
-			if (sum > max) {
-				max = sum;
-				state = i;
-			}
-		}
+	pthread_mutex_lock(&trellis_cache_lock);
 
-		if (max < 0)
-			return -EPROTO;
+	for (entry = trellis_cache; entry; entry = entry->next) {
+		if (trellis_entry_match(entry, code)) {
+			trellis_cache_hits++;
+			goto found;
+		}
 	}
 
-	for (i = dec->len - 1; i >= len; i--) {
-		path = dec->paths[i][state] + 1;
-		state = vstate_lshift(state, dec->k, path);
+	entry = alloc_trellis_entry(code);
+	if (!entry) {
+		pthread_mutex_unlock(&trellis_cache_lock);
+		return NULL;
 	}
 
-	if (dec->recursive)
-		_traceback_rec(dec, state, out, len);
-	else
-		_traceback(dec, state, out, len);
+	entry->next = trellis_cache;
+	trellis_cache = entry;
+	trellis_cache_misses++;
+found:
+	entry->refs++;
+	pthread_mutex_unlock(&trellis_cache_lock);
 
-	return 0;
+	return entry->trellis;
 }
 
-/* Release decoder object */
-static void free_vdec(struct vdecoder *dec)
+/* Release a shared trellis reference */
+static void put_trellis(const struct vtrellis *trellis)
 {
-	if (!dec)
+	struct vtrellis_entry *entry;
+
+	if (!trellis)
 		return;
 
-	free(dec->paths[0]);
-	free(dec->paths);
-	free_trellis(dec->trellis);
-	free(dec);
+	pthread_mutex_lock(&trellis_cache_lock);
+
+	for (entry = trellis_cache; entry; entry = entry->next) {
+		if (entry->trellis == trellis) {
+			entry->refs--;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&trellis_cache_lock);
 }
 
-/* Allocate decoder object
- *     Subtract the constraint length K on the normalization interval to
- *     accommodate the initialization path metric at state zero.
- */
-static struct vdecoder *alloc_vdec(const struct osmo_conv_code *code)
+/* Trellis cache statistics */
+void conv_trellis_cache_stats(unsigned long *hits, unsigned long *misses)
 {
-	int i, ns;
-	struct vdecoder *dec;
+	pthread_mutex_lock(&trellis_cache_lock);
 
-	ns = NUM_STATES(code->K);
+	if (hits)
+		*hits = trellis_cache_hits;
+	if (misses)
+		*misses = trellis_cache_misses;
 
-	dec = (struct vdecoder *) calloc(1, sizeof(struct vdecoder));
-	dec->n = code->N;
-	dec->k = code->K;
-	dec->recursive = conv_code_recursive(code);
-	dec->intrvl = INT16_MAX / (dec->n * INT8_MAX) - dec->k;
+	pthread_mutex_unlock(&trellis_cache_lock);
+}
 
-	if (dec->k == 5) {
-		switch (dec->n) {
-		case 2:
-			dec->metric_func = gen_metrics_k5_n2;
-			break;
-		case 3:
-			dec->metric_func = gen_metrics_k5_n3;
-			break;
-		case 4:
-			dec->metric_func = gen_metrics_k5_n4;
-			break;
-		default:
-			goto fail;
-		}
-	} else if (dec->k == 7) {
-		switch (dec->n) {
-		case 2:
-			dec->metric_func = gen_metrics_k7_n2;
-			break;
-		case 3:
-			dec->metric_func = gen_metrics_k7_n3;
-			break;
-		case 4:
-			dec->metric_func = gen_metrics_k7_n4;
-			break;
-		default:
-			goto fail;
+/* Release all cached trellis objects not held by any decoder */
+void conv_trellis_cache_flush(void)
+{
+	struct vtrellis_entry *entry, **prev;
+
+	pthread_mutex_lock(&trellis_cache_lock);
+
+	prev = &trellis_cache;
+	while ((entry = *prev)) {
+		if (entry->refs) {
+			prev = &entry->next;
+			continue;
 		}
-	} else {
-		goto fail;
+
+		*prev = entry->next;
+		free_trellis_entry(entry);
 	}
 
-	if (code->term == CONV_TERM_FLUSH)
-		dec->len = code->len + code->K - 1;
-	else
-		dec->len = code->len;
+	pthread_mutex_unlock(&trellis_cache_lock);
+}
 
-	dec->trellis = generate_trellis(code);
-	if (!dec->trellis)
-		goto fail;
+/* Default limit on wrap-around tail-biting iterations */
+#define WAVA_MAX_ITER		4
 
-	dec->paths = (int16_t **) malloc(sizeof(int16_t *) * dec->len);
-	dec->paths[0] = vdec_malloc(ns * dec->len);
-	for (i = 1; i < dec->len; i++)
-		dec->paths[i] = &dec->paths[0][i * ns];
+/* 8-bit path metrics
+ *     Soft input is scaled on entry so that the magnitude of any branch
+ *     metric stays below 48, which the 8-bit units rely on for headroom above
+ *     their renormalization threshold. The scale keeps soft values at close
+ *     to 5 bits of resolution, where decoding loss versus 16-bit metrics is
+ *     small. The starting state is initialized below the threshold.
+ */
+#define METRIC8_INIT		64
 
-	return dec;
-fail:
-	free_vdec(dec);
-	return NULL;
+/* Scale by code order N = 2, 3 and 4 */
+static const int metric8_scale[3] = { 23, 15, 11 };
+
+/* Generate the soft input scaling table indexed by the unsigned input value
+ *     Scale with rounding to nearest.
+ */
+static int8_t *gen_scale_metric8(int n)
+{
+	int i, v, scale = metric8_scale[n - 2];
+	int8_t *table;
+
+	table = (int8_t *) malloc(256);
+	if (!table)
+		return NULL;
+
+	for (i = 0; i < 256; i++) {
+		v = (int8_t) i;
+		if (v < 0)
+			table[i] = (v * scale - INT8_MAX / 2) / INT8_MAX;
+		else
+			table[i] = (v * scale + INT8_MAX / 2) / INT8_MAX;
+	}
+
+	return table;
 }
 
-/* Depuncture sequence with nagative value terminated puncturing matrix */
-static int depuncture(const int8_t *in, const int *punc, int8_t *out, int len)
+/* Fill puncturing map
+ *     Walk the negative value terminated puncturing matrix once at decoder
+ *     creation and record, for each trellis step, where its transmitted
+ *     symbols start in the punctured input and which symbols were removed.
+ */
+static void fill_punc_map(struct vstep *steps, const int *punc, int len, int n)
 {
-	int i, n = 0, m = 0;
+	int i, j, m = 0;
 
 	for (i = 0; i < len; i++) {
-		if (i == punc[n]) {
-			out[i] = 0;
-			n++;
-			continue;
+		steps[i].off = m;
+		steps[i].erase = 0;
+
+		for (j = 0; j < n; j++) {
+			if (i * n + j == *punc) {
+				steps[i].erase |= 1 << j;
+				punc++;
+			} else {
+				m++;
+			}
+		}
+	}
+}
+
+/* Allocate and generate the puncturing map */
+static struct vstep *gen_punc_map(const int *punc, int len, int n)
+{
+	struct vstep *steps;
+
+	steps = (struct vstep *) malloc(sizeof(struct vstep) * len);
+	if (!steps)
+		return NULL;
+
+	fill_punc_map(steps, punc, len, n);
+
+	return steps;
+}
+
+/* Reset decoder
+ *     Set accumulated path metrics to zero. For termination other than
+ *     tail-biting, initialize the zero state as the encoder starting state.
+ *     Intialize with the maximum accumulated sum at length equal to the
+ *     constraint length.
+ */
+static void reset_decoder(struct vdecoder *dec, int term)
+{
+	int ns = dec->trellis->num_states;
+
+	memset(dec->sums, 0, sizeof(int16_t) * ns);
+	dec->saturated = 0;
+
+	if (dec->metric == VDEC_METRIC_8) {
+		if (term != CONV_TERM_TAIL_BITING)
+			((int8_t *) dec->sums)[0] = METRIC8_INIT;
+		return;
+	}
+
+	if (term != CONV_TERM_TAIL_BITING)
+		dec->sums[0] = INT8_MAX * dec->n * dec->k;
+}
+
+/* Path decision of a state at a given trellis step */
+static inline unsigned vdec_path(const struct vdecoder *dec,
+				 int i, unsigned state)
+{
+	uint16_t bits;
+
+	if (dec->packed) {
+		bits = dec->paths[i][state >> 4];
+		return !((bits >> (state & 0x0f)) & 0x01);
+	}
+
+	return dec->paths[i][state] + 1;
+}
+
+/* Trace back 'len' steps from 'state' and return the starting state */
+static unsigned _traceback(struct vdecoder *dec,
+			   unsigned state, uint8_t *out, int len)
+{
+	int i;
+	unsigned path;
+
+	for (i = len - 1; i >= 0; i--) {
+		path = vdec_path(dec, i, state);
+		out[i] = dec->trellis->vals[state];
+		state = vstate_lshift(state, dec->k, path);
+	}
+
+	return state;
+}
+
+static unsigned _traceback_rec(struct vdecoder *dec,
+			       unsigned state, uint8_t *out, int len)
+{
+	int i;
+	unsigned path;
+
+	for (i = len - 1; i >= 0; i--) {
+		path = vdec_path(dec, i, state);
+		out[i] = path ^ dec->trellis->vals[state];
+		state = vstate_lshift(state, dec->k, path);
+	}
+
+	return state;
+}
+
+/* Trace back into packed output
+ *     Bits are collected a byte at a time while walking backwards and each
+ *     byte is written once complete. Unused bits of the last byte are zero.
+ */
+static unsigned _traceback_packed(struct vdecoder *dec, unsigned state,
+				  uint8_t *out, int len, int lsb)
+{
+	int i;
+	unsigned path, bit, acc = 0;
+	unsigned order = lsb ? 0 : 7, rec = dec->recursive ? 1 : 0;
+
+	for (i = len - 1; i >= 0; i--) {
+		path = vdec_path(dec, i, state);
+		bit = dec->trellis->vals[state] ^ (path & rec);
+
+		acc |= bit << ((i & 7) ^ order);
+		if (!(i & 7)) {
+			out[i >> 3] = acc;
+			acc = 0;
 		}
 
-		out[i] = in[m++];
+		state = vstate_lshift(state, dec->k, path);
+	}
+
+	return state;
+}
+
+/* Trace back 'len' steps into the requested output format */
+static unsigned trace_output(struct vdecoder *dec, unsigned state,
+			     uint8_t *out, int len, enum vdec_output fmt)
+{
+	if (fmt != VDEC_OUT_UBIT)
+		return _traceback_packed(dec, state, out, len,
+					 fmt == VDEC_OUT_PBIT_LSB);
+	if (dec->use_spec && (len == dec->num_bits))
+		return dec->spec->traceback(dec->paths[0], dec->trellis->vals,
+					    state, out);
+	if (dec->recursive)
+		return _traceback_rec(dec, state, out, len);
+
+	return _traceback(dec, state, out, len);
+}
+
+/* Find the state with the largest accumulated path metric
+ *     Modulo path metrics are compared by difference against state zero.
+ */
+static int best_state(struct vdecoder *dec, unsigned *state)
+{
+	int i, sum, max = -1;
+
+	for (i = 0; i < dec->trellis->num_states; i++) {
+		if (dec->metric == VDEC_METRIC_8)
+			sum = ((int8_t *) dec->sums)[i];
+		else if (dec->metric == VDEC_METRIC_MOD)
+			sum = (int16_t) (dec->sums[i] - dec->sums[0]);
+		else
+			sum = dec->sums[i];
+		if (sum > max) {
+			max = sum;
+			*state = i;
+		}
 	}
 
+	if (max < 0)
+		return -EPROTO;
+
 	return 0;
 }
 
-/* Forward trellis recursion
- *     Generate branch metrics and path metrics with a combined function. Only
- *     accumulated path metric sums and path selections are stored. Normalize on
- *     the interval specified by the decoder.
+/* Longest trellis held by the register exchange survivors */
+#define REX_MAX_LEN		64
+
+/* Register exchange survivor update
+ *     Each state carries the decoded bits of its survivor path as a 64-bit
+ *     word, most recent bit lowest. After the add-compare-select of step
+ *     'i', every state takes the history of its selected predecessor and
+ *     appends its own decoded bit, so no traceback is needed at the end of
+ *     the frame. Histories start out as the state number, which is shifted
+ *     up past the decoded bits and gives the starting state of a survivor
+ *     for tail-biting codes. SIMD kernel sets fold the update into their
+ *     register exchange units, while the generic set and 8-bit and modulo
+ *     path metrics run the update below on the stored path decisions.
  */
-static void _conv_decode(struct vdecoder *dec, const int8_t *seq, int _cnt)
+static void rex_reset(struct vdecoder *dec)
+{
+	int i;
+
+	for (i = 0; i < dec->trellis->num_states; i++)
+		dec->hist[0][i] = i;
+}
+
+static void rex_step(struct vdecoder *dec, int i)
+{
+	int s, ns = dec->trellis->num_states, half = ns / 2;
+	uint64_t a, b, m0, m1;
+	const uint64_t *bits = dec->rex_bits;
+	const uint64_t *h = dec->hist[i & 1];
+	uint64_t *hn = dec->hist[!(i & 1)];
+	unsigned p0, p1;
+
+	/* States 's' and 's + ns / 2' share predecessors '2s' and '2s + 1' */
+	for (s = 0; s < half; s++) {
+		p0 = vdec_path(dec, i, s);
+		p1 = vdec_path(dec, i, s + half);
+		m0 = -(uint64_t) p0;
+		m1 = -(uint64_t) p1;
+		a = h[2 * s];
+		b = h[2 * s + 1];
+
+		hn[s] = (((a & ~m0) | (b & m0)) << 1) |
+			bits[p0 * ns + s];
+		hn[s + half] = (((a & ~m1) | (b & m1)) << 1) |
+			       bits[p1 * ns + s + half];
+	}
+}
+
+/* Write the first 'len' decoded bits of the survivor ending in 'state'
+ *     Returns the starting state of the survivor, which is only complete
+ *     for tail-biting codes.
+ */
+static unsigned rex_output(struct vdecoder *dec, unsigned state,
+			   uint8_t *out, int len, enum vdec_output fmt)
 {
-	int i, len = dec->len;
-	struct vtrellis *trellis = dec->trellis;
+	int i, shift, lsb = fmt == VDEC_OUT_PBIT_LSB;
+	uint64_t h = dec->hist[dec->len & 1][state];
+
+	if (fmt != VDEC_OUT_UBIT)
+		memset(out, 0, (len + 7) / 8);
 
 	for (i = 0; i < len; i++) {
-		dec->metric_func(&seq[dec->n * i],
-				 trellis->outputs,
-				 trellis->sums,
-				 dec->paths[i],
-				 !(i % dec->intrvl));
+		shift = dec->len - 1 - i;
+		if (fmt == VDEC_OUT_UBIT)
+			out[i] = (h >> shift) & 1;
+		else
+			out[i >> 3] |= ((h >> shift) & 1) <<
+				       (lsb ? (i & 7) : 7 - (i & 7));
 	}
+
+	if (dec->len >= REX_MAX_LEN)
+		return 0;
+
+	return (h >> dec->len) & (dec->trellis->num_states - 1);
 }
 
-/* Convolutional decode with a decoder object
- *     Initial puncturing run if necessary followed by the forward recursion.
- *     For tail-biting perform a second pass before running the backward
- *     traceback operation.
+/* Traceback and generate decoded output
+ *     Find the largest accumulated path metric at the final state except for
+ *     the zero terminated case, where we assume the final state is always zero.
  */
-static int conv_decode(struct vdecoder *dec, const int8_t *seq,
-		       const int *punc, uint8_t *out, int len, int term)
+static int traceback(struct vdecoder *dec, uint8_t *out, int term, int len,
+		     enum vdec_output fmt)
 {
-	int cnt = 0;
-	int8_t depunc[dec->len * dec->n];
+	int i;
+	unsigned path, state = 0;
 
-	reset_decoder(dec, term);
+	if (term != CONV_TERM_FLUSH) {
+		if (best_state(dec, &state) < 0)
+			return -EPROTO;
+	}
 
-	if (punc) {
-		depuncture(seq, punc, depunc, dec->len * dec->n);
-		seq = depunc;
+	if (dec->rex) {
+		rex_output(dec, state, out, len, fmt);
+		return 0;
 	}
 
-	/* Propagate through the trellis with interval normalization */
-	_conv_decode(dec, seq, cnt);
+	for (i = dec->len - 1; i >= len; i--) {
+		path = vdec_path(dec, i, state);
+		state = vstate_lshift(state, dec->k, path);
+	}
 
-	if (term == CONV_TERM_TAIL_BITING)
-		_conv_decode(dec, seq, cnt);
+	trace_output(dec, state, out, len, fmt);
 
-	return traceback(dec, out, term, len);
+	return 0;
 }
 
-/* All-in-one viterbi decoding  */
-int test_conv_decode(const struct osmo_conv_code *code,
-		     const sbit_t *input, ubit_t *output)
+/* Compare negative value terminated puncturing matrices */
+static int punc_equal(const int *a, const int *b)
 {
-	int rc;
-	struct vdecoder *vdec;
+	if (!a || !b)
+		return a == b;
 
-	if ((code->N < 2) || (code->N > 4) || (code->len < 1) ||
-	    ((code->K != 5) && (code->K != 7)))
+	for (; (*a >= 0) && (*a == *b); a++, b++);
+
+	return (*a < 0) && (*b < 0);
+}
+
+/* Find the generated specialization of a code
+ *     Returns the index into the specialized routines of each kernel set or
+ *     -1 if the code was not generated.
+ */
+static int find_spec(const struct osmo_conv_code *code)
+{
+	int i;
+	const struct vspec *spec;
+
+	for (i = 0; i < CONV_SPEC_COUNT; i++) {
+		spec = &vspecs[i];
+		if ((spec->n == code->N) && (spec->k == code->K) &&
+		    (spec->len == code->len) && (spec->term == code->term) &&
+		    (spec->recursive == conv_code_recursive(code)) &&
+		    punc_equal(spec->puncture, code->puncture))
+			return i;
+	}
+
+	return -1;
+}
+
+/* Release decoder object */
+static void free_vdec(struct vdecoder *dec)
+{
+	if (!dec)
+		return;
+
+	/* Only register exchange storage is allocated in workspace decoders */
+	if (dec->ws) {
+		free(dec->hist[0]);
+		return;
+	}
+
+	if (dec->paths)
+		free(dec->paths[0]);
+	free(dec->paths);
+	free(dec->sums);
+	free(dec->scale8);
+	free((void *) dec->steps);
+	free(dec->hist[0]);
+	put_trellis(dec->trellis);
+	free(dec);
+}
+
+/* Initialize decoder parameters
+ *     Subtract the constraint length K on the normalization interval to
+ *     accommodate the initialization path metric at state zero. 8-bit path
+ *     metrics share the sums storage and renormalize adaptively, and modulo
+ *     path metrics are never normalized, so the interval is unused by both.
+ *     Storage is attached by the caller.
+ */
+static int init_vdec(struct vdecoder *dec, const struct osmo_conv_code *code,
+		     enum vdec_metric metric)
+{
+	int i;
+	const struct vkernels *ks = get_kernels();
+
+	dec->n = code->N;
+	dec->k = code->K;
+	dec->num_bits = code->len;
+	dec->term = code->term;
+	dec->recursive = conv_code_recursive(code);
+	dec->intrvl = INT16_MAX / (dec->n * INT8_MAX) - dec->k;
+	dec->metric = metric;
+	dec->max_iter = WAVA_MAX_ITER;
+
+	if ((dec->n < 2) || (dec->n > 4) || (dec->k < 3) || (dec->k > 9))
 		return -EINVAL;
 
-	vdec = alloc_vdec(code);
-	if (!vdec)
-		return -EFAULT;
+	if (metric == VDEC_METRIC_MOD)
+		dec->metric_func = ks->mod[dec->k - 3][dec->n - 2];
+	else
+		dec->metric_func = ks->metrics[dec->k - 3][dec->n - 2];
+
+	/* 8-bit path metrics are only available for K = 5 and 7 */
+	if (dec->k == 5)
+		dec->metric8_func = ks->k5_8[dec->n - 2];
+	else if (dec->k == 7)
+		dec->metric8_func = ks->k7_8[dec->n - 2];
+	else if (metric == VDEC_METRIC_8)
+		return -EINVAL;
 
-	rc = conv_decode(vdec, input, code->puncture,
-			 output, code->len, code->term);
+	/* Whole-frame units hold 16-bit saturating metrics of K = 5 */
+	if ((metric == VDEC_METRIC_16) && (dec->k == 5))
+		dec->frame_func = ks->k5_frame[dec->n - 2];
 
-	free_vdec(vdec);
+	if (metric == VDEC_METRIC_16)
+		dec->rex_func = ks->rex[dec->k - 3][dec->n - 2];
 
-	return rc;
+	if (code->term == CONV_TERM_FLUSH)
+		dec->len = code->len + code->K - 1;
+	else
+		dec->len = code->len;
+
+	dec->packed = ks->packed;
+
+	/* 8-bit units read trellis outputs for all constraint lengths */
+	if ((metric != VDEC_METRIC_8) && (dec->k >= 6))
+		dec->unique = ks->unique;
+
+	if (metric == VDEC_METRIC_16) {
+		i = find_spec(code);
+		if (i >= 0) {
+			dec->spec = &ks->specs[i];
+			dec->use_spec = 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Allocate decoder object */
+static struct vdecoder *alloc_vdec(const struct osmo_conv_code *code,
+				   enum vdec_metric metric)
+{
+	int i, ns, stride;
+	struct vdecoder *dec;
+
+	ns = NUM_STATES(code->K);
+
+	dec = (struct vdecoder *) calloc(1, sizeof(struct vdecoder));
+	if (!dec)
+		return NULL;
+
+	if (init_vdec(dec, code, metric) < 0)
+		goto fail;
+
+	dec->trellis = get_trellis(code);
+	if (!dec->trellis)
+		goto fail;
+
+	dec->outputs = dec->unique ? dec->trellis->bmidx :
+				     dec->trellis->outputs;
+
+	dec->sums = vdec_malloc(PAD_STATES(ns));
+	if (!dec->sums)
+		goto fail;
+
+	stride = dec->packed ? PAD_STATES(ns) / 16 : ns;
+
+	dec->paths = (int16_t **) malloc(sizeof(int16_t *) * dec->len);
+	if (!dec->paths)
+		goto fail;
+
+	dec->paths[0] = vdec_malloc(stride * dec->len);
+	if (!dec->paths[0])
+		goto fail;
+
+	for (i = 1; i < dec->len; i++)
+		dec->paths[i] = &dec->paths[0][i * stride];
+
+	if (metric == VDEC_METRIC_8) {
+		dec->scale8 = gen_scale_metric8(dec->n);
+		if (!dec->scale8)
+			goto fail;
+	}
+
+	if (code->puncture) {
+		dec->steps = gen_punc_map(code->puncture, dec->len, dec->n);
+		if (!dec->steps)
+			goto fail;
+	}
+
+	return dec;
+fail:
+	free_vdec(dec);
+	return NULL;
+}
+
+/* Branch metric input of one trellis step
+ *     Unpunctured steps are read in place. Punctured steps are gathered into
+ *     'val' with zeros at the erased symbols, so no depunctured copy of the
+ *     whole frame is made.
+ */
+static inline const int8_t *step_input(const struct vdecoder *dec,
+				       const int8_t *seq, int i, int8_t *val)
+{
+	int j;
+	const struct vstep *step;
+
+	if (!dec->steps)
+		return &seq[dec->n * i];
+
+	step = &dec->steps[i];
+	seq += step->off;
+	if (!step->erase)
+		return seq;
+
+	for (j = 0; j < dec->n; j++)
+		val[j] = (step->erase & (1 << j)) ? 0 : *seq++;
+
+	return val;
+}
+
+/* Forward trellis recursion with a whole-frame metric unit
+ *     Spans of unpunctured steps are passed to the unit in a single call,
+ *     which keeps the path metrics in registers across the span. Steps with
+ *     erased symbols are gathered and run with the per-step unit.
+ */
+static void _conv_decode_frame(struct vdecoder *dec, const int8_t *seq)
+{
+	int i, j, norm = 0, len = dec->len;
+	int8_t val[4];
+
+	if (!dec->steps) {
+		dec->frame_func(seq, dec->outputs, dec->sums,
+				dec->paths[0], len, dec->intrvl, 0);
+		return;
+	}
+
+	for (i = 0; i < len; i = j) {
+		for (j = i; (j < len) && !dec->steps[j].erase; j++);
+
+		if (j > i) {
+			norm = dec->frame_func(&seq[dec->steps[i].off],
+					       dec->outputs, dec->sums,
+					       dec->paths[i], j - i,
+					       dec->intrvl, norm);
+			continue;
+		}
+
+		dec->metric_func(step_input(dec, seq, i, val),
+				 dec->outputs,
+				 dec->sums,
+				 dec->paths[i],
+				 !norm);
+		if (++norm == dec->intrvl)
+			norm = 0;
+		j = i + 1;
+	}
+}
+
+/* Forward trellis recursion
+ *     Generate branch metrics and path metrics with a combined function. Only
+ *     accumulated path metric sums and path selections are stored. Normalize on
+ *     the interval specified by the decoder, tracked with a countdown rather
+ *     than a divide on every step. Modulo metric units ignore the flag.
+ */
+static void _conv_decode(struct vdecoder *dec, const int8_t *seq, int _cnt)
+{
+	int i, norm = 0, len = dec->len;
+	int8_t val[4];
+
+	if (dec->frame_func && !dec->rex) {
+		_conv_decode_frame(dec, seq);
+		return;
+	}
+
+	for (i = 0; i < len; i++) {
+		dec->metric_func(step_input(dec, seq, i, val),
+				 dec->outputs,
+				 dec->sums,
+				 dec->paths[i],
+				 !norm);
+
+		if (dec->rex)
+			rex_step(dec, i);
+
+		if (++norm == dec->intrvl)
+			norm = 0;
+	}
+}
+
+/* Forward trellis recursion with 8-bit path metrics
+ *     Soft input is scaled to the 8-bit metric range by table lookup as each
+ *     step is read. Renormalization is handled by the metric units, which
+ *     report saturation of the path metrics.
+ */
+static void _conv_decode8(struct vdecoder *dec, const int8_t *seq)
+{
+	int i, j, len = dec->len;
+	int8_t val[4];
+	const int8_t *in;
+	const struct vtrellis *trellis = dec->trellis;
+
+	for (i = 0; i < len; i++) {
+		in = step_input(dec, seq, i, val);
+		for (j = 0; j < dec->n; j++)
+			val[j] = dec->scale8[(uint8_t) in[j]];
+
+		dec->saturated |= dec->metric8_func(val,
+						    trellis->outputs,
+						    (int8_t *) dec->sums,
+						    dec->paths[i]);
+		if (dec->rex)
+			rex_step(dec, i);
+	}
+}
+
+/* Forward trellis recursion with register exchange units
+ *     Survivor histories alternate between the two buffers on each step and
+ *     no path decisions are stored. Normalization follows _conv_decode().
+ */
+static void _conv_decode_rex(struct vdecoder *dec, const int8_t *seq)
+{
+	int i, norm = 0, len = dec->len;
+	int8_t val[4];
+
+	for (i = 0; i < len; i++) {
+		dec->rex_func(step_input(dec, seq, i, val),
+			      dec->outputs,
+			      dec->sums,
+			      dec->hist[i & 1],
+			      dec->hist[!(i & 1)],
+			      dec->rex_bits,
+			      !norm);
+
+		if (++norm == dec->intrvl)
+			norm = 0;
+	}
+}
+
+/* Forward trellis recursion for the decoder path metric type */
+static void forward(struct vdecoder *dec, const int8_t *seq)
+{
+	if (dec->rex)
+		rex_reset(dec);
+
+	if (dec->metric == VDEC_METRIC_8)
+		_conv_decode8(dec, seq);
+	else if (dec->rex && dec->rex_func)
+		_conv_decode_rex(dec, seq);
+	else if (dec->use_spec && !dec->rex)
+		dec->spec->forward(seq, dec->outputs,
+				   dec->sums, dec->paths[0]);
+	else
+		_conv_decode(dec, seq, 0);
+}
+
+/* Wrap-around Viterbi tail-biting decode (WAVA)
+ *     Each pass starts from the path metrics at the end of the previous pass.
+ *     After each pass, trace back from the best end state and stop once the
+ *     surviving path starts in the same state, which makes it a valid
+ *     tail-biting path, or the iteration limit is reached. At high SNR the
+ *     first pass usually converges, which halves the cost of the fixed two
+ *     pass decode.
+ */
+static int conv_decode_tail(struct vdecoder *dec, const int8_t *seq,
+			    uint8_t *out, int len, enum vdec_output fmt)
+{
+	unsigned start, state = 0;
+
+	for (dec->iters = 1; ; dec->iters++) {
+		forward(dec, seq);
+
+		if (best_state(dec, &state) < 0)
+			return -EPROTO;
+
+		if (dec->rex)
+			start = rex_output(dec, state, out, len, fmt);
+		else
+			start = trace_output(dec, state, out, len, fmt);
+
+		if ((start == state) || (dec->iters >= dec->max_iter))
+			break;
+	}
+
+	return 0;
+}
+
+/* Convolutional decode with a decoder object
+ *     Forward recursion directly on the punctured input followed by the
+ *     backward traceback operation. Tail-biting codes iterate around the
+ *     trellis before the traceback. Output is written as unpacked or packed
+ *     bits according to 'fmt'.
+ */
+static int conv_decode(struct vdecoder *dec, const int8_t *seq,
+		       uint8_t *out, int len, int term, enum vdec_output fmt)
+{
+	reset_decoder(dec, term);
+
+	if (term == CONV_TERM_TAIL_BITING)
+		return conv_decode_tail(dec, seq, out, len, fmt);
+
+	/* Propagate through the trellis with interval normalization */
+	forward(dec, seq);
+	dec->iters = 1;
+
+	return traceback(dec, out, term, len, fmt);
+}
+
+/* Check for supported code parameters */
+static int conv_code_valid(const struct osmo_conv_code *code)
+{
+	if ((code->N < 2) || (code->N > 4) || (code->len < 1) ||
+	    (code->K < 3) || (code->K > 9))
+		return 0;
+
+	return 1;
+}
+
+/* Persistent decoder creation
+ *     Allocate the decoder, trellis and path storage once so that repeated
+ *     calls on the same code avoid the allocation and trellis generation
+ *     overhead of the all-in-one call.
+ */
+struct vdecoder *conv_decoder_create(const struct osmo_conv_code *code)
+{
+	if (!conv_code_valid(code))
+		return NULL;
+
+	return alloc_vdec(code, VDEC_METRIC_16);
+}
+
+/* Persistent decoder creation with 8-bit path metrics
+ *     Trades decoding margin for twice the states per SIMD register. Use
+ *     conv_decoder_saturated() after a run to check whether the metric range
+ *     was exceeded for that frame.
+ */
+struct vdecoder *conv_decoder_create_i8(const struct osmo_conv_code *code)
+{
+	if (!conv_code_valid(code))
+		return NULL;
+
+	return alloc_vdec(code, VDEC_METRIC_8);
+}
+
+/* Persistent decoder creation with modulo path metrics
+ *     Path metrics wrap around and are compared by the sign of their
+ *     difference, which removes normalization from the forward recursion.
+ *     Output is identical to the standard decoder.
+ */
+struct vdecoder *conv_decoder_create_mod(const struct osmo_conv_code *code)
+{
+	if (!conv_code_valid(code))
+		return NULL;
+
+	return alloc_vdec(code, VDEC_METRIC_MOD);
+}
+
+/* Select register exchange or traceback survivors
+ *     Register exchange keeps each survivor in a 64-bit word, so it is only
+ *     available for trellis lengths up to REX_MAX_LEN steps, including the
+ *     flush. Tail-biting codes also keep the K - 1 bit starting state of the
+ *     survivor in the word. Returns -EINVAL for longer codes.
+ */
+int conv_decoder_set_exchange(struct vdecoder *dec, int enable)
+{
+	int i, ns, len;
+	unsigned rec;
+
+	if (!dec)
+		return -EINVAL;
+
+	if (!enable) {
+		dec->rex = 0;
+		return 0;
+	}
+
+	len = dec->len;
+	if (dec->term == CONV_TERM_TAIL_BITING)
+		len += dec->k - 1;
+	if (len > REX_MAX_LEN)
+		return -EINVAL;
+
+	/* Both history buffers and the decoded bits are aligned for SIMD */
+	if (!dec->hist[0]) {
+		ns = dec->trellis->num_states;
+		dec->hist[0] = (uint64_t *) memalign(SSE_ALIGN,
+						     sizeof(uint64_t) * 4 * ns);
+		if (!dec->hist[0])
+			return -ENOMEM;
+
+		dec->hist[1] = &dec->hist[0][ns];
+		dec->rex_bits = &dec->hist[0][2 * ns];
+
+		rec = dec->recursive ? 1 : 0;
+		for (i = 0; i < ns; i++) {
+			dec->rex_bits[i] = dec->trellis->vals[i];
+			dec->rex_bits[ns + i] = dec->trellis->vals[i] ^ rec;
+		}
+	}
+
+	dec->rex = 1;
+	return 0;
+}
+
+/* Select the generated specialization or the generic decoder path
+ *     Decoders with 16-bit path metrics use the routines generated for their
+ *     code from tests/codes.c when one exists. Returns -ENOTSUP when enabling
+ *     on a decoder without a specialization.
+ */
+int conv_decoder_set_specialized(struct vdecoder *dec, int enable)
+{
+	if (!dec)
+		return -EINVAL;
+
+	if (enable && !dec->spec)
+		return -ENOTSUP;
+
+	dec->use_spec = enable ? 1 : 0;
+	return 0;
+}
+
+/* Set the maximum number of tail-biting iterations
+ *     Returns -EINVAL if the limit is less than one.
+ */
+int conv_decoder_set_max_iter(struct vdecoder *dec, int max_iter)
+{
+	if (!dec || (max_iter < 1))
+		return -EINVAL;
+
+	dec->max_iter = max_iter;
+	return 0;
+}
+
+/* Number of trellis passes in the last decoder run
+ *     Always '1' except for tail-biting codes.
+ */
+int conv_decoder_iterations(const struct vdecoder *dec)
+{
+	if (!dec)
+		return -EINVAL;
+
+	return dec->iters;
+}
+
+/* Per-step metric unit of a decoder
+ *     For kernel microbenchmarks. Sets the unit selected for the decoder's
+ *     code, path metric type and kernel set, the trellis table it reads and
+ *     the normalization interval, the number of steps 16-bit path metrics
+ *     can run from zero without normalizing. The unit takes N soft symbols,
+ *     the table, PAD_STATES 16-bit path metrics and a row of path
+ *     decisions. Returns the number of 16-bit path decision words per
+ *     trellis step, or -ENOTSUP for decoders with 8-bit path metrics.
+ */
+int conv_decoder_metric_unit(const struct vdecoder *dec,
+			     void (**unit)(const int8_t *, const int16_t *,
+					   int16_t *, int16_t *, int),
+			     const int16_t **table, int *intrvl)
+{
+	int ns;
+
+	if (!dec || !unit || !table || !intrvl)
+		return -EINVAL;
+
+	if (dec->metric == VDEC_METRIC_8)
+		return -ENOTSUP;
+
+	ns = NUM_STATES(dec->k);
+
+	*unit = dec->metric_func;
+	*table = dec->outputs;
+	*intrvl = dec->intrvl;
+
+	return dec->packed ? PAD_STATES(ns) / 16 : ns;
+}
+
+/* Whole-frame metric unit of a decoder
+ *     For kernel microbenchmarks. Sets the unit that runs unpunctured spans
+ *     of K = 5 codes and the trellis table it reads. The unit takes the soft
+ *     symbols of a span, the table, the path metrics, the path decisions of
+ *     the span, its length, the normalization interval and the normalization
+ *     countdown, and returns the countdown at the end of the span. Returns
+ *     the number of 16-bit path decision words per trellis step, or -ENOTSUP
+ *     if the decoder has no whole-frame unit.
+ */
+int conv_decoder_frame_unit(const struct vdecoder *dec,
+			    int (**unit)(const int8_t *, const int16_t *,
+					 int16_t *, int16_t *, int, int, int),
+			    const int16_t **table)
+{
+	if (!dec || !unit || !table)
+		return -EINVAL;
+
+	if (!dec->frame_func)
+		return -ENOTSUP;
+
+	*unit = dec->frame_func;
+	*table = dec->outputs;
+
+	return dec->packed ? PAD_STATES(NUM_STATES(dec->k)) / 16 :
+			     NUM_STATES(dec->k);
+}
+
+/* Repeat the traceback of the last decoder run
+ *     For kernel microbenchmarks. Walks the path decisions left by the last
+ *     conv_decoder_run() into unpacked output without a forward recursion.
+ *     Returns -EINVAL if the decoder has not been run.
+ */
+int conv_decoder_traceback(struct vdecoder *dec, ubit_t *output)
+{
+	if (!dec || !dec->iters)
+		return -EINVAL;
+
+	return traceback(dec, output, dec->term, dec->num_bits,
+			 VDEC_OUT_UBIT);
+}
+
+/* Returns '1' if path metrics saturated during the last decoder run */
+int conv_decoder_saturated(const struct vdecoder *dec)
+{
+	if (!dec)
+		return -EINVAL;
+
+	return dec->saturated;
+}
+
+/* Persistent decoder release */
+void conv_decoder_free(struct vdecoder *dec)
+{
+	free_vdec(dec);
+}
+
+/* Decode one frame with a persistent decoder */
+int conv_decoder_run(struct vdecoder *dec,
+		     const sbit_t *input, ubit_t *output)
+{
+	if (!dec)
+		return -EINVAL;
+
+	return conv_decode(dec, input, output, dec->num_bits,
+			   dec->term, VDEC_OUT_UBIT);
+}
+
+/* Decode one frame into packed output with a persistent decoder
+ *     Bits are packed MSB first, or LSB first if 'lsb' is set. The output
+ *     holds (len + 7) / 8 bytes with unused bits of the last byte cleared.
+ */
+int conv_decoder_run_packed(struct vdecoder *dec, const sbit_t *input,
+			    pbit_t *output, int lsb)
+{
+	if (!dec)
+		return -EINVAL;
+
+	return conv_decode(dec, input, output, dec->num_bits, dec->term,
+			   lsb ? VDEC_OUT_PBIT_LSB : VDEC_OUT_PBIT_MSB);
+}
+
+/* All-in-one viterbi decoding  */
+int test_conv_decode(const struct osmo_conv_code *code,
+		     const sbit_t *input, ubit_t *output)
+{
+	int rc;
+	struct vdecoder *vdec;
+
+	if (!conv_code_valid(code))
+		return -EINVAL;
+
+	vdec = conv_decoder_create(code);
+	if (!vdec)
+		return -EFAULT;
+
+	rc = conv_decoder_run(vdec, input, output);
+
+	conv_decoder_free(vdec);
+
+	return rc;
+}
+
+/* All-in-one viterbi decoding into packed output */
+int test_conv_decode_packed(const struct osmo_conv_code *code,
+			    const sbit_t *input, pbit_t *output, int lsb)
+{
+	int rc;
+	struct vdecoder *vdec;
+
+	if (!conv_code_valid(code))
+		return -EINVAL;
+
+	vdec = conv_decoder_create(code);
+	if (!vdec)
+		return -EFAULT;
+
+	rc = conv_decoder_run_packed(vdec, input, output, lsb);
+
+	conv_decoder_free(vdec);
+
+	return rc;
+}
+
+/* Workspace Decoder
+ *     The decoder object, trellis, path metrics, path decisions and
+ *     puncturing map are laid out in a single caller owned buffer, each part
+ *     starting on an SSE_ALIGN boundary. Path storage is sized for unpacked
+ *     decisions, which is the larger of the two layouts, so the size does not
+ *     depend on the selected kernel set. The trellis is generated in place
+ *     and not shared through the trellis cache.
+ */
+struct vworkspace {
+	struct vdecoder dec;
+	struct vtrellis trellis;
+};
+
+#define WS_ALIGN(X)	(((X) + SSE_ALIGN - 1) & ~((size_t) SSE_ALIGN - 1))
+
+/* Reserve 'len' bytes of the workspace
+ *     Returns NULL and only advances the offset when 'ws' is NULL, which
+ *     is used for the size query.
+ */
+static void *ws_take(uint8_t *ws, size_t *off, size_t len)
+{
+	void *p = ws ? &ws[*off] : NULL;
+
+	*off += WS_ALIGN(len);
+
+	return p;
+}
+
+/* Lay out decoder storage within the workspace
+ *     Returns the number of bytes used. The decoder is only initialized when
+ *     'ws' is not NULL.
+ */
+static size_t ws_layout(const struct osmo_conv_code *code, uint8_t *ws,
+			struct vdecoder **dec_out)
+{
+	int i, ns, len, stride, olen;
+	size_t off = 0;
+	struct vworkspace *w;
+	struct vdecoder *dec;
+	struct vstep *steps = NULL;
+	int16_t *outputs, *bmidx, *sums, **rows, *paths;
+	uint8_t *vals;
+
+	ns = NUM_STATES(code->K);
+	olen = TRELLIS_OLEN(code->N);
+
+	if (code->term == CONV_TERM_FLUSH)
+		len = code->len + code->K - 1;
+	else
+		len = code->len;
+
+	w = (struct vworkspace *) ws_take(ws, &off, sizeof(*w));
+	outputs = (int16_t *) ws_take(ws, &off,
+				      sizeof(int16_t) * PAD_STATES(ns) * olen);
+	vals = (uint8_t *) ws_take(ws, &off, ns);
+	bmidx = (int16_t *) ws_take(ws, &off,
+				    sizeof(int16_t) * TRELLIS_BMLEN(ns));
+	sums = (int16_t *) ws_take(ws, &off, sizeof(int16_t) * PAD_STATES(ns));
+	rows = (int16_t **) ws_take(ws, &off, sizeof(int16_t *) * len);
+	paths = (int16_t *) ws_take(ws, &off, sizeof(int16_t) * ns * len);
+	if (code->puncture)
+		steps = (struct vstep *) ws_take(ws, &off,
+						 sizeof(struct vstep) * len);
+	if (!ws)
+		return off;
+
+	memset(w, 0, sizeof(*w));
+	dec = &w->dec;
+	dec->ws = 1;
+	if (init_vdec(dec, code, VDEC_METRIC_16) < 0)
+		return 0;
+
+	w->trellis.outputs = outputs;
+	w->trellis.vals = vals;
+	w->trellis.bmidx = bmidx;
+	if (fill_trellis(&w->trellis, code) < 0)
+		return 0;
+
+	dec->trellis = &w->trellis;
+	dec->outputs = dec->unique ? w->trellis.bmidx : w->trellis.outputs;
+	dec->sums = sums;
+	dec->paths = rows;
+
+	stride = dec->packed ? PAD_STATES(ns) / 16 : ns;
+	for (i = 0; i < len; i++)
+		dec->paths[i] = &paths[i * stride];
+
+	if (steps) {
+		fill_punc_map(steps, code->puncture, len, dec->n);
+		dec->steps = steps;
+	}
+
+	*dec_out = dec;
+
+	return off;
+}
+
+/* Decoder workspace size
+ *     Number of bytes required by conv_decoder_init() for the code, or
+ *     -EINVAL if the code is not supported.
+ */
+int conv_decoder_workspace_size(const struct osmo_conv_code *code)
+{
+	if (!conv_code_valid(code))
+		return -EINVAL;
+
+	return ws_layout(code, NULL, NULL);
+}
+
+/* Decoder creation in a caller provided workspace
+ *     The workspace must be aligned to 32 bytes and hold at least
+ *     conv_decoder_workspace_size() bytes. No heap allocation is made, and
+ *     the decoder remains valid for as long as the workspace. Use
+ *     conv_decoder_free() only if register exchange was enabled, which
+ *     allocates its history separately.
+ */
+struct vdecoder *conv_decoder_init(void *ws, size_t size,
+				   const struct osmo_conv_code *code)
+{
+	struct vdecoder *dec = NULL;
+
+	if (!ws || ((uintptr_t) ws & (SSE_ALIGN - 1)))
+		return NULL;
+
+	if (!conv_code_valid(code) || (size < ws_layout(code, NULL, NULL)))
+		return NULL;
+
+	if (!ws_layout(code, (uint8_t *) ws, &dec))
+		return NULL;
+
+	return dec;
+}
+
+/* All-in-one viterbi decoding with a caller provided workspace
+ *     Same as test_conv_decode() without heap allocation. Stack use does not
+ *     depend on the code or frame length. Returns -ENOSPC if the workspace is
+ *     misaligned or too small.
+ */
+int test_conv_decode_ws(const struct osmo_conv_code *code,
+			const sbit_t *input, ubit_t *output,
+			void *ws, size_t size)
+{
+	struct vdecoder *vdec;
+
+	if (!conv_code_valid(code))
+		return -EINVAL;
+
+	vdec = conv_decoder_init(ws, size, code);
+	if (!vdec)
+		return -ENOSPC;
+
+	return conv_decoder_run(vdec, input, output);
+}
+
+/* Windowed Viterbi Decoder
+ *     dec   - Decoder object with circular path storage
+ *     depth - Decision depth in trellis steps
+ *     size  - Number of trellis steps held in path storage
+ *     flush - Set to '1' if the stream is zero terminated
+ *     row   - Path storage row of the next trellis step
+ *     norm  - Trellis steps since the last normalization
+ *     pos   - Number of trellis steps processed
+ *     done  - Number of decoded bits output
+ */
+struct vwindow {
+	struct vdecoder *dec;
+	int depth;
+	int size;
+	int flush;
+	int row;
+	int norm;
+	unsigned long pos;
+	unsigned long done;
+};
+
+/* Reset windowed decoder to the zero state at the start of a stream */
+static void reset_window(struct vwindow *win)
+{
+	reset_decoder(win->dec, CONV_TERM_FLUSH);
+	win->row = 0;
+	win->norm = 0;
+	win->pos = 0;
+	win->done = 0;
+}
+
+/* Circular traceback
+ *     Starting at 'state' after trellis step 'end', trace back 'skip' steps
+ *     without output and then output 'cnt' bits for the preceding steps.
+ */
+static void window_traceback(struct vwindow *win, unsigned state,
+			     unsigned long end, int skip, int cnt,
+			     uint8_t *out)
+{
+	int row;
+	unsigned path;
+	struct vdecoder *dec = win->dec;
+
+	row = end % win->size;
+
+	while (skip--) {
+		row = row ? row - 1 : win->size - 1;
+		path = vdec_path(dec, row, state);
+		state = vstate_lshift(state, dec->k, path);
+	}
+
+	while (cnt--) {
+		row = row ? row - 1 : win->size - 1;
+		path = vdec_path(dec, row, state);
+
+		if (dec->recursive)
+			out[cnt] = path ^ dec->trellis->vals[state];
+		else
+			out[cnt] = dec->trellis->vals[state];
+
+		state = vstate_lshift(state, dec->k, path);
+	}
+}
+
+/* Windowed decoder creation
+ *     Path storage holds twice the decision depth. Once full, trace back from
+ *     the best state and output the oldest half, so memory use is fixed
+ *     regardless of stream length. Tail-biting and punctured codes are not
+ *     supported; the code length is ignored.
+ */
+struct vwindow *conv_window_create(const struct osmo_conv_code *code,
+				   int depth)
+{
+	struct vwindow *win;
+	struct osmo_conv_code _code;
+
+	if ((code->term == CONV_TERM_TAIL_BITING) || code->puncture)
+		return NULL;
+	if (depth < code->K)
+		return NULL;
+
+	memcpy(&_code, code, sizeof(_code));
+	_code.len = 2 * depth;
+	_code.term = CONV_TERM_TRUNCATION;
+
+	if (!conv_code_valid(&_code))
+		return NULL;
+
+	win = (struct vwindow *) calloc(1, sizeof(struct vwindow));
+	if (!win)
+		return NULL;
+
+	win->dec = alloc_vdec(&_code, VDEC_METRIC_16);
+	if (!win->dec) {
+		free(win);
+		return NULL;
+	}
+
+	win->depth = depth;
+	win->size = 2 * depth;
+	win->flush = code->term == CONV_TERM_FLUSH;
+	reset_window(win);
+
+	return win;
+}
+
+/* Windowed decoder release */
+void conv_window_free(struct vwindow *win)
+{
+	if (!win)
+		return;
+
+	free_vdec(win->dec);
+	free(win);
+}
+
+/* Push input into the windowed decoder
+ *     Run 'steps' trellis steps of N soft symbols each and return the number
+ *     of decoded bits written to the output, which must have room for at
+ *     least 'steps' plus the decision depth bits.
+ */
+int conv_window_push(struct vwindow *win, const sbit_t *input,
+		     int steps, ubit_t *output)
+{
+	int i, cnt = 0;
+	int blk = win->size - win->depth;
+	unsigned state = 0;
+	struct vdecoder *dec = win->dec;
+
+	for (i = 0; i < steps; i++) {
+		dec->metric_func(&input[dec->n * i],
+				 dec->outputs,
+				 dec->sums,
+				 dec->paths[win->row],
+				 !win->norm);
+		if (++win->norm == dec->intrvl)
+			win->norm = 0;
+
+		win->pos++;
+		if (++win->row == win->size)
+			win->row = 0;
+
+		if (win->pos - win->done < win->size)
+			continue;
+
+		if (best_state(dec, &state) < 0)
+			return -EPROTO;
+
+		window_traceback(win, state, win->pos,
+				 win->depth, blk, &output[cnt]);
+		win->done += blk;
+		cnt += blk;
+	}
+
+	return cnt;
+}
+
+/* End of stream
+ *     Output all remaining decoded bits and reset the decoder for the next
+ *     stream. Zero terminated streams trace back from the zero state and
+ *     drop the K - 1 tail bits.
+ */
+int conv_window_flush(struct vwindow *win, ubit_t *output)
+{
+	int cnt, skip = 0;
+	unsigned state = 0;
+	struct vdecoder *dec = win->dec;
+
+	cnt = win->pos - win->done;
+
+	if (win->flush) {
+		skip = cnt < dec->k - 1 ? cnt : dec->k - 1;
+		cnt -= skip;
+	} else if (best_state(dec, &state) < 0) {
+		return -EPROTO;
+	}
+
+	window_traceback(win, state, win->pos, skip, cnt, output);
+	reset_window(win);
+
+	return cnt;
+}
+
+/* Batch Decoder
+ *     Decode several frames of the same code in lockstep with one frame per
+ *     16-bit SIMD lane. Lanes are allocated in groups of 8, so batches of
+ *     fewer than 8 frames leave the upper lanes idle.
+ *
+ *     width    - Number of frames per batch
+ *     lanes    - Number of allocated lanes
+ *     bidx     - Branch metric index of each butterfly
+ *     seq      - Depunctured soft input, 'lanes' values per code bit
+ *     sums     - Double buffered path metrics, 'lanes' values per state
+ *     paths    - Path decisions, 'lanes' bits per state and trellis step
+ *     func     - Batch metric unit of the active kernel set
+ */
+struct vbatch {
+	int n;
+	int k;
+	int len;
+	int num_bits;
+	int term;
+	int recursive;
+	int intrvl;
+	const int *punc;
+	const struct vtrellis *trellis;
+
+	int width;
+	int lanes;
+	uint8_t *bidx;
+	int16_t *seq;
+	int16_t *sums[2];
+	uint8_t *paths;
+
+	void (*func)(int, int, int, const int16_t *, const uint8_t *,
+		     const int16_t *, int16_t *, uint8_t *, int);
+};
+
+/* Batch decoder release */
+void conv_batch_free(struct vbatch *batch)
+{
+	if (!batch)
+		return;
+
+	free(batch->paths);
+	free(batch->sums[1]);
+	free(batch->sums[0]);
+	free(batch->seq);
+	free(batch->bidx);
+	put_trellis(batch->trellis);
+	free(batch);
+}
+
+/* Batch decoder creation
+ *     Supported batch widths are 2, 4, 8 and 16 frames. The branch metric
+ *     index of each butterfly is taken from the signs of the trellis outputs.
+ */
+struct vbatch *conv_batch_create(const struct osmo_conv_code *code,
+				 int width)
+{
+	int i, j, ns, olen;
+	struct vbatch *batch;
+
+	if (!conv_code_valid(code))
+		return NULL;
+	if ((width != 2) && (width != 4) && (width != 8) && (width != 16))
+		return NULL;
+
+	batch = (struct vbatch *) calloc(1, sizeof(struct vbatch));
+	if (!batch)
+		return NULL;
+
+	ns = NUM_STATES(code->K);
+	olen = (code->N == 2) ? 2 : 4;
+
+	batch->n = code->N;
+	batch->k = code->K;
+	batch->num_bits = code->len;
+	batch->term = code->term;
+	batch->punc = code->puncture;
+	batch->recursive = conv_code_recursive(code);
+	batch->intrvl = INT16_MAX / (batch->n * INT8_MAX) - batch->k;
+	batch->func = get_kernels()->batch;
+
+	if (code->term == CONV_TERM_FLUSH)
+		batch->len = code->len + code->K - 1;
+	else
+		batch->len = code->len;
+
+	batch->width = width;
+	batch->lanes = (width + 7) & ~7;
+
+	batch->trellis = get_trellis(code);
+	if (!batch->trellis)
+		goto fail;
+
+	batch->bidx = (uint8_t *) malloc(ns / 2);
+	batch->seq = vdec_malloc(batch->len * batch->n * batch->lanes);
+	batch->sums[0] = vdec_malloc(ns * batch->lanes);
+	batch->sums[1] = vdec_malloc(ns * batch->lanes);
+	batch->paths = (uint8_t *) malloc(batch->len * ns * batch->lanes / 8);
+
+	if (!batch->bidx || !batch->seq || !batch->sums[0] ||
+	    !batch->sums[1] || !batch->paths)
+		goto fail;
+
+	/* Idle lanes stay zero */
+	memset(batch->seq, 0, sizeof(int16_t) *
+	       batch->len * batch->n * batch->lanes);
+
+	for (i = 0; i < ns / 2; i++) {
+		batch->bidx[i] = 0;
+		for (j = 0; j < batch->n; j++) {
+			if (batch->trellis->outputs[olen * i + j] < 0)
+				batch->bidx[i] |= 1 << j;
+		}
+	}
+
+	return batch;
+fail:
+	conv_batch_free(batch);
+	return NULL;
+}
+
+/* Depuncture and transpose input frames into SIMD lanes
+ *     All frames share the puncturing pattern, so walk the input positions
+ *     once and fill every lane of each position in turn.
+ */
+static void batch_load(struct vbatch *batch, const sbit_t * const *input)
+{
+	int i, l, m = 0, p = 0;
+	int len = batch->len * batch->n;
+	const int *punc = batch->punc;
+	int16_t *seq = batch->seq;
+
+	for (i = 0; i < len; i++, seq += batch->lanes) {
+		if (punc && (i == punc[p])) {
+			for (l = 0; l < batch->width; l++)
+				seq[l] = 0;
+			p++;
+			continue;
+		}
+
+		for (l = 0; l < batch->width; l++)
+			seq[l] = input[l][m];
+		m++;
+	}
+}
+
+/* Per-frame traceback
+ *     Identical to the single frame traceback with path decisions and final
+ *     path metrics taken from each frame lane. Decisions of a frame are one
+ *     bit of every 'groups' bytes along each trellis step. All frames are
+ *     traced back together so that the independent state lookups of each
+ *     step overlap.
+ */
+static int batch_traceback(struct vbatch *batch, const int16_t *sums,
+			   ubit_t **output)
+{
+	int i, l, sum, max;
+	int ns = batch->trellis->num_states;
+	int groups = batch->lanes / 8;
+	unsigned path, state[batch->width];
+	unsigned rec = batch->recursive ? 1 : 0;
+	const uint8_t *row, *vals = batch->trellis->vals;
+
+	for (l = 0; l < batch->width; l++) {
+		state[l] = 0;
+		if (batch->term == CONV_TERM_FLUSH)
+			continue;
+
+		for (i = 0, max = -1; i < ns; i++) {
+			sum = sums[i * batch->lanes + l];
+			if (sum > max) {
+				max = sum;
+				state[l] = i;
+			}
+		}
+
+		if (max < 0)
+			return -EPROTO;
+	}
+
+	for (i = batch->len - 1; i >= batch->num_bits; i--) {
+		row = &batch->paths[i * ns * groups];
+
+		for (l = 0; l < batch->width; l++) {
+			path = row[state[l] * groups + l / 8] >> (l % 8);
+			path = !(path & 0x01);
+			state[l] = vstate_lshift(state[l], batch->k, path);
+		}
+	}
+
+	for (; i >= 0; i--) {
+		row = &batch->paths[i * ns * groups];
+
+		for (l = 0; l < batch->width; l++) {
+			path = row[state[l] * groups + l / 8] >> (l % 8);
+			path = !(path & 0x01);
+			output[l][i] = (path & rec) ^ vals[state[l]];
+			state[l] = vstate_lshift(state[l], batch->k, path);
+		}
+	}
+
+	return 0;
+}
+
+/* Forward recursion of all frames with interval normalization */
+static int batch_forward(struct vbatch *batch, int cur)
+{
+	int i;
+	int ns = batch->trellis->num_states;
+	int step = batch->n * batch->lanes;
+
+	for (i = 0; i < batch->len; i++) {
+		batch->func(ns, batch->n, batch->lanes,
+			    &batch->seq[i * step], batch->bidx,
+			    batch->sums[cur], batch->sums[!cur],
+			    &batch->paths[i * ns * batch->lanes / 8],
+			    !(i % batch->intrvl));
+		cur = !cur;
+	}
+
+	return cur;
+}
+
+/* Decode a batch of frames
+ *     Decode 'width' frames given by the input and output arrays. Returns
+ *     zero on success or a negative error if any frame failed to decode.
+ */
+int conv_batch_run(struct vbatch *batch, const sbit_t * const *input,
+		   ubit_t **output)
+{
+	int i, cur = 0;
+	int ns;
+
+	if (!batch)
+		return -EINVAL;
+
+	ns = batch->trellis->num_states;
+
+	memset(batch->sums[0], 0, sizeof(int16_t) * ns * batch->lanes);
+	if (batch->term != CONV_TERM_TAIL_BITING) {
+		for (i = 0; i < batch->lanes; i++)
+			batch->sums[0][i] = INT8_MAX * batch->n * batch->k;
+	}
+
+	batch_load(batch, input);
+
+	cur = batch_forward(batch, cur);
+	if (batch->term == CONV_TERM_TAIL_BITING)
+		cur = batch_forward(batch, cur);
+
+	return batch_traceback(batch, batch->sums[cur], output);
 }
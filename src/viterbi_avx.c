@@ -0,0 +1,768 @@
+/*
+ * Intel AVX2 Viterbi decoder
+ * Copyright (C) 2013, 2014 Thomas Tsou <tom@tsou.cc>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+/* 16-Viterbi butterfly:
+ *     Compute 16-wide butterfly generating 32 path decisions and 32
+ *     accumulated sums. Inputs all packed 16-bit integers in three 256-bit
+ *     YMM registers. Two intermediate registers are used and results are set
+ *     in the upper 4 registers.
+ *
+ *     Input:
+ *     M0 - Path metrics 0 (packed 16-bit integers)
+ *     M1 - Path metrics 1 (packed 16-bit integers)
+ *     M2 - Branch metrics (packed 16-bit integers)
+ *
+ *     Output:
+ *     M2 - Selected and accumulated path metrics 0
+ *     M4 - Selected and accumulated path metrics 1
+ *     M3 - Path selections 0
+ *     M1 - Path selections 1
+ */
+#define AVX_BUTTERFLY(M0,M1,M2,M3,M4) \
+{ \
+	M3 = _mm256_adds_epi16(M0, M2); \
+	M4 = _mm256_subs_epi16(M1, M2); \
+	M0 = _mm256_subs_epi16(M0, M2); \
+	M1 = _mm256_adds_epi16(M1, M2); \
+	M2 = _mm256_max_epi16(M3, M4); \
+	M3 = _mm256_cmpgt_epi16(M3, M4); \
+	M4 = _mm256_max_epi16(M0, M1); \
+	M1 = _mm256_cmpgt_epi16(M0, M1); \
+}
+
+/* 16-Viterbi butterfly (modulo):
+ *     Same as the saturating butterfly with wrap-around path metrics compared
+ *     by the sign of their difference. See SSE_BUTTERFLY_MOD.
+ */
+#define AVX_BUTTERFLY_MOD(M0,M1,M2,M3,M4) \
+{ \
+	__m256i _z = _mm256_setzero_si256(); \
+	M3 = _mm256_add_epi16(M0, M2); \
+	M4 = _mm256_sub_epi16(M1, M2); \
+	M0 = _mm256_sub_epi16(M0, M2); \
+	M1 = _mm256_add_epi16(M1, M2); \
+	M2 = _mm256_sub_epi16(M3, M4); \
+	M3 = _mm256_cmpgt_epi16(M2, _z); \
+	M2 = _mm256_add_epi16(M4, _mm256_max_epi16(M2, _z)); \
+	M4 = _mm256_sub_epi16(M0, M1); \
+	M0 = _mm256_add_epi16(M1, _mm256_max_epi16(M4, _z)); \
+	M1 = _mm256_cmpgt_epi16(M4, _z); \
+	M4 = M0; \
+}
+
+/* Two lane deinterleaving:
+ *     Take 32 interleaved 16-bit integers and deinterleave to 2 packed 256-bit
+ *     registers. The in-lane shuffle splits each 128-bit lane into even and
+ *     odd halves, which are then gathered across lanes. Four registers are
+ *     used with the lower 2 as input and upper 2 as output.
+ *
+ *     In   - 10101010 10101010 10101010 10101010
+ *     Out  - 00000000 00000000 11111111 11111111
+ *
+ *     Input:
+ *     M0:1 - Packed 16-bit integers
+ *
+ *     Output:
+ *     M2:3 - Deinterleaved packed 16-bit integers
+ */
+#define _I8_SHUFFLE_MASK 15, 14, 11, 10, 7, 6, 3, 2, 13, 12, 9, 8, 5, 4, 1, 0
+
+#define AVX_DEINTERLEAVE(M0,M1,M2,M3) \
+{ \
+	M2 = _mm256_set_epi8(_I8_SHUFFLE_MASK, _I8_SHUFFLE_MASK); \
+	M0 = _mm256_shuffle_epi8(M0, M2); \
+	M1 = _mm256_shuffle_epi8(M1, M2); \
+	M0 = _mm256_permute4x64_epi64(M0, _MM_SHUFFLE(3, 1, 2, 0)); \
+	M1 = _mm256_permute4x64_epi64(M1, _MM_SHUFFLE(3, 1, 2, 0)); \
+	M2 = _mm256_permute2x128_si256(M0, M1, 0x20); \
+	M3 = _mm256_permute2x128_si256(M0, M1, 0x31); \
+}
+
+/* Unique branch metrics N = 2:
+ *     Compute the 4 distinct branch metrics in both 128-bit lanes, one for
+ *     each combination of trellis output signs. Bit j of the metric index is
+ *     set if output j is negative. See SSE_UNIQUE_METRIC_N2.
+ *
+ *     Input:
+ *     M0   - Expanded and packed 16-bit input value
+ *
+ *     Output:
+ *     M1   - Branch metrics 0-3, repeated
+ */
+#define AVX_UNIQUE_METRIC_N2(M0,M1) \
+{ \
+	M1 = _mm256_sign_epi16(M0, _mm256_setr_epi16(1, 1, -1, 1, 1, -1, -1, -1, \
+						     1, 1, -1, 1, 1, -1, -1, -1)); \
+	M1 = _mm256_hadds_epi16(M1, M1); \
+}
+
+/* Unique branch metrics N = 4:
+ *     Compute metrics 0-7 in both 128-bit lanes and derive metrics 8-15 by
+ *     reversal and negation. See SSE_UNIQUE_METRIC_N4.
+ *
+ *     Input:
+ *     M4   - Expanded and packed 16-bit input value
+ *
+ *     Output:
+ *     M5   - Branch metrics 0-7, in both lanes
+ *     M6   - Branch metrics 8-15, in both lanes
+ */
+#define _I8_REVERSE_MASK 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+
+#define AVX_UNIQUE_METRIC_N4(M0,M1,M2,M3,M4,M5,M6) \
+{ \
+	M0 = _mm256_setr_epi16(1, 1, 1, 1, -1, 1, 1, 1, \
+			       1, 1, 1, 1, -1, 1, 1, 1); \
+	M1 = _mm256_setr_epi16(1, -1, 1, 1, -1, -1, 1, 1, \
+			       1, -1, 1, 1, -1, -1, 1, 1); \
+	M2 = _mm256_setr_epi16(1, 1, -1, 1, -1, 1, -1, 1, \
+			       1, 1, -1, 1, -1, 1, -1, 1); \
+	M3 = _mm256_setr_epi16(1, -1, -1, 1, -1, -1, -1, 1, \
+			       1, -1, -1, 1, -1, -1, -1, 1); \
+	M0 = _mm256_sign_epi16(M4, M0); \
+	M1 = _mm256_sign_epi16(M4, M1); \
+	M2 = _mm256_sign_epi16(M4, M2); \
+	M3 = _mm256_sign_epi16(M4, M3); \
+	M0 = _mm256_hadds_epi16(M0, M1); \
+	M1 = _mm256_hadds_epi16(M2, M3); \
+	M5 = _mm256_hadds_epi16(M0, M1); \
+	M6 = _mm256_shuffle_epi8(M5, _mm256_set_epi8(_I8_REVERSE_MASK, \
+						     _I8_REVERSE_MASK)); \
+	M6 = _mm256_sign_epi16(M6, _mm256_set1_epi16(-1)); \
+}
+
+/* Distribute branch metrics N = 4:
+ *     Shuffle unique branch metrics into butterfly order with one 16-bit
+ *     index word per butterfly. The shuffle is in-lane, so the unique metrics
+ *     are held in both lanes. See SSE_SHUFFLE_METRIC_N4.
+ *
+ *     Input:
+ *     M0   - Branch metrics 0-7
+ *     M1   - Branch metrics 8-15
+ *     M2   - Branch metric index words of 16 butterflies
+ *
+ *     Output:
+ *     M3   - 16 distributed 16-bit branch metrics
+ */
+#define AVX_SHUFFLE_METRIC_N4(M0,M1,M2,M3) \
+{ \
+	M3 = _mm256_shuffle_epi8(M0, M2); \
+	M2 = _mm256_xor_si256(M2, _mm256_set1_epi8(-128)); \
+	M2 = _mm256_shuffle_epi8(M1, M2); \
+	M3 = _mm256_or_si256(M3, M2); \
+}
+
+/* Pack path selections:
+ *     Reduce 32 path selections (packed 16-bit integers of -1 or 0) held in
+ *     two registers to two 16-bit masks with one decision bit per state. The
+ *     first register holds the lower 16 states. One intermediate integer is
+ *     used and the first source register is overwritten.
+ *
+ *     Input:
+ *     M0:1 - Path selections (packed 16-bit integers)
+ *
+ *     Output:
+ *     P0:1 - 16-bit decision masks
+ */
+#define AVX_PACK_PATHS(M0,M1,R,P0,P1) \
+{ \
+	M0 = _mm256_packs_epi16(M0, M1); \
+	M0 = _mm256_permute4x64_epi64(M0, _MM_SHUFFLE(3, 1, 2, 0)); \
+	R = _mm256_movemask_epi8(M0); \
+	P0 = (int16_t) R; \
+	P1 = (int16_t) (R >> 16); \
+}
+
+/* Normalize state metrics K = 7:
+ *     Compute 64-wide normalization by subtracting the smallest value from
+ *     all values. Inputs are 4 registers of accumulated sums, 1 temporary
+ *     register and 1 temporary 128-bit register. Normalized results are
+ *     returned in the originating locations.
+ *
+ *     Input:
+ *     M0:3 - Path metrics 0:3 (packed 16-bit integers)
+ *
+ *     Output:
+ *     M0:3 - Normalized path metrics 0:3
+ */
+#define AVX_NORMALIZE_K7(M0,M1,M2,M3,M4,X0) \
+{ \
+	M4 = _mm256_min_epi16(M0, M1); \
+	M4 = _mm256_min_epi16(M4, M2); \
+	M4 = _mm256_min_epi16(M4, M3); \
+	X0 = _mm_min_epi16(_mm256_castsi256_si128(M4), \
+			   _mm256_extracti128_si256(M4, 1)); \
+	X0 = _mm_minpos_epu16(X0); \
+	M4 = _mm256_broadcastw_epi16(X0); \
+	M0 = _mm256_subs_epi16(M0, M4); \
+	M1 = _mm256_subs_epi16(M1, M4); \
+	M2 = _mm256_subs_epi16(M2, M4); \
+	M3 = _mm256_subs_epi16(M3, M4); \
+}
+
+/* Combined BMU/PMU (K=7, N=2)
+ *     Compute branch metrics followed by path metrics for half rate 64-state
+ *     trellis. 32 butterfly operations are computed as two 16-wide
+ *     butterflies. All 64 path metrics are held in 4 registers. Path
+ *     decisions are packed to one bit per state. With 'mod' set, path metrics
+ *     wrap around and are never normalized. The unique branch metrics are
+ *     distributed with the branch metric index words of the trellis.
+ */
+__always_inline static void _avx_metrics_k7_n2(const int16_t *val,
+					       const int16_t *out,
+					       int16_t *sums,
+					       int16_t *paths,
+					       int norm,
+					       int mod)
+{
+	int r;
+	__m128i x0;
+	__m256i m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10;
+
+	/* (PMU) Load accumulated path matrics */
+	m0 = _mm256_load_si256((__m256i *) &sums[0]);
+	m1 = _mm256_load_si256((__m256i *) &sums[16]);
+	m2 = _mm256_load_si256((__m256i *) &sums[32]);
+	m3 = _mm256_load_si256((__m256i *) &sums[48]);
+
+	/* (PMU) Deinterleave to even-odd registers */
+	AVX_DEINTERLEAVE(m0, m1, m4, m5)
+	AVX_DEINTERLEAVE(m2, m3, m6, m7)
+
+	/* (BMU) Load input symbols and compute unique branch metrics */
+	m8 = _mm256_broadcastq_epi64(_mm_loadl_epi64((__m128i *) val));
+
+	AVX_UNIQUE_METRIC_N2(m8, m0)
+
+	/* (BMU) Distribute branch metrics to butterflies */
+	m1 = _mm256_load_si256((__m256i *) &out[0]);
+	m2 = _mm256_load_si256((__m256i *) &out[16]);
+	m9 = _mm256_shuffle_epi8(m0, m1);
+	m10 = _mm256_shuffle_epi8(m0, m2);
+
+	/* (PMU) Butterflies: 0-31 */
+	if (mod)
+		AVX_BUTTERFLY_MOD(m4, m5, m9, m0, m1)
+	else
+		AVX_BUTTERFLY(m4, m5, m9, m0, m1)
+	if (mod)
+		AVX_BUTTERFLY_MOD(m6, m7, m10, m2, m3)
+	else
+		AVX_BUTTERFLY(m6, m7, m10, m2, m3)
+
+	AVX_PACK_PATHS(m0, m2, r, paths[0], paths[1])
+	AVX_PACK_PATHS(m5, m7, r, paths[2], paths[3])
+
+	if (norm)
+		AVX_NORMALIZE_K7(m9, m10, m1, m3, m4, x0)
+
+	_mm256_store_si256((__m256i *) &sums[0], m9);
+	_mm256_store_si256((__m256i *) &sums[16], m10);
+	_mm256_store_si256((__m256i *) &sums[32], m1);
+	_mm256_store_si256((__m256i *) &sums[48], m3);
+}
+
+/* Combined BMU/PMU (K=7, N=3 and N=4)
+ *     Compute branch metrics followed by path metrics for 64-state and rates
+ *     to 1/4. 32 butterfly operations are computed as two 16-wide
+ *     butterflies. The input sequence is read four 16-bit values at a time,
+ *     and extra values should be set to zero for rates other than 1/4.
+ */
+__always_inline static void _avx_metrics_k7_n4(int n, const int16_t *val,
+					       const int16_t *out,
+					       int16_t *sums,
+					       int16_t *paths,
+					       int norm,
+					       int mod)
+{
+	int r;
+	__m128i x0;
+	__m256i m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12;
+
+	/* (PMU) Load accumulated path matrics */
+	m0 = _mm256_load_si256((__m256i *) &sums[0]);
+	m1 = _mm256_load_si256((__m256i *) &sums[16]);
+	m2 = _mm256_load_si256((__m256i *) &sums[32]);
+	m3 = _mm256_load_si256((__m256i *) &sums[48]);
+
+	/* (PMU) Deinterleave to even-odd registers */
+	AVX_DEINTERLEAVE(m0, m1, m4, m5)
+	AVX_DEINTERLEAVE(m2, m3, m6, m7)
+
+	/* (BMU) Load input symbols and compute unique branch metrics */
+	m8 = _mm256_broadcastq_epi64(_mm_loadl_epi64((__m128i *) val));
+
+	AVX_UNIQUE_METRIC_N4(m0, m1, m2, m3, m8, m9, m12)
+
+	/* (BMU) Distribute branch metrics to butterflies */
+	m0 = _mm256_load_si256((__m256i *) &out[0]);
+	m1 = _mm256_load_si256((__m256i *) &out[16]);
+
+	if (n == 4) {
+		AVX_SHUFFLE_METRIC_N4(m9, m12, m0, m10)
+		AVX_SHUFFLE_METRIC_N4(m9, m12, m1, m11)
+	} else {
+		m10 = _mm256_shuffle_epi8(m9, m0);
+		m11 = _mm256_shuffle_epi8(m9, m1);
+	}
+
+	/* (PMU) Butterflies: 0-31 */
+	if (mod)
+		AVX_BUTTERFLY_MOD(m4, m5, m10, m0, m1)
+	else
+		AVX_BUTTERFLY(m4, m5, m10, m0, m1)
+	if (mod)
+		AVX_BUTTERFLY_MOD(m6, m7, m11, m2, m3)
+	else
+		AVX_BUTTERFLY(m6, m7, m11, m2, m3)
+
+	AVX_PACK_PATHS(m0, m2, r, paths[0], paths[1])
+	AVX_PACK_PATHS(m5, m7, r, paths[2], paths[3])
+
+	if (norm)
+		AVX_NORMALIZE_K7(m10, m11, m1, m3, m12, x0)
+
+	_mm256_store_si256((__m256i *) &sums[0], m10);
+	_mm256_store_si256((__m256i *) &sums[16], m11);
+	_mm256_store_si256((__m256i *) &sums[32], m1);
+	_mm256_store_si256((__m256i *) &sums[48], m3);
+}
+
+/* Register exchange step
+ *     See the SSE units.
+ */
+struct rex_step {
+	const uint64_t *hist;
+	uint64_t *next;
+	const uint64_t *bits;
+};
+
+/* Register exchange of 4 butterflies
+ *     Butterfly 's' reads the histories of states 2s and 2s + 1 and writes
+ *     states s and s + ns / 2. Each new history is the history of the
+ *     surviving predecessor shifted up by one with the decoded bit of the
+ *     state appended. Histories are gathered into butterfly order after the
+ *     in-lane unpack.
+ *
+ *     Input:
+ *     M0 - Path selections of states s to s + 3 (64-bit masks)
+ *     M1 - Path selections of states s + ns / 2 to s + ns / 2 + 3
+ */
+__always_inline static void _avx_rex4(int ns, int s, __m256i m0, __m256i m1,
+				      const struct rex_step *rex)
+{
+	__m256i m2, m3, m4, m5;
+
+	m2 = _mm256_load_si256((__m256i *) &rex->hist[2 * s + 0]);
+	m3 = _mm256_load_si256((__m256i *) &rex->hist[2 * s + 4]);
+	m4 = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(m2, m3),
+				      _MM_SHUFFLE(3, 1, 2, 0));
+	m5 = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(m2, m3),
+				      _MM_SHUFFLE(3, 1, 2, 0));
+
+	m2 = _mm256_blendv_epi8(m5, m4, m0);
+	m3 = _mm256_blendv_epi8(
+		_mm256_load_si256((__m256i *) &rex->bits[ns + s]),
+		_mm256_load_si256((__m256i *) &rex->bits[s]), m0);
+	m2 = _mm256_or_si256(_mm256_slli_epi64(m2, 1), m3);
+	_mm256_store_si256((__m256i *) &rex->next[s], m2);
+
+	s += ns / 2;
+	m2 = _mm256_blendv_epi8(m5, m4, m1);
+	m3 = _mm256_blendv_epi8(
+		_mm256_load_si256((__m256i *) &rex->bits[ns + s]),
+		_mm256_load_si256((__m256i *) &rex->bits[s]), m1);
+	m2 = _mm256_or_si256(_mm256_slli_epi64(m2, 1), m3);
+	_mm256_store_si256((__m256i *) &rex->next[s], m2);
+}
+
+/* Register exchange of 16 butterflies
+ *     Update the histories of the butterflies starting at 's' from their
+ *     path selections (packed 16-bit integers of -1 or 0) while still held
+ *     in registers. A set selection takes the even predecessor 2s.
+ *
+ *     Input:
+ *     M0 - Path selections of states s to s + 15
+ *     M1 - Path selections of states s + ns / 2 to s + ns / 2 + 15
+ */
+__always_inline static void _avx_rex(int ns, int s, __m256i m0, __m256i m1,
+				     const struct rex_step *rex)
+{
+	int j;
+	__m128i x0, x1;
+
+	for (j = 0; j < 4; j++) {
+		if (j < 2) {
+			x0 = _mm256_castsi256_si128(m0);
+			x1 = _mm256_castsi256_si128(m1);
+		} else {
+			x0 = _mm256_extracti128_si256(m0, 1);
+			x1 = _mm256_extracti128_si256(m1, 1);
+		}
+		if (j & 1) {
+			x0 = _mm_unpackhi_epi64(x0, x0);
+			x1 = _mm_unpackhi_epi64(x1, x1);
+		}
+
+		_avx_rex4(ns, s + 4 * j, _mm256_cvtepi16_epi64(x0),
+			  _mm256_cvtepi16_epi64(x1), rex);
+	}
+}
+
+/* Combined BMU/PMU (K=6 to K=9)
+ *     Template for trellises of 32 to 256 states at rates 1/2 to 1/4,
+ *     instantiated below with constant 'ns' and 'n' so that all loops
+ *     unroll. Butterflies are computed 16 at a time as in the K=7 units.
+ *     New path metrics are kept in registers until all butterflies are done
+ *     since they are written over the accumulated sums they were computed
+ *     from. Branch metrics are distributed from the unique metrics as in
+ *     the K=7 units. With 'rex' set, survivor histories are updated from
+ *     the path selections of each group and path decisions are not stored.
+ */
+#define AVX_GROUPS(NS)		((NS) / 32)
+
+__always_inline static void _avx_metrics(int ns, int n,
+					 const int16_t *val,
+					 const int16_t *out,
+					 int16_t *sums,
+					 int16_t *paths,
+					 const struct rex_step *rex,
+					 int norm, int mod)
+{
+	int i, r;
+	__m128i x0;
+	__m256i m0, m1, m2, m3, m4, m5, m6, vals, bm0, bm1;
+	__m256i lo[AVX_GROUPS(ns)], hi[AVX_GROUPS(ns)];
+	__m256i d0[AVX_GROUPS(ns)], d1[AVX_GROUPS(ns)];
+
+	/* (BMU) Load input symbols and compute unique branch metrics */
+	vals = _mm256_broadcastq_epi64(_mm_loadl_epi64((__m128i *) val));
+
+	if (n == 2)
+		AVX_UNIQUE_METRIC_N2(vals, bm0)
+	else
+		AVX_UNIQUE_METRIC_N4(m0, m1, m2, m3, vals, bm0, bm1)
+
+	for (i = 0; i < AVX_GROUPS(ns); i++) {
+		/* (BMU) Distribute branch metrics to 16 butterflies */
+		m0 = _mm256_load_si256((__m256i *) &out[16 * i]);
+		if (n == 4)
+			AVX_SHUFFLE_METRIC_N4(bm0, bm1, m0, m2)
+		else
+			m2 = _mm256_shuffle_epi8(bm0, m0);
+
+		/* (PMU) Load and deinterleave accumulated path metrics */
+		m0 = _mm256_load_si256((__m256i *) &sums[32 * i + 0]);
+		m1 = _mm256_load_si256((__m256i *) &sums[32 * i + 16]);
+
+		AVX_DEINTERLEAVE(m0, m1, m3, m4)
+
+		/* (PMU) Butterflies */
+		if (mod)
+			AVX_BUTTERFLY_MOD(m3, m4, m2, m5, m6)
+		else
+			AVX_BUTTERFLY(m3, m4, m2, m5, m6)
+
+		lo[i] = m2;
+		hi[i] = m6;
+		d0[i] = m5;
+		d1[i] = m4;
+
+		/* (PMU) Register exchange of the group */
+		if (rex)
+			_avx_rex(ns, 16 * i, m5, m4, rex);
+	}
+
+	/* (PMU) Pack path decisions of 16 states per word */
+	if (!rex && (ns == 32)) {
+		AVX_PACK_PATHS(d0[0], d1[0], r, paths[0], paths[1])
+	} else if (!rex) {
+		for (i = 0; i < ns / 64; i++) {
+			AVX_PACK_PATHS(d0[2 * i], d0[2 * i + 1], r,
+				       paths[2 * i], paths[2 * i + 1])
+			AVX_PACK_PATHS(d1[2 * i], d1[2 * i + 1], r,
+				       paths[ns / 32 + 2 * i],
+				       paths[ns / 32 + 2 * i + 1])
+		}
+	}
+
+	/* (PMU) Normalize */
+	if (norm) {
+		m0 = _mm256_min_epi16(lo[0], hi[0]);
+		for (i = 1; i < AVX_GROUPS(ns); i++) {
+			m0 = _mm256_min_epi16(m0, lo[i]);
+			m0 = _mm256_min_epi16(m0, hi[i]);
+		}
+
+		x0 = _mm_min_epi16(_mm256_castsi256_si128(m0),
+				   _mm256_extracti128_si256(m0, 1));
+		x0 = _mm_minpos_epu16(x0);
+		m0 = _mm256_broadcastw_epi16(x0);
+
+		for (i = 0; i < AVX_GROUPS(ns); i++) {
+			lo[i] = _mm256_subs_epi16(lo[i], m0);
+			hi[i] = _mm256_subs_epi16(hi[i], m0);
+		}
+	}
+
+	/* (PMU) Store path metrics */
+	for (i = 0; i < AVX_GROUPS(ns); i++) {
+		_mm256_store_si256((__m256i *) &sums[16 * i], lo[i]);
+		_mm256_store_si256((__m256i *) &sums[ns / 2 + 16 * i], hi[i]);
+	}
+}
+
+void gen_metrics_k7_n2_ymm(const int8_t *val, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
+
+	_avx_metrics_k7_n2(_val, out, sums, paths, norm, 0);
+}
+
+void gen_metrics_k7_n3_ymm(const int8_t *val, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
+
+	_avx_metrics_k7_n4(3, _val, out, sums, paths, norm, 0);
+}
+
+void gen_metrics_k7_n4_ymm(const int8_t *val, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
+
+	_avx_metrics_k7_n4(4, _val, out, sums, paths, norm, 0);
+}
+
+/* Modulo path metric units (normalization argument is ignored) */
+void gen_metrics_mod_k7_n2_ymm(const int8_t *val, const int16_t *out,
+			       int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
+
+	_avx_metrics_k7_n2(_val, out, sums, paths, 0, 1);
+}
+
+void gen_metrics_mod_k7_n3_ymm(const int8_t *val, const int16_t *out,
+			       int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
+
+	_avx_metrics_k7_n4(3, _val, out, sums, paths, 0, 1);
+}
+
+void gen_metrics_mod_k7_n4_ymm(const int8_t *val, const int16_t *out,
+			       int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
+
+	_avx_metrics_k7_n4(4, _val, out, sums, paths, 0, 1);
+}
+
+/* Template instantiation for K=6, 8 and 9 */
+#define AVX_METRIC_UNITS(K) \
+void gen_metrics_k##K##_n2_ymm(const int8_t *val, const int16_t *out, \
+			       int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] }; \
+	_avx_metrics(1 << (K - 1), 2, _val, out, sums, paths, NULL, norm, 0); \
+} \
+void gen_metrics_k##K##_n3_ymm(const int8_t *val, const int16_t *out, \
+			       int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 }; \
+	_avx_metrics(1 << (K - 1), 3, _val, out, sums, paths, NULL, norm, 0); \
+} \
+void gen_metrics_k##K##_n4_ymm(const int8_t *val, const int16_t *out, \
+			       int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] }; \
+	_avx_metrics(1 << (K - 1), 4, _val, out, sums, paths, NULL, norm, 0); \
+} \
+void gen_metrics_mod_k##K##_n2_ymm(const int8_t *val, const int16_t *out, \
+				   int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] }; \
+	_avx_metrics(1 << (K - 1), 2, _val, out, sums, paths, NULL, 0, 1); \
+} \
+void gen_metrics_mod_k##K##_n3_ymm(const int8_t *val, const int16_t *out, \
+				   int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 }; \
+	_avx_metrics(1 << (K - 1), 3, _val, out, sums, paths, NULL, 0, 1); \
+} \
+void gen_metrics_mod_k##K##_n4_ymm(const int8_t *val, const int16_t *out, \
+				   int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] }; \
+	_avx_metrics(1 << (K - 1), 4, _val, out, sums, paths, NULL, 0, 1); \
+}
+
+AVX_METRIC_UNITS(6)
+AVX_METRIC_UNITS(8)
+AVX_METRIC_UNITS(9)
+
+/* Register exchange units for K=6 to K=9 (see the SSE units) */
+#define AVX_REX_UNIT(K,N,V0,V1,V2,V3) \
+void gen_rex_k##K##_n##N##_ymm(const int8_t *val, const int16_t *out, \
+			       int16_t *sums, const uint64_t *hist, \
+			       uint64_t *next, const uint64_t *bits, \
+			       int norm) \
+{ \
+	const int16_t _val[4] = { V0, V1, V2, V3 }; \
+	const struct rex_step rex = { hist, next, bits }; \
+	_avx_metrics(1 << (K - 1), N, _val, out, sums, NULL, &rex, norm, 0); \
+}
+
+#define AVX_REX_UNITS(K) \
+	AVX_REX_UNIT(K, 2, val[0], val[1], val[0], val[1]) \
+	AVX_REX_UNIT(K, 3, val[0], val[1], val[2], 0) \
+	AVX_REX_UNIT(K, 4, val[0], val[1], val[2], val[3])
+
+AVX_REX_UNITS(6)
+AVX_REX_UNITS(7)
+AVX_REX_UNITS(8)
+AVX_REX_UNITS(9)
+
+/* 128-bit batch unit of this kernel set for 8 lane remainders */
+void gen_batch_metrics_avx2(int ns, int n, int lanes,
+			    const int16_t *val, const uint8_t *bidx,
+			    const int16_t *sums, int16_t *new_sums,
+			    uint8_t *paths, int norm);
+
+/* Inter-frame batch metric unit (256-bit)
+ *     Same as the 128-bit batch unit with butterflies computed 16 frames at
+ *     a time. The number of lanes must be a multiple of 16.
+ */
+__always_inline static void _avx_batch_metrics(int ns, int n, int lanes,
+					       const int16_t *val,
+					       const uint8_t *bidx,
+					       const int16_t *sums,
+					       int16_t *new_sums,
+					       uint8_t *paths, int norm)
+{
+	int i, j, c, g;
+	int groups = lanes / 8;
+	unsigned mask;
+	const int16_t *s;
+	int16_t *t;
+	__m256i m0, m1, m2, m3, m4, min;
+	__m256i v[4], bm[16];
+
+	for (g = 0; g < groups; g += 2) {
+		/* (BMU) Unique branch metrics */
+		for (j = 0; j < n; j++)
+			v[j] = _mm256_load_si256((__m256i *) &val[j * lanes + 8 * g]);
+
+		for (c = 0; c < (1 << n); c++) {
+			bm[c] = _mm256_setzero_si256();
+			for (j = 0; j < n; j++) {
+				if ((c >> j) & 0x01)
+					bm[c] = _mm256_subs_epi16(bm[c], v[j]);
+				else
+					bm[c] = _mm256_adds_epi16(bm[c], v[j]);
+			}
+		}
+
+		/* (PMU) Butterflies */
+		min = _mm256_set1_epi16(INT16_MAX);
+		s = &sums[8 * g];
+		t = &new_sums[8 * g];
+
+		for (i = 0; i < ns / 2; i++) {
+			m0 = _mm256_load_si256((__m256i *) &s[(2 * i + 0) * lanes]);
+			m1 = _mm256_load_si256((__m256i *) &s[(2 * i + 1) * lanes]);
+			m2 = bm[bidx[i]];
+
+			AVX_BUTTERFLY(m0, m1, m2, m3, m4)
+
+			_mm256_store_si256((__m256i *) &t[i * lanes], m2);
+			_mm256_store_si256((__m256i *) &t[(i + ns / 2) * lanes], m4);
+
+			m3 = _mm256_packs_epi16(m3, m1);
+			m3 = _mm256_permute4x64_epi64(m3, _MM_SHUFFLE(3, 1, 2, 0));
+			mask = _mm256_movemask_epi8(m3);
+
+			paths[i * groups + g + 0] = mask;
+			paths[i * groups + g + 1] = mask >> 8;
+			paths[(i + ns / 2) * groups + g + 0] = mask >> 16;
+			paths[(i + ns / 2) * groups + g + 1] = mask >> 24;
+
+			min = _mm256_min_epi16(min, _mm256_min_epi16(m2, m4));
+		}
+
+		if (!norm)
+			continue;
+
+		/* Per-frame normalization */
+		for (i = 0; i < ns; i++) {
+			m0 = _mm256_load_si256((__m256i *) &t[i * lanes]);
+			m0 = _mm256_subs_epi16(m0, min);
+			_mm256_store_si256((__m256i *) &t[i * lanes], m0);
+		}
+	}
+}
+
+void gen_batch_metrics_ymm(int ns, int n, int lanes,
+			   const int16_t *val, const uint8_t *bidx,
+			   const int16_t *sums, int16_t *new_sums,
+			   uint8_t *paths, int norm)
+{
+	if (lanes % 16) {
+		gen_batch_metrics_avx2(ns, n, lanes, val, bidx,
+				       sums, new_sums, paths, norm);
+		return;
+	}
+
+	switch ((ns << 4) | n) {
+	case (16 << 4) | 2:
+		_avx_batch_metrics(16, 2, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (16 << 4) | 3:
+		_avx_batch_metrics(16, 3, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (16 << 4) | 4:
+		_avx_batch_metrics(16, 4, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (64 << 4) | 2:
+		_avx_batch_metrics(64, 2, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (64 << 4) | 3:
+		_avx_batch_metrics(64, 3, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (64 << 4) | 4:
+		_avx_batch_metrics(64, 4, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	default:
+		_avx_batch_metrics(ns, n, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+	}
+}
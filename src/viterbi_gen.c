@@ -17,10 +17,15 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
-#ifndef HAVE_SSE3
 #include <stdint.h>
 #include <string.h>
 
+/* Largest supported trellis (K = 9)
+ *     Scratch metrics are sized to this bound so that stack use does not
+ *     depend on the code.
+ */
+#define MAX_STATES		256
+
 /* Add-Compare-Select (ACS-Butterfly)
  *     Compute 4 accumulated path metrics and 4 path selections. Note that path
  *     selections are store as -1 and 0 rather than 0 and 1. This is to match
@@ -101,7 +106,7 @@ void _gen_path_metrics(int num_states, int16_t *sums,
 {
 	int i;
 	int16_t min;
-	int16_t new_sums[num_states];
+	int16_t new_sums[MAX_STATES];
 
 	for (i = 0; i < num_states / 2; i++) {
 		acs_butterfly(i, num_states, metrics[i],
@@ -152,6 +157,30 @@ void gen_metrics_k5_n4(const int8_t *seq, const int16_t *out,
 
 }
 
+/* Whole-frame branch-path metrics units (K=5)
+ *     Run 'len' consecutive unpunctured steps with one unpacked path row of
+ *     16 states per step. 'norm' is the normalization countdown of the first
+ *     step and the countdown after the last step is returned.
+ */
+#define GEN_FRAME_K5(N) \
+int gen_frame_k5_n##N(const int8_t *seq, const int16_t *out, \
+		      int16_t *sums, int16_t *paths, int len, \
+		      int intrvl, int norm) \
+{ \
+	int i; \
+	for (i = 0; i < len; i++) { \
+		gen_metrics_k5_n##N(&seq[N * i], out, sums, \
+				    &paths[16 * i], !norm); \
+		if (++norm == intrvl) \
+			norm = 0; \
+	} \
+	return norm; \
+}
+
+GEN_FRAME_K5(2)
+GEN_FRAME_K5(3)
+GEN_FRAME_K5(4)
+
 /* 64-state branch-path metrics units (K=7) */
 void gen_metrics_k7_n2(const int8_t *seq, const int16_t *out,
 		       int16_t *sums, int16_t *paths, int norm)
@@ -181,4 +210,359 @@ void gen_metrics_k7_n4(const int8_t *seq, const int16_t *out,
 	_gen_branch_metrics_n4(64, seq, out, metrics);
 	_gen_path_metrics(64, sums, metrics, paths, norm);
 }
-#endif /* !HAVE_SSE3 */
+
+/* Modulo path metric unit
+ *     Path metrics wrap around and are compared by the sign of their 16-bit
+ *     difference, so normalization is never required.
+ */
+static void _gen_path_metrics_mod(int num_states, int16_t *sums,
+				  int16_t *metrics, int16_t *paths)
+{
+	int i;
+	int16_t state0, state1, sum0, sum1, sum2, sum3;
+	int16_t new_sums[MAX_STATES];
+
+	for (i = 0; i < num_states / 2; i++) {
+		state0 = sums[2 * i + 0];
+		state1 = sums[2 * i + 1];
+
+		sum0 = (uint16_t) state0 + metrics[i];
+		sum1 = (uint16_t) state1 - metrics[i];
+		sum2 = (uint16_t) state0 - metrics[i];
+		sum3 = (uint16_t) state1 + metrics[i];
+
+		if ((int16_t) ((uint16_t) sum0 - sum1) > 0) {
+			new_sums[i] = sum0;
+			paths[i] = -1;
+		} else {
+			new_sums[i] = sum1;
+			paths[i] = 0;
+		}
+
+		if ((int16_t) ((uint16_t) sum2 - sum3) > 0) {
+			new_sums[i + num_states / 2] = sum2;
+			paths[i + num_states / 2] = -1;
+		} else {
+			new_sums[i + num_states / 2] = sum3;
+			paths[i + num_states / 2] = 0;
+		}
+	}
+
+	memcpy(sums, new_sums, num_states * sizeof(int16_t));
+}
+
+/* 16 and 64-state modulo branch-path metrics units (K=5 and K=7) */
+void gen_metrics_mod_k5_n2(const int8_t *seq, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	int16_t metrics[8];
+
+	_gen_branch_metrics_n2(16, seq, out, metrics);
+	_gen_path_metrics_mod(16, sums, metrics, paths);
+}
+
+void gen_metrics_mod_k5_n3(const int8_t *seq, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	int16_t metrics[8];
+
+	_gen_branch_metrics_n3(16, seq, out, metrics);
+	_gen_path_metrics_mod(16, sums, metrics, paths);
+}
+
+void gen_metrics_mod_k5_n4(const int8_t *seq, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	int16_t metrics[8];
+
+	_gen_branch_metrics_n4(16, seq, out, metrics);
+	_gen_path_metrics_mod(16, sums, metrics, paths);
+}
+
+void gen_metrics_mod_k7_n2(const int8_t *seq, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	int16_t metrics[32];
+
+	_gen_branch_metrics_n2(64, seq, out, metrics);
+	_gen_path_metrics_mod(64, sums, metrics, paths);
+}
+
+void gen_metrics_mod_k7_n3(const int8_t *seq, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	int16_t metrics[32];
+
+	_gen_branch_metrics_n3(64, seq, out, metrics);
+	_gen_path_metrics_mod(64, sums, metrics, paths);
+}
+
+void gen_metrics_mod_k7_n4(const int8_t *seq, const int16_t *out,
+			   int16_t *sums, int16_t *paths, int norm)
+{
+	int16_t metrics[32];
+
+	_gen_branch_metrics_n4(64, seq, out, metrics);
+	_gen_path_metrics_mod(64, sums, metrics, paths);
+}
+
+/* Branch-path metrics units for the remaining constraint lengths */
+#define GEN_METRIC_UNITS(K) \
+void gen_metrics_k##K##_n2(const int8_t *seq, const int16_t *out, \
+			   int16_t *sums, int16_t *paths, int norm) \
+{ \
+	int16_t metrics[1 << (K - 2)]; \
+	_gen_branch_metrics_n2(1 << (K - 1), seq, out, metrics); \
+	_gen_path_metrics(1 << (K - 1), sums, metrics, paths, norm); \
+} \
+void gen_metrics_k##K##_n3(const int8_t *seq, const int16_t *out, \
+			   int16_t *sums, int16_t *paths, int norm) \
+{ \
+	int16_t metrics[1 << (K - 2)]; \
+	_gen_branch_metrics_n3(1 << (K - 1), seq, out, metrics); \
+	_gen_path_metrics(1 << (K - 1), sums, metrics, paths, norm); \
+} \
+void gen_metrics_k##K##_n4(const int8_t *seq, const int16_t *out, \
+			   int16_t *sums, int16_t *paths, int norm) \
+{ \
+	int16_t metrics[1 << (K - 2)]; \
+	_gen_branch_metrics_n4(1 << (K - 1), seq, out, metrics); \
+	_gen_path_metrics(1 << (K - 1), sums, metrics, paths, norm); \
+} \
+void gen_metrics_mod_k##K##_n2(const int8_t *seq, const int16_t *out, \
+			       int16_t *sums, int16_t *paths, int norm) \
+{ \
+	int16_t metrics[1 << (K - 2)]; \
+	_gen_branch_metrics_n2(1 << (K - 1), seq, out, metrics); \
+	_gen_path_metrics_mod(1 << (K - 1), sums, metrics, paths); \
+} \
+void gen_metrics_mod_k##K##_n3(const int8_t *seq, const int16_t *out, \
+			       int16_t *sums, int16_t *paths, int norm) \
+{ \
+	int16_t metrics[1 << (K - 2)]; \
+	_gen_branch_metrics_n3(1 << (K - 1), seq, out, metrics); \
+	_gen_path_metrics_mod(1 << (K - 1), sums, metrics, paths); \
+} \
+void gen_metrics_mod_k##K##_n4(const int8_t *seq, const int16_t *out, \
+			       int16_t *sums, int16_t *paths, int norm) \
+{ \
+	int16_t metrics[1 << (K - 2)]; \
+	_gen_branch_metrics_n4(1 << (K - 1), seq, out, metrics); \
+	_gen_path_metrics_mod(1 << (K - 1), sums, metrics, paths); \
+}
+
+GEN_METRIC_UNITS(3)
+GEN_METRIC_UNITS(4)
+GEN_METRIC_UNITS(6)
+GEN_METRIC_UNITS(8)
+GEN_METRIC_UNITS(9)
+
+/* 8-bit path metrics
+ *     Generic version of the SIMD 8-bit units with the same saturating
+ *     arithmetic and adaptive renormalization. See viterbi_sse.c.
+ */
+#define METRIC8_THRESH		(INT8_MAX - 48)
+
+static int8_t sat8(int v)
+{
+	if (v > INT8_MAX)
+		return INT8_MAX;
+	if (v < INT8_MIN)
+		return INT8_MIN;
+
+	return v;
+}
+
+/* Path metric unit (8-bit) */
+static int _gen_path_metrics8(int num_states, int8_t *sums,
+			      int16_t *metrics, int16_t *paths)
+{
+	int i, renorm = 0, sat = 0;
+	int sum0, sum1, sum2, sum3;
+	int8_t metric, max;
+	int8_t new_sums[MAX_STATES];
+
+	for (i = 0; i < num_states / 2; i++) {
+		metric = sat8(metrics[i]);
+
+		sum0 = sat8(sums[2 * i + 0] + metric);
+		sum1 = sat8(sums[2 * i + 1] - metric);
+		sum2 = sat8(sums[2 * i + 0] - metric);
+		sum3 = sat8(sums[2 * i + 1] + metric);
+
+		if (sum0 > sum1) {
+			new_sums[i] = sum0;
+			paths[i] = -1;
+		} else {
+			new_sums[i] = sum1;
+			paths[i] = 0;
+		}
+
+		if (sum2 > sum3) {
+			new_sums[i + num_states / 2] = sum2;
+			paths[i + num_states / 2] = -1;
+		} else {
+			new_sums[i + num_states / 2] = sum3;
+			paths[i + num_states / 2] = 0;
+		}
+	}
+
+	for (i = 0; i < num_states; i++) {
+		if (new_sums[i] > METRIC8_THRESH)
+			renorm = 1;
+	}
+
+	if (renorm) {
+		max = new_sums[0];
+		for (i = 1; i < num_states; i++) {
+			if (new_sums[i] > max)
+				max = new_sums[i];
+		}
+
+		for (i = 0; i < num_states; i++)
+			new_sums[i] = sat8(new_sums[i] -
+					   (max - METRIC8_THRESH));
+	}
+
+	for (i = 0; i < num_states; i++) {
+		if ((new_sums[i] == INT8_MIN) || (new_sums[i] == INT8_MAX))
+			sat = 1;
+	}
+
+	memcpy(sums, new_sums, num_states);
+
+	return sat;
+}
+
+/* 16-state branch-path metrics units (K=5, 8-bit) */
+int gen_metrics8_k5_n2(const int8_t *seq, const int16_t *out,
+		       int8_t *sums, int16_t *paths)
+{
+	int16_t metrics[8];
+
+	_gen_branch_metrics_n2(16, seq, out, metrics);
+	return _gen_path_metrics8(16, sums, metrics, paths);
+}
+
+int gen_metrics8_k5_n3(const int8_t *seq, const int16_t *out,
+		       int8_t *sums, int16_t *paths)
+{
+	int16_t metrics[8];
+
+	_gen_branch_metrics_n3(16, seq, out, metrics);
+	return _gen_path_metrics8(16, sums, metrics, paths);
+}
+
+int gen_metrics8_k5_n4(const int8_t *seq, const int16_t *out,
+		       int8_t *sums, int16_t *paths)
+{
+	int16_t metrics[8];
+
+	_gen_branch_metrics_n4(16, seq, out, metrics);
+	return _gen_path_metrics8(16, sums, metrics, paths);
+}
+
+/* 64-state branch-path metrics units (K=7, 8-bit) */
+int gen_metrics8_k7_n2(const int8_t *seq, const int16_t *out,
+		       int8_t *sums, int16_t *paths)
+{
+	int16_t metrics[32];
+
+	_gen_branch_metrics_n2(64, seq, out, metrics);
+	return _gen_path_metrics8(64, sums, metrics, paths);
+}
+
+int gen_metrics8_k7_n3(const int8_t *seq, const int16_t *out,
+		       int8_t *sums, int16_t *paths)
+{
+	int16_t metrics[32];
+
+	_gen_branch_metrics_n3(64, seq, out, metrics);
+	return _gen_path_metrics8(64, sums, metrics, paths);
+}
+
+int gen_metrics8_k7_n4(const int8_t *seq, const int16_t *out,
+		       int8_t *sums, int16_t *paths)
+{
+	int16_t metrics[32];
+
+	_gen_branch_metrics_n4(64, seq, out, metrics);
+	return _gen_path_metrics8(64, sums, metrics, paths);
+}
+
+/* Saturating 16-bit arithmetic matching the SSE packed instructions */
+static int16_t sat16(int v)
+{
+	if (v > INT16_MAX)
+		return INT16_MAX;
+	if (v < INT16_MIN)
+		return INT16_MIN;
+
+	return v;
+}
+
+/* Inter-frame batch metric unit
+ *     Generic version of the SIMD batch unit with the same storage layout
+ *     and saturating arithmetic, so results match across kernel sets. See
+ *     viterbi_sse.c for a description of the arguments.
+ */
+void gen_batch_metrics(int ns, int n, int lanes,
+		       const int16_t *val, const uint8_t *bidx,
+		       const int16_t *sums, int16_t *new_sums,
+		       uint8_t *paths, int norm)
+{
+	int i, j, c, l, sum0, sum1, sum2, sum3;
+	int groups = lanes / 8;
+	int16_t bm[16], min;
+
+	for (l = 0; l < lanes; l++) {
+		for (c = 0; c < (1 << n); c++) {
+			bm[c] = 0;
+			for (j = 0; j < n; j++) {
+				if ((c >> j) & 0x01)
+					bm[c] = sat16(bm[c] - val[j * lanes + l]);
+				else
+					bm[c] = sat16(bm[c] + val[j * lanes + l]);
+			}
+		}
+
+		min = INT16_MAX;
+
+		for (i = 0; i < ns / 2; i++) {
+			sum0 = sat16(sums[(2 * i + 0) * lanes + l] + bm[bidx[i]]);
+			sum1 = sat16(sums[(2 * i + 1) * lanes + l] - bm[bidx[i]]);
+			sum2 = sat16(sums[(2 * i + 0) * lanes + l] - bm[bidx[i]]);
+			sum3 = sat16(sums[(2 * i + 1) * lanes + l] + bm[bidx[i]]);
+
+			if (l % 8 == 0) {
+				paths[i * groups + l / 8] = 0;
+				paths[(i + ns / 2) * groups + l / 8] = 0;
+			}
+
+			if (sum0 > sum1) {
+				new_sums[i * lanes + l] = sum0;
+				paths[i * groups + l / 8] |= 1 << (l % 8);
+			} else {
+				new_sums[i * lanes + l] = sum1;
+			}
+
+			if (sum2 > sum3) {
+				new_sums[(i + ns / 2) * lanes + l] = sum2;
+				paths[(i + ns / 2) * groups + l / 8] |= 1 << (l % 8);
+			} else {
+				new_sums[(i + ns / 2) * lanes + l] = sum3;
+			}
+
+			if (new_sums[i * lanes + l] < min)
+				min = new_sums[i * lanes + l];
+			if (new_sums[(i + ns / 2) * lanes + l] < min)
+				min = new_sums[(i + ns / 2) * lanes + l];
+		}
+
+		if (!norm)
+			continue;
+
+		for (i = 0; i < ns; i++)
+			new_sums[i * lanes + l] = sat16(new_sums[i * lanes + l] - min);
+	}
+}
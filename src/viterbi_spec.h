@@ -0,0 +1,1084 @@
+/*
+ * Decoder specializations
+ *
+ * Generated by gen_spec.py from tests/codes.c, do not edit.
+ * Regenerate with 'make -C src specs'.
+ */
+
+/* GSM TCH-HR */
+static const int conv_spec_punc_6[] = {
+	1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 34,
+	37, 40, 43, 46, 49, 52, 55, 58, 61, 64, 67, 70,
+	73, 76, 79, 82, 85, 88, 91, 94, 97, 100, 103, 106,
+	109, 112, 115, 118, 121, 124, 127, 130, 133, 136, 139, 142,
+	145, 148, 151, 154, 157, 160, 163, 166, 169, 172, 175, 178,
+	181, 184, 187, 190, 193, 196, 199, 202, 205, 208, 211, 214,
+	217, 220, 223, 226, 229, 232, 235, 238, 241, 244, 247, 250,
+	253, 256, 259, 262, 265, 268, 271, 274, 277, 280, 283, 295,
+	298, 301, 304, 307, 310, -1,
+};
+
+static const struct vrun conv_spec_runs_6[] = {
+	{  95,    0, 2, 0x2 },
+	{   3,  190, 3, 0x0 },
+	{   6,  199, 2, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AFS12.2 */
+static const int conv_spec_punc_7[] = {
+	321, 325, 329, 333, 337, 341, 345, 349, 353, 357, 361, 363,
+	365, 369, 373, 377, 379, 381, 385, 389, 393, 395, 397, 401,
+	405, 409, 411, 413, 417, 421, 425, 427, 429, 433, 437, 441,
+	443, 445, 449, 453, 457, 459, 461, 465, 469, 473, 475, 477,
+	481, 485, 489, 491, 493, 495, 497, 499, 501, 503, 505, 507,
+	-1,
+};
+
+static const struct vrun conv_spec_runs_7[] = {
+	{ 160,    0, 2, 0x0 },
+	{   1,  320, 1, 0x2 },
+	{   1,  321, 2, 0x0 },
+	{   1,  323, 1, 0x2 },
+	{   1,  324, 2, 0x0 },
+	{   1,  326, 1, 0x2 },
+	{   1,  327, 2, 0x0 },
+	{   1,  329, 1, 0x2 },
+	{   1,  330, 2, 0x0 },
+	{   1,  332, 1, 0x2 },
+	{   1,  333, 2, 0x0 },
+	{   1,  335, 1, 0x2 },
+	{   1,  336, 2, 0x0 },
+	{   1,  338, 1, 0x2 },
+	{   1,  339, 2, 0x0 },
+	{   1,  341, 1, 0x2 },
+	{   1,  342, 2, 0x0 },
+	{   1,  344, 1, 0x2 },
+	{   1,  345, 2, 0x0 },
+	{   1,  347, 1, 0x2 },
+	{   1,  348, 2, 0x0 },
+	{   3,  350, 1, 0x2 },
+	{   1,  353, 2, 0x0 },
+	{   1,  355, 1, 0x2 },
+	{   1,  356, 2, 0x0 },
+	{   1,  358, 1, 0x2 },
+	{   1,  359, 2, 0x0 },
+	{   3,  361, 1, 0x2 },
+	{   1,  364, 2, 0x0 },
+	{   1,  366, 1, 0x2 },
+	{   1,  367, 2, 0x0 },
+	{   1,  369, 1, 0x2 },
+	{   1,  370, 2, 0x0 },
+	{   3,  372, 1, 0x2 },
+	{   1,  375, 2, 0x0 },
+	{   1,  377, 1, 0x2 },
+	{   1,  378, 2, 0x0 },
+	{   1,  380, 1, 0x2 },
+	{   1,  381, 2, 0x0 },
+	{   3,  383, 1, 0x2 },
+	{   1,  386, 2, 0x0 },
+	{   1,  388, 1, 0x2 },
+	{   1,  389, 2, 0x0 },
+	{   1,  391, 1, 0x2 },
+	{   1,  392, 2, 0x0 },
+	{   3,  394, 1, 0x2 },
+	{   1,  397, 2, 0x0 },
+	{   1,  399, 1, 0x2 },
+	{   1,  400, 2, 0x0 },
+	{   1,  402, 1, 0x2 },
+	{   1,  403, 2, 0x0 },
+	{   3,  405, 1, 0x2 },
+	{   1,  408, 2, 0x0 },
+	{   1,  410, 1, 0x2 },
+	{   1,  411, 2, 0x0 },
+	{   1,  413, 1, 0x2 },
+	{   1,  414, 2, 0x0 },
+	{   3,  416, 1, 0x2 },
+	{   1,  419, 2, 0x0 },
+	{   1,  421, 1, 0x2 },
+	{   1,  422, 2, 0x0 },
+	{   1,  424, 1, 0x2 },
+	{   1,  425, 2, 0x0 },
+	{   3,  427, 1, 0x2 },
+	{   1,  430, 2, 0x0 },
+	{   1,  432, 1, 0x2 },
+	{   1,  433, 2, 0x0 },
+	{   1,  435, 1, 0x2 },
+	{   1,  436, 2, 0x0 },
+	{  10,  438, 1, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AFS10.2 */
+static const int conv_spec_punc_8[] = {
+	1, 4, 7, 10, 16, 19, 22, 28, 31, 34, 40, 43,
+	46, 52, 55, 58, 64, 67, 70, 76, 79, 82, 88, 91,
+	94, 100, 103, 106, 112, 115, 118, 124, 127, 130, 136, 139,
+	142, 148, 151, 154, 160, 163, 166, 172, 175, 178, 184, 187,
+	190, 196, 199, 202, 208, 211, 214, 220, 223, 226, 232, 235,
+	238, 244, 247, 250, 256, 259, 262, 268, 271, 274, 280, 283,
+	286, 292, 295, 298, 304, 307, 310, 316, 319, 322, 325, 328,
+	331, 334, 337, 340, 343, 346, 349, 352, 355, 358, 361, 364,
+	367, 370, 373, 376, 379, 382, 385, 388, 391, 394, 397, 400,
+	403, 406, 409, 412, 415, 418, 421, 424, 427, 430, 433, 436,
+	439, 442, 445, 448, 451, 454, 457, 460, 463, 466, 469, 472,
+	475, 478, 481, 484, 487, 490, 493, 496, 499, 502, 505, 508,
+	511, 514, 517, 520, 523, 526, 529, 532, 535, 538, 541, 544,
+	547, 550, 553, 556, 559, 562, 565, 568, 571, 574, 577, 580,
+	583, 586, 589, 592, 595, 598, 601, 604, 607, 609, 610, 613,
+	616, 619, 621, 622, 625, 627, 628, 631, 633, 634, 636, 637,
+	639, 640, -1,
+};
+
+static const struct vrun conv_spec_runs_8[] = {
+	{   4,    0, 2, 0x2 },
+	{   1,    8, 3, 0x0 },
+	{   3,   11, 2, 0x2 },
+	{   1,   17, 3, 0x0 },
+	{   3,   20, 2, 0x2 },
+	{   1,   26, 3, 0x0 },
+	{   3,   29, 2, 0x2 },
+	{   1,   35, 3, 0x0 },
+	{   3,   38, 2, 0x2 },
+	{   1,   44, 3, 0x0 },
+	{   3,   47, 2, 0x2 },
+	{   1,   53, 3, 0x0 },
+	{   3,   56, 2, 0x2 },
+	{   1,   62, 3, 0x0 },
+	{   3,   65, 2, 0x2 },
+	{   1,   71, 3, 0x0 },
+	{   3,   74, 2, 0x2 },
+	{   1,   80, 3, 0x0 },
+	{   3,   83, 2, 0x2 },
+	{   1,   89, 3, 0x0 },
+	{   3,   92, 2, 0x2 },
+	{   1,   98, 3, 0x0 },
+	{   3,  101, 2, 0x2 },
+	{   1,  107, 3, 0x0 },
+	{   3,  110, 2, 0x2 },
+	{   1,  116, 3, 0x0 },
+	{   3,  119, 2, 0x2 },
+	{   1,  125, 3, 0x0 },
+	{   3,  128, 2, 0x2 },
+	{   1,  134, 3, 0x0 },
+	{   3,  137, 2, 0x2 },
+	{   1,  143, 3, 0x0 },
+	{   3,  146, 2, 0x2 },
+	{   1,  152, 3, 0x0 },
+	{   3,  155, 2, 0x2 },
+	{   1,  161, 3, 0x0 },
+	{   3,  164, 2, 0x2 },
+	{   1,  170, 3, 0x0 },
+	{   3,  173, 2, 0x2 },
+	{   1,  179, 3, 0x0 },
+	{   3,  182, 2, 0x2 },
+	{   1,  188, 3, 0x0 },
+	{   3,  191, 2, 0x2 },
+	{   1,  197, 3, 0x0 },
+	{   3,  200, 2, 0x2 },
+	{   1,  206, 3, 0x0 },
+	{   3,  209, 2, 0x2 },
+	{   1,  215, 3, 0x0 },
+	{   3,  218, 2, 0x2 },
+	{   1,  224, 3, 0x0 },
+	{   3,  227, 2, 0x2 },
+	{   1,  233, 3, 0x0 },
+	{  98,  236, 2, 0x2 },
+	{   1,  432, 1, 0x3 },
+	{   3,  433, 2, 0x2 },
+	{   1,  439, 1, 0x3 },
+	{   1,  440, 2, 0x2 },
+	{   1,  442, 1, 0x3 },
+	{   1,  443, 2, 0x2 },
+	{   3,  445, 1, 0x3 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AFS7.95 */
+static const int conv_spec_punc_9[] = {
+	1, 2, 4, 5, 8, 22, 70, 118, 166, 214, 262, 310,
+	317, 319, 325, 332, 334, 341, 343, 349, 356, 358, 365, 367,
+	373, 380, 382, 385, 389, 391, 397, 404, 406, 409, 413, 415,
+	421, 428, 430, 433, 437, 439, 445, 452, 454, 457, 461, 463,
+	469, 476, 478, 481, 485, 487, 490, 493, 500, 502, 503, 505,
+	506, 508, 509, 511, 512, -1,
+};
+
+static const struct vrun conv_spec_runs_9[] = {
+	{   2,    0, 1, 0x6 },
+	{   1,    2, 2, 0x4 },
+	{   4,    4, 3, 0x0 },
+	{   1,   16, 2, 0x2 },
+	{  15,   18, 3, 0x0 },
+	{   1,   63, 2, 0x2 },
+	{  15,   65, 3, 0x0 },
+	{   1,  110, 2, 0x2 },
+	{  15,  112, 3, 0x0 },
+	{   1,  157, 2, 0x2 },
+	{  15,  159, 3, 0x0 },
+	{   1,  204, 2, 0x2 },
+	{  15,  206, 3, 0x0 },
+	{   1,  251, 2, 0x2 },
+	{  15,  253, 3, 0x0 },
+	{   1,  298, 2, 0x2 },
+	{   1,  300, 3, 0x0 },
+	{   1,  303, 2, 0x4 },
+	{   1,  305, 2, 0x2 },
+	{   1,  307, 3, 0x0 },
+	{   1,  310, 2, 0x2 },
+	{   1,  312, 3, 0x0 },
+	{   1,  315, 2, 0x4 },
+	{   1,  317, 2, 0x2 },
+	{   1,  319, 3, 0x0 },
+	{   1,  322, 2, 0x4 },
+	{   1,  324, 2, 0x2 },
+	{   1,  326, 3, 0x0 },
+	{   1,  329, 2, 0x2 },
+	{   1,  331, 3, 0x0 },
+	{   1,  334, 2, 0x4 },
+	{   1,  336, 2, 0x2 },
+	{   1,  338, 3, 0x0 },
+	{   1,  341, 2, 0x4 },
+	{   1,  343, 2, 0x2 },
+	{   1,  345, 3, 0x0 },
+	{   1,  348, 2, 0x2 },
+	{   1,  350, 3, 0x0 },
+	{   1,  353, 2, 0x4 },
+	{   2,  355, 2, 0x2 },
+	{   1,  359, 2, 0x4 },
+	{   1,  361, 2, 0x2 },
+	{   1,  363, 3, 0x0 },
+	{   1,  366, 2, 0x2 },
+	{   1,  368, 3, 0x0 },
+	{   1,  371, 2, 0x4 },
+	{   2,  373, 2, 0x2 },
+	{   1,  377, 2, 0x4 },
+	{   1,  379, 2, 0x2 },
+	{   1,  381, 3, 0x0 },
+	{   1,  384, 2, 0x2 },
+	{   1,  386, 3, 0x0 },
+	{   1,  389, 2, 0x4 },
+	{   2,  391, 2, 0x2 },
+	{   1,  395, 2, 0x4 },
+	{   1,  397, 2, 0x2 },
+	{   1,  399, 3, 0x0 },
+	{   1,  402, 2, 0x2 },
+	{   1,  404, 3, 0x0 },
+	{   1,  407, 2, 0x4 },
+	{   2,  409, 2, 0x2 },
+	{   1,  413, 2, 0x4 },
+	{   1,  415, 2, 0x2 },
+	{   1,  417, 3, 0x0 },
+	{   1,  420, 2, 0x2 },
+	{   1,  422, 3, 0x0 },
+	{   1,  425, 2, 0x4 },
+	{   2,  427, 2, 0x2 },
+	{   1,  431, 2, 0x4 },
+	{   3,  433, 2, 0x2 },
+	{   1,  439, 3, 0x0 },
+	{   1,  442, 2, 0x4 },
+	{   4,  444, 1, 0x6 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AFS7.4 */
+static const int conv_spec_punc_10[] = {
+	0, 355, 361, 367, 373, 379, 385, 391, 397, 403, 409, 415,
+	421, 427, 433, 439, 445, 451, 457, 460, 463, 466, 468, 469,
+	471, 472, -1,
+};
+
+static const struct vrun conv_spec_runs_10[] = {
+	{   1,    0, 2, 0x1 },
+	{ 117,    2, 3, 0x0 },
+	{   1,  353, 2, 0x2 },
+	{   1,  355, 3, 0x0 },
+	{   1,  358, 2, 0x2 },
+	{   1,  360, 3, 0x0 },
+	{   1,  363, 2, 0x2 },
+	{   1,  365, 3, 0x0 },
+	{   1,  368, 2, 0x2 },
+	{   1,  370, 3, 0x0 },
+	{   1,  373, 2, 0x2 },
+	{   1,  375, 3, 0x0 },
+	{   1,  378, 2, 0x2 },
+	{   1,  380, 3, 0x0 },
+	{   1,  383, 2, 0x2 },
+	{   1,  385, 3, 0x0 },
+	{   1,  388, 2, 0x2 },
+	{   1,  390, 3, 0x0 },
+	{   1,  393, 2, 0x2 },
+	{   1,  395, 3, 0x0 },
+	{   1,  398, 2, 0x2 },
+	{   1,  400, 3, 0x0 },
+	{   1,  403, 2, 0x2 },
+	{   1,  405, 3, 0x0 },
+	{   1,  408, 2, 0x2 },
+	{   1,  410, 3, 0x0 },
+	{   1,  413, 2, 0x2 },
+	{   1,  415, 3, 0x0 },
+	{   1,  418, 2, 0x2 },
+	{   1,  420, 3, 0x0 },
+	{   1,  423, 2, 0x2 },
+	{   1,  425, 3, 0x0 },
+	{   1,  428, 2, 0x2 },
+	{   1,  430, 3, 0x0 },
+	{   1,  433, 2, 0x2 },
+	{   1,  435, 3, 0x0 },
+	{   4,  438, 2, 0x2 },
+	{   2,  446, 1, 0x3 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AFS6.7 */
+static const int conv_spec_punc_11[] = {
+	1, 3, 7, 11, 15, 27, 39, 55, 67, 79, 95, 107,
+	119, 135, 147, 159, 175, 187, 199, 215, 227, 239, 255, 267,
+	279, 287, 291, 295, 299, 303, 307, 311, 315, 319, 323, 327,
+	331, 335, 339, 343, 347, 351, 355, 359, 363, 367, 369, 371,
+	375, 377, 379, 383, 385, 387, 391, 393, 395, 399, 401, 403,
+	407, 409, 411, 415, 417, 419, 423, 425, 427, 431, 433, 435,
+	439, 441, 443, 447, 449, 451, 455, 457, 459, 463, 465, 467,
+	471, 473, 475, 479, 481, 483, 487, 489, 491, 495, 497, 499,
+	503, 505, 507, 511, 513, 515, 519, 521, 523, 527, 529, 531,
+	535, 537, 539, 543, 545, 547, 549, 551, 553, 555, 557, 559,
+	561, 563, 565, 567, 569, 571, 573, 575, -1,
+};
+
+static const struct vrun conv_spec_runs_11[] = {
+	{   1,    0, 2, 0xa },
+	{   3,    2, 3, 0x8 },
+	{   2,   11, 4, 0x0 },
+	{   1,   19, 3, 0x8 },
+	{   2,   22, 4, 0x0 },
+	{   1,   30, 3, 0x8 },
+	{   3,   33, 4, 0x0 },
+	{   1,   45, 3, 0x8 },
+	{   2,   48, 4, 0x0 },
+	{   1,   56, 3, 0x8 },
+	{   2,   59, 4, 0x0 },
+	{   1,   67, 3, 0x8 },
+	{   3,   70, 4, 0x0 },
+	{   1,   82, 3, 0x8 },
+	{   2,   85, 4, 0x0 },
+	{   1,   93, 3, 0x8 },
+	{   2,   96, 4, 0x0 },
+	{   1,  104, 3, 0x8 },
+	{   3,  107, 4, 0x0 },
+	{   1,  119, 3, 0x8 },
+	{   2,  122, 4, 0x0 },
+	{   1,  130, 3, 0x8 },
+	{   2,  133, 4, 0x0 },
+	{   1,  141, 3, 0x8 },
+	{   3,  144, 4, 0x0 },
+	{   1,  156, 3, 0x8 },
+	{   2,  159, 4, 0x0 },
+	{   1,  167, 3, 0x8 },
+	{   2,  170, 4, 0x0 },
+	{   1,  178, 3, 0x8 },
+	{   3,  181, 4, 0x0 },
+	{   1,  193, 3, 0x8 },
+	{   2,  196, 4, 0x0 },
+	{   1,  204, 3, 0x8 },
+	{   2,  207, 4, 0x0 },
+	{   1,  215, 3, 0x8 },
+	{   3,  218, 4, 0x0 },
+	{   1,  230, 3, 0x8 },
+	{   2,  233, 4, 0x0 },
+	{   1,  241, 3, 0x8 },
+	{   2,  244, 4, 0x0 },
+	{   1,  252, 3, 0x8 },
+	{   1,  255, 4, 0x0 },
+	{  21,  259, 3, 0x8 },
+	{   1,  322, 2, 0xa },
+	{   1,  324, 3, 0x8 },
+	{   1,  327, 2, 0xa },
+	{   1,  329, 3, 0x8 },
+	{   1,  332, 2, 0xa },
+	{   1,  334, 3, 0x8 },
+	{   1,  337, 2, 0xa },
+	{   1,  339, 3, 0x8 },
+	{   1,  342, 2, 0xa },
+	{   1,  344, 3, 0x8 },
+	{   1,  347, 2, 0xa },
+	{   1,  349, 3, 0x8 },
+	{   1,  352, 2, 0xa },
+	{   1,  354, 3, 0x8 },
+	{   1,  357, 2, 0xa },
+	{   1,  359, 3, 0x8 },
+	{   1,  362, 2, 0xa },
+	{   1,  364, 3, 0x8 },
+	{   1,  367, 2, 0xa },
+	{   1,  369, 3, 0x8 },
+	{   1,  372, 2, 0xa },
+	{   1,  374, 3, 0x8 },
+	{   1,  377, 2, 0xa },
+	{   1,  379, 3, 0x8 },
+	{   1,  382, 2, 0xa },
+	{   1,  384, 3, 0x8 },
+	{   1,  387, 2, 0xa },
+	{   1,  389, 3, 0x8 },
+	{   1,  392, 2, 0xa },
+	{   1,  394, 3, 0x8 },
+	{   1,  397, 2, 0xa },
+	{   1,  399, 3, 0x8 },
+	{   1,  402, 2, 0xa },
+	{   1,  404, 3, 0x8 },
+	{   1,  407, 2, 0xa },
+	{   1,  409, 3, 0x8 },
+	{   1,  412, 2, 0xa },
+	{   1,  414, 3, 0x8 },
+	{   1,  417, 2, 0xa },
+	{   1,  419, 3, 0x8 },
+	{   1,  422, 2, 0xa },
+	{   1,  424, 3, 0x8 },
+	{   1,  427, 2, 0xa },
+	{   1,  429, 3, 0x8 },
+	{   8,  432, 2, 0xa },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AFS5.9 */
+static const int conv_spec_punc_12[] = {
+	0, 1, 3, 5, 7, 11, 15, 31, 47, 63, 79, 95,
+	111, 127, 143, 159, 175, 191, 207, 223, 239, 255, 271, 287,
+	303, 319, 327, 331, 335, 343, 347, 351, 359, 363, 367, 375,
+	379, 383, 391, 395, 399, 407, 411, 415, 423, 427, 431, 439,
+	443, 447, 455, 459, 463, 467, 471, 475, 479, 483, 487, 491,
+	495, 499, 503, 507, 509, 511, 512, 513, 515, 516, 517, 519,
+	-1,
+};
+
+static const struct vrun conv_spec_runs_12[] = {
+	{   1,    0, 1, 0xb },
+	{   1,    1, 2, 0xa },
+	{   2,    3, 3, 0x8 },
+	{   3,    9, 4, 0x0 },
+	{   1,   21, 3, 0x8 },
+	{   3,   24, 4, 0x0 },
+	{   1,   36, 3, 0x8 },
+	{   3,   39, 4, 0x0 },
+	{   1,   51, 3, 0x8 },
+	{   3,   54, 4, 0x0 },
+	{   1,   66, 3, 0x8 },
+	{   3,   69, 4, 0x0 },
+	{   1,   81, 3, 0x8 },
+	{   3,   84, 4, 0x0 },
+	{   1,   96, 3, 0x8 },
+	{   3,   99, 4, 0x0 },
+	{   1,  111, 3, 0x8 },
+	{   3,  114, 4, 0x0 },
+	{   1,  126, 3, 0x8 },
+	{   3,  129, 4, 0x0 },
+	{   1,  141, 3, 0x8 },
+	{   3,  144, 4, 0x0 },
+	{   1,  156, 3, 0x8 },
+	{   3,  159, 4, 0x0 },
+	{   1,  171, 3, 0x8 },
+	{   3,  174, 4, 0x0 },
+	{   1,  186, 3, 0x8 },
+	{   3,  189, 4, 0x0 },
+	{   1,  201, 3, 0x8 },
+	{   3,  204, 4, 0x0 },
+	{   1,  216, 3, 0x8 },
+	{   3,  219, 4, 0x0 },
+	{   1,  231, 3, 0x8 },
+	{   3,  234, 4, 0x0 },
+	{   1,  246, 3, 0x8 },
+	{   3,  249, 4, 0x0 },
+	{   1,  261, 3, 0x8 },
+	{   3,  264, 4, 0x0 },
+	{   1,  276, 3, 0x8 },
+	{   3,  279, 4, 0x0 },
+	{   1,  291, 3, 0x8 },
+	{   1,  294, 4, 0x0 },
+	{   3,  298, 3, 0x8 },
+	{   1,  307, 4, 0x0 },
+	{   3,  311, 3, 0x8 },
+	{   1,  320, 4, 0x0 },
+	{   3,  324, 3, 0x8 },
+	{   1,  333, 4, 0x0 },
+	{   3,  337, 3, 0x8 },
+	{   1,  346, 4, 0x0 },
+	{   3,  350, 3, 0x8 },
+	{   1,  359, 4, 0x0 },
+	{   3,  363, 3, 0x8 },
+	{   1,  372, 4, 0x0 },
+	{   3,  376, 3, 0x8 },
+	{   1,  385, 4, 0x0 },
+	{   3,  389, 3, 0x8 },
+	{   1,  398, 4, 0x0 },
+	{  14,  402, 3, 0x8 },
+	{   1,  444, 2, 0xa },
+	{   2,  446, 1, 0xb },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AHS7.95 */
+static const int conv_spec_punc_13[] = {
+	1, 3, 5, 7, 11, 15, 19, 23, 27, 31, 35, 43,
+	47, 51, 55, 59, 63, 67, 71, 79, 83, 87, 91, 95,
+	99, 103, 107, 115, 119, 123, 127, 131, 135, 139, 143, 151,
+	155, 159, 163, 167, 171, 175, 177, 179, 183, 185, 187, 191,
+	193, 195, 197, 199, 203, 205, 207, 211, 213, 215, 219, 221,
+	223, 227, 229, 231, 233, 235, 239, 241, 243, 247, 249, 251,
+	255, 257, 259, 261, 263, 265, -1,
+};
+
+static const struct vrun conv_spec_runs_13[] = {
+	{   4,    0, 1, 0x2 },
+	{   1,    4, 2, 0x0 },
+	{   1,    6, 1, 0x2 },
+	{   1,    7, 2, 0x0 },
+	{   1,    9, 1, 0x2 },
+	{   1,   10, 2, 0x0 },
+	{   1,   12, 1, 0x2 },
+	{   1,   13, 2, 0x0 },
+	{   1,   15, 1, 0x2 },
+	{   1,   16, 2, 0x0 },
+	{   1,   18, 1, 0x2 },
+	{   1,   19, 2, 0x0 },
+	{   1,   21, 1, 0x2 },
+	{   1,   22, 2, 0x0 },
+	{   1,   24, 1, 0x2 },
+	{   3,   25, 2, 0x0 },
+	{   1,   31, 1, 0x2 },
+	{   1,   32, 2, 0x0 },
+	{   1,   34, 1, 0x2 },
+	{   1,   35, 2, 0x0 },
+	{   1,   37, 1, 0x2 },
+	{   1,   38, 2, 0x0 },
+	{   1,   40, 1, 0x2 },
+	{   1,   41, 2, 0x0 },
+	{   1,   43, 1, 0x2 },
+	{   1,   44, 2, 0x0 },
+	{   1,   46, 1, 0x2 },
+	{   1,   47, 2, 0x0 },
+	{   1,   49, 1, 0x2 },
+	{   1,   50, 2, 0x0 },
+	{   1,   52, 1, 0x2 },
+	{   3,   53, 2, 0x0 },
+	{   1,   59, 1, 0x2 },
+	{   1,   60, 2, 0x0 },
+	{   1,   62, 1, 0x2 },
+	{   1,   63, 2, 0x0 },
+	{   1,   65, 1, 0x2 },
+	{   1,   66, 2, 0x0 },
+	{   1,   68, 1, 0x2 },
+	{   1,   69, 2, 0x0 },
+	{   1,   71, 1, 0x2 },
+	{   1,   72, 2, 0x0 },
+	{   1,   74, 1, 0x2 },
+	{   1,   75, 2, 0x0 },
+	{   1,   77, 1, 0x2 },
+	{   1,   78, 2, 0x0 },
+	{   1,   80, 1, 0x2 },
+	{   3,   81, 2, 0x0 },
+	{   1,   87, 1, 0x2 },
+	{   1,   88, 2, 0x0 },
+	{   1,   90, 1, 0x2 },
+	{   1,   91, 2, 0x0 },
+	{   1,   93, 1, 0x2 },
+	{   1,   94, 2, 0x0 },
+	{   1,   96, 1, 0x2 },
+	{   1,   97, 2, 0x0 },
+	{   1,   99, 1, 0x2 },
+	{   1,  100, 2, 0x0 },
+	{   1,  102, 1, 0x2 },
+	{   1,  103, 2, 0x0 },
+	{   1,  105, 1, 0x2 },
+	{   1,  106, 2, 0x0 },
+	{   1,  108, 1, 0x2 },
+	{   3,  109, 2, 0x0 },
+	{   1,  115, 1, 0x2 },
+	{   1,  116, 2, 0x0 },
+	{   1,  118, 1, 0x2 },
+	{   1,  119, 2, 0x0 },
+	{   1,  121, 1, 0x2 },
+	{   1,  122, 2, 0x0 },
+	{   1,  124, 1, 0x2 },
+	{   1,  125, 2, 0x0 },
+	{   1,  127, 1, 0x2 },
+	{   1,  128, 2, 0x0 },
+	{   1,  130, 1, 0x2 },
+	{   1,  131, 2, 0x0 },
+	{   3,  133, 1, 0x2 },
+	{   1,  136, 2, 0x0 },
+	{   3,  138, 1, 0x2 },
+	{   1,  141, 2, 0x0 },
+	{   5,  143, 1, 0x2 },
+	{   1,  148, 2, 0x0 },
+	{   3,  150, 1, 0x2 },
+	{   1,  153, 2, 0x0 },
+	{   3,  155, 1, 0x2 },
+	{   1,  158, 2, 0x0 },
+	{   3,  160, 1, 0x2 },
+	{   1,  163, 2, 0x0 },
+	{   5,  165, 1, 0x2 },
+	{   1,  170, 2, 0x0 },
+	{   3,  172, 1, 0x2 },
+	{   1,  175, 2, 0x0 },
+	{   3,  177, 1, 0x2 },
+	{   1,  180, 2, 0x0 },
+	{   6,  182, 1, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AHS7.4 */
+static const int conv_spec_punc_14[] = {
+	1, 3, 7, 11, 19, 23, 27, 35, 39, 43, 51, 55,
+	59, 67, 71, 75, 83, 87, 91, 99, 103, 107, 115, 119,
+	123, 131, 135, 139, 143, 147, 151, 155, 159, 163, 167, 171,
+	175, 179, 183, 187, 191, 195, 199, 203, 207, 211, 215, 219,
+	221, 223, 227, 229, 231, 235, 237, 239, 243, 245, 247, 251,
+	253, 255, 257, 259, -1,
+};
+
+static const struct vrun conv_spec_runs_14[] = {
+	{   2,    0, 1, 0x2 },
+	{   1,    2, 2, 0x0 },
+	{   1,    4, 1, 0x2 },
+	{   1,    5, 2, 0x0 },
+	{   1,    7, 1, 0x2 },
+	{   3,    8, 2, 0x0 },
+	{   1,   14, 1, 0x2 },
+	{   1,   15, 2, 0x0 },
+	{   1,   17, 1, 0x2 },
+	{   1,   18, 2, 0x0 },
+	{   1,   20, 1, 0x2 },
+	{   3,   21, 2, 0x0 },
+	{   1,   27, 1, 0x2 },
+	{   1,   28, 2, 0x0 },
+	{   1,   30, 1, 0x2 },
+	{   1,   31, 2, 0x0 },
+	{   1,   33, 1, 0x2 },
+	{   3,   34, 2, 0x0 },
+	{   1,   40, 1, 0x2 },
+	{   1,   41, 2, 0x0 },
+	{   1,   43, 1, 0x2 },
+	{   1,   44, 2, 0x0 },
+	{   1,   46, 1, 0x2 },
+	{   3,   47, 2, 0x0 },
+	{   1,   53, 1, 0x2 },
+	{   1,   54, 2, 0x0 },
+	{   1,   56, 1, 0x2 },
+	{   1,   57, 2, 0x0 },
+	{   1,   59, 1, 0x2 },
+	{   3,   60, 2, 0x0 },
+	{   1,   66, 1, 0x2 },
+	{   1,   67, 2, 0x0 },
+	{   1,   69, 1, 0x2 },
+	{   1,   70, 2, 0x0 },
+	{   1,   72, 1, 0x2 },
+	{   3,   73, 2, 0x0 },
+	{   1,   79, 1, 0x2 },
+	{   1,   80, 2, 0x0 },
+	{   1,   82, 1, 0x2 },
+	{   1,   83, 2, 0x0 },
+	{   1,   85, 1, 0x2 },
+	{   3,   86, 2, 0x0 },
+	{   1,   92, 1, 0x2 },
+	{   1,   93, 2, 0x0 },
+	{   1,   95, 1, 0x2 },
+	{   1,   96, 2, 0x0 },
+	{   1,   98, 1, 0x2 },
+	{   3,   99, 2, 0x0 },
+	{   1,  105, 1, 0x2 },
+	{   1,  106, 2, 0x0 },
+	{   1,  108, 1, 0x2 },
+	{   1,  109, 2, 0x0 },
+	{   1,  111, 1, 0x2 },
+	{   1,  112, 2, 0x0 },
+	{   1,  114, 1, 0x2 },
+	{   1,  115, 2, 0x0 },
+	{   1,  117, 1, 0x2 },
+	{   1,  118, 2, 0x0 },
+	{   1,  120, 1, 0x2 },
+	{   1,  121, 2, 0x0 },
+	{   1,  123, 1, 0x2 },
+	{   1,  124, 2, 0x0 },
+	{   1,  126, 1, 0x2 },
+	{   1,  127, 2, 0x0 },
+	{   1,  129, 1, 0x2 },
+	{   1,  130, 2, 0x0 },
+	{   1,  132, 1, 0x2 },
+	{   1,  133, 2, 0x0 },
+	{   1,  135, 1, 0x2 },
+	{   1,  136, 2, 0x0 },
+	{   1,  138, 1, 0x2 },
+	{   1,  139, 2, 0x0 },
+	{   1,  141, 1, 0x2 },
+	{   1,  142, 2, 0x0 },
+	{   1,  144, 1, 0x2 },
+	{   1,  145, 2, 0x0 },
+	{   1,  147, 1, 0x2 },
+	{   1,  148, 2, 0x0 },
+	{   1,  150, 1, 0x2 },
+	{   1,  151, 2, 0x0 },
+	{   1,  153, 1, 0x2 },
+	{   1,  154, 2, 0x0 },
+	{   1,  156, 1, 0x2 },
+	{   1,  157, 2, 0x0 },
+	{   1,  159, 1, 0x2 },
+	{   1,  160, 2, 0x0 },
+	{   1,  162, 1, 0x2 },
+	{   1,  163, 2, 0x0 },
+	{   1,  165, 1, 0x2 },
+	{   1,  166, 2, 0x0 },
+	{   1,  168, 1, 0x2 },
+	{   1,  169, 2, 0x0 },
+	{   3,  171, 1, 0x2 },
+	{   1,  174, 2, 0x0 },
+	{   3,  176, 1, 0x2 },
+	{   1,  179, 2, 0x0 },
+	{   3,  181, 1, 0x2 },
+	{   1,  184, 2, 0x0 },
+	{   3,  186, 1, 0x2 },
+	{   1,  189, 2, 0x0 },
+	{   5,  191, 1, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AHS6.7 */
+static const int conv_spec_punc_15[] = {
+	1, 3, 9, 19, 29, 39, 49, 59, 69, 79, 89, 99,
+	109, 119, 129, 139, 149, 159, 167, 169, 177, 179, 187, 189,
+	197, 199, 203, 207, 209, 213, 217, 219, 223, 227, 229, 231,
+	233, 235, 237, 239, -1,
+};
+
+static const struct vrun conv_spec_runs_15[] = {
+	{   2,    0, 1, 0x2 },
+	{   2,    2, 2, 0x0 },
+	{   1,    6, 1, 0x2 },
+	{   4,    7, 2, 0x0 },
+	{   1,   15, 1, 0x2 },
+	{   4,   16, 2, 0x0 },
+	{   1,   24, 1, 0x2 },
+	{   4,   25, 2, 0x0 },
+	{   1,   33, 1, 0x2 },
+	{   4,   34, 2, 0x0 },
+	{   1,   42, 1, 0x2 },
+	{   4,   43, 2, 0x0 },
+	{   1,   51, 1, 0x2 },
+	{   4,   52, 2, 0x0 },
+	{   1,   60, 1, 0x2 },
+	{   4,   61, 2, 0x0 },
+	{   1,   69, 1, 0x2 },
+	{   4,   70, 2, 0x0 },
+	{   1,   78, 1, 0x2 },
+	{   4,   79, 2, 0x0 },
+	{   1,   87, 1, 0x2 },
+	{   4,   88, 2, 0x0 },
+	{   1,   96, 1, 0x2 },
+	{   4,   97, 2, 0x0 },
+	{   1,  105, 1, 0x2 },
+	{   4,  106, 2, 0x0 },
+	{   1,  114, 1, 0x2 },
+	{   4,  115, 2, 0x0 },
+	{   1,  123, 1, 0x2 },
+	{   4,  124, 2, 0x0 },
+	{   1,  132, 1, 0x2 },
+	{   4,  133, 2, 0x0 },
+	{   1,  141, 1, 0x2 },
+	{   3,  142, 2, 0x0 },
+	{   2,  148, 1, 0x2 },
+	{   3,  150, 2, 0x0 },
+	{   2,  156, 1, 0x2 },
+	{   3,  158, 2, 0x0 },
+	{   2,  164, 1, 0x2 },
+	{   3,  166, 2, 0x0 },
+	{   2,  172, 1, 0x2 },
+	{   1,  174, 2, 0x0 },
+	{   1,  176, 1, 0x2 },
+	{   1,  177, 2, 0x0 },
+	{   2,  179, 1, 0x2 },
+	{   1,  181, 2, 0x0 },
+	{   1,  183, 1, 0x2 },
+	{   1,  184, 2, 0x0 },
+	{   2,  186, 1, 0x2 },
+	{   1,  188, 2, 0x0 },
+	{   1,  190, 1, 0x2 },
+	{   1,  191, 2, 0x0 },
+	{   7,  193, 1, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AHS5.9 */
+static const int conv_spec_punc_16[] = {
+	1, 15, 71, 127, 139, 151, 163, 175, 187, 195, 203, 211,
+	215, 219, 221, 223, -1,
+};
+
+static const struct vrun conv_spec_runs_16[] = {
+	{   1,    0, 1, 0x2 },
+	{   6,    1, 2, 0x0 },
+	{   1,   13, 1, 0x2 },
+	{  27,   14, 2, 0x0 },
+	{   1,   68, 1, 0x2 },
+	{  27,   69, 2, 0x0 },
+	{   1,  123, 1, 0x2 },
+	{   5,  124, 2, 0x0 },
+	{   1,  134, 1, 0x2 },
+	{   5,  135, 2, 0x0 },
+	{   1,  145, 1, 0x2 },
+	{   5,  146, 2, 0x0 },
+	{   1,  156, 1, 0x2 },
+	{   5,  157, 2, 0x0 },
+	{   1,  167, 1, 0x2 },
+	{   5,  168, 2, 0x0 },
+	{   1,  178, 1, 0x2 },
+	{   3,  179, 2, 0x0 },
+	{   1,  185, 1, 0x2 },
+	{   3,  186, 2, 0x0 },
+	{   1,  192, 1, 0x2 },
+	{   3,  193, 2, 0x0 },
+	{   1,  199, 1, 0x2 },
+	{   1,  200, 2, 0x0 },
+	{   1,  202, 1, 0x2 },
+	{   1,  203, 2, 0x0 },
+	{   3,  205, 1, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AHS5.15 */
+static const int conv_spec_punc_17[] = {
+	0, 1, 3, 4, 6, 9, 12, 15, 18, 21, 27, 33,
+	39, 45, 51, 54, 57, 63, 69, 75, 81, 87, 90, 93,
+	99, 105, 111, 117, 123, 126, 129, 135, 141, 147, 153, 159,
+	162, 165, 168, 171, 174, 177, 180, 183, 186, 189, 192, 195,
+	198, 201, 204, 207, 210, 213, 216, 219, 222, 225, 228, 231,
+	234, 237, 240, 243, 244, 246, 249, 252, 255, 256, 258, 261,
+	264, 267, 268, 270, 273, 276, 279, 280, 282, 285, 288, 289,
+	291, 294, 295, 297, 298, 300, 301, -1,
+};
+
+static const struct vrun conv_spec_runs_17[] = {
+	{   2,    0, 1, 0x3 },
+	{   6,    2, 2, 0x1 },
+	{   1,   14, 3, 0x0 },
+	{   1,   17, 2, 0x1 },
+	{   1,   19, 3, 0x0 },
+	{   1,   22, 2, 0x1 },
+	{   1,   24, 3, 0x0 },
+	{   1,   27, 2, 0x1 },
+	{   1,   29, 3, 0x0 },
+	{   1,   32, 2, 0x1 },
+	{   1,   34, 3, 0x0 },
+	{   3,   37, 2, 0x1 },
+	{   1,   43, 3, 0x0 },
+	{   1,   46, 2, 0x1 },
+	{   1,   48, 3, 0x0 },
+	{   1,   51, 2, 0x1 },
+	{   1,   53, 3, 0x0 },
+	{   1,   56, 2, 0x1 },
+	{   1,   58, 3, 0x0 },
+	{   1,   61, 2, 0x1 },
+	{   1,   63, 3, 0x0 },
+	{   3,   66, 2, 0x1 },
+	{   1,   72, 3, 0x0 },
+	{   1,   75, 2, 0x1 },
+	{   1,   77, 3, 0x0 },
+	{   1,   80, 2, 0x1 },
+	{   1,   82, 3, 0x0 },
+	{   1,   85, 2, 0x1 },
+	{   1,   87, 3, 0x0 },
+	{   1,   90, 2, 0x1 },
+	{   1,   92, 3, 0x0 },
+	{   3,   95, 2, 0x1 },
+	{   1,  101, 3, 0x0 },
+	{   1,  104, 2, 0x1 },
+	{   1,  106, 3, 0x0 },
+	{   1,  109, 2, 0x1 },
+	{   1,  111, 3, 0x0 },
+	{   1,  114, 2, 0x1 },
+	{   1,  116, 3, 0x0 },
+	{   1,  119, 2, 0x1 },
+	{   1,  121, 3, 0x0 },
+	{  28,  124, 2, 0x1 },
+	{   1,  180, 1, 0x3 },
+	{   3,  181, 2, 0x1 },
+	{   1,  187, 1, 0x3 },
+	{   3,  188, 2, 0x1 },
+	{   1,  194, 1, 0x3 },
+	{   3,  195, 2, 0x1 },
+	{   1,  201, 1, 0x3 },
+	{   2,  202, 2, 0x1 },
+	{   1,  206, 1, 0x3 },
+	{   1,  207, 2, 0x1 },
+	{   3,  209, 1, 0x3 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GSM TCH-AHS4.75 */
+static const int conv_spec_punc_18[] = {
+	1, 2, 4, 5, 7, 8, 10, 13, 16, 22, 28, 34,
+	40, 46, 52, 58, 64, 70, 76, 82, 88, 94, 100, 106,
+	112, 118, 124, 130, 136, 142, 148, 151, 154, 160, 163, 166,
+	172, 175, 178, 184, 187, 190, 196, 199, 202, 208, 211, 214,
+	220, 223, 226, 232, 235, 238, 241, 244, 247, 250, 253, 256,
+	259, 262, 265, 268, 271, 274, 275, 277, 278, 280, 281, 283,
+	284, -1,
+};
+
+static const struct vrun conv_spec_runs_18[] = {
+	{   3,    0, 1, 0x6 },
+	{   3,    3, 2, 0x2 },
+	{   1,    9, 3, 0x0 },
+	{   1,   12, 2, 0x2 },
+	{   1,   14, 3, 0x0 },
+	{   1,   17, 2, 0x2 },
+	{   1,   19, 3, 0x0 },
+	{   1,   22, 2, 0x2 },
+	{   1,   24, 3, 0x0 },
+	{   1,   27, 2, 0x2 },
+	{   1,   29, 3, 0x0 },
+	{   1,   32, 2, 0x2 },
+	{   1,   34, 3, 0x0 },
+	{   1,   37, 2, 0x2 },
+	{   1,   39, 3, 0x0 },
+	{   1,   42, 2, 0x2 },
+	{   1,   44, 3, 0x0 },
+	{   1,   47, 2, 0x2 },
+	{   1,   49, 3, 0x0 },
+	{   1,   52, 2, 0x2 },
+	{   1,   54, 3, 0x0 },
+	{   1,   57, 2, 0x2 },
+	{   1,   59, 3, 0x0 },
+	{   1,   62, 2, 0x2 },
+	{   1,   64, 3, 0x0 },
+	{   1,   67, 2, 0x2 },
+	{   1,   69, 3, 0x0 },
+	{   1,   72, 2, 0x2 },
+	{   1,   74, 3, 0x0 },
+	{   1,   77, 2, 0x2 },
+	{   1,   79, 3, 0x0 },
+	{   1,   82, 2, 0x2 },
+	{   1,   84, 3, 0x0 },
+	{   1,   87, 2, 0x2 },
+	{   1,   89, 3, 0x0 },
+	{   1,   92, 2, 0x2 },
+	{   1,   94, 3, 0x0 },
+	{   1,   97, 2, 0x2 },
+	{   1,   99, 3, 0x0 },
+	{   1,  102, 2, 0x2 },
+	{   1,  104, 3, 0x0 },
+	{   1,  107, 2, 0x2 },
+	{   1,  109, 3, 0x0 },
+	{   1,  112, 2, 0x2 },
+	{   1,  114, 3, 0x0 },
+	{   3,  117, 2, 0x2 },
+	{   1,  123, 3, 0x0 },
+	{   3,  126, 2, 0x2 },
+	{   1,  132, 3, 0x0 },
+	{   3,  135, 2, 0x2 },
+	{   1,  141, 3, 0x0 },
+	{   3,  144, 2, 0x2 },
+	{   1,  150, 3, 0x0 },
+	{   3,  153, 2, 0x2 },
+	{   1,  159, 3, 0x0 },
+	{   3,  162, 2, 0x2 },
+	{   1,  168, 3, 0x0 },
+	{   3,  171, 2, 0x2 },
+	{   1,  177, 3, 0x0 },
+	{  14,  180, 2, 0x2 },
+	{   4,  208, 1, 0x6 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* GMR-1 TCH3 */
+static const int conv_spec_punc_20[] = {
+	3, 7, 11, 15, 19, 23, 27, 31, 35, 39, 43, 47,
+	51, 55, 59, 63, 67, 71, 75, 79, 83, 87, 91, 95,
+	-1,
+};
+
+static const struct vrun conv_spec_runs_20[] = {
+	{   1,    0, 2, 0x0 },
+	{   1,    2, 1, 0x2 },
+	{   1,    3, 2, 0x0 },
+	{   1,    5, 1, 0x2 },
+	{   1,    6, 2, 0x0 },
+	{   1,    8, 1, 0x2 },
+	{   1,    9, 2, 0x0 },
+	{   1,   11, 1, 0x2 },
+	{   1,   12, 2, 0x0 },
+	{   1,   14, 1, 0x2 },
+	{   1,   15, 2, 0x0 },
+	{   1,   17, 1, 0x2 },
+	{   1,   18, 2, 0x0 },
+	{   1,   20, 1, 0x2 },
+	{   1,   21, 2, 0x0 },
+	{   1,   23, 1, 0x2 },
+	{   1,   24, 2, 0x0 },
+	{   1,   26, 1, 0x2 },
+	{   1,   27, 2, 0x0 },
+	{   1,   29, 1, 0x2 },
+	{   1,   30, 2, 0x0 },
+	{   1,   32, 1, 0x2 },
+	{   1,   33, 2, 0x0 },
+	{   1,   35, 1, 0x2 },
+	{   1,   36, 2, 0x0 },
+	{   1,   38, 1, 0x2 },
+	{   1,   39, 2, 0x0 },
+	{   1,   41, 1, 0x2 },
+	{   1,   42, 2, 0x0 },
+	{   1,   44, 1, 0x2 },
+	{   1,   45, 2, 0x0 },
+	{   1,   47, 1, 0x2 },
+	{   1,   48, 2, 0x0 },
+	{   1,   50, 1, 0x2 },
+	{   1,   51, 2, 0x0 },
+	{   1,   53, 1, 0x2 },
+	{   1,   54, 2, 0x0 },
+	{   1,   56, 1, 0x2 },
+	{   1,   57, 2, 0x0 },
+	{   1,   59, 1, 0x2 },
+	{   1,   60, 2, 0x0 },
+	{   1,   62, 1, 0x2 },
+	{   1,   63, 2, 0x0 },
+	{   1,   65, 1, 0x2 },
+	{   1,   66, 2, 0x0 },
+	{   1,   68, 1, 0x2 },
+	{   1,   69, 2, 0x0 },
+	{   1,   71, 1, 0x2 },
+	{   0,    0, 0, 0x0 },
+};
+
+/* Specialization list
+ *     X(ID, N, K, LEN, TERM, REC, PUNC, RUNS, ...)
+ */
+#define CONV_SPEC_LIST(X, ...) \
+	X(0, 2, 5, 224, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(1, 2, 5, 290, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(2, 2, 5, 334, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(3, 2, 5, 14, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(4, 2, 5, 35, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(5, 2, 5, 185, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(6, 3, 7, 98, CONV_TERM_FLUSH, 0, conv_spec_punc_6, conv_spec_runs_6, __VA_ARGS__) \
+	X(7, 2, 5, 250, CONV_TERM_FLUSH, 1, conv_spec_punc_7, conv_spec_runs_7, __VA_ARGS__) \
+	X(8, 3, 5, 210, CONV_TERM_FLUSH, 1, conv_spec_punc_8, conv_spec_runs_8, __VA_ARGS__) \
+	X(9, 3, 7, 165, CONV_TERM_FLUSH, 1, conv_spec_punc_9, conv_spec_runs_9, __VA_ARGS__) \
+	X(10, 3, 5, 154, CONV_TERM_FLUSH, 1, conv_spec_punc_10, conv_spec_runs_10, __VA_ARGS__) \
+	X(11, 4, 5, 140, CONV_TERM_FLUSH, 1, conv_spec_punc_11, conv_spec_runs_11, __VA_ARGS__) \
+	X(12, 4, 7, 124, CONV_TERM_FLUSH, 1, conv_spec_punc_12, conv_spec_runs_12, __VA_ARGS__) \
+	X(13, 2, 5, 129, CONV_TERM_FLUSH, 1, conv_spec_punc_13, conv_spec_runs_13, __VA_ARGS__) \
+	X(14, 2, 5, 126, CONV_TERM_FLUSH, 1, conv_spec_punc_14, conv_spec_runs_14, __VA_ARGS__) \
+	X(15, 2, 5, 116, CONV_TERM_FLUSH, 1, conv_spec_punc_15, conv_spec_runs_15, __VA_ARGS__) \
+	X(16, 2, 5, 108, CONV_TERM_FLUSH, 1, conv_spec_punc_16, conv_spec_runs_16, __VA_ARGS__) \
+	X(17, 3, 5, 97, CONV_TERM_FLUSH, 1, conv_spec_punc_17, conv_spec_runs_17, __VA_ARGS__) \
+	X(18, 3, 7, 89, CONV_TERM_FLUSH, 1, conv_spec_punc_18, conv_spec_runs_18, __VA_ARGS__) \
+	X(19, 2, 7, 48, CONV_TERM_TAIL_BITING, 0, NULL, NULL, __VA_ARGS__) \
+	X(20, 2, 7, 48, CONV_TERM_TAIL_BITING, 0, conv_spec_punc_20, conv_spec_runs_20, __VA_ARGS__) \
+	X(21, 2, 7, 100000, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(22, 2, 7, 100000, CONV_TERM_TRUNCATION, 0, NULL, NULL, __VA_ARGS__) \
+	X(23, 3, 7, 40, CONV_TERM_TAIL_BITING, 0, NULL, NULL, __VA_ARGS__) \
+	X(24, 2, 9, 262, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(25, 3, 9, 244, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(26, 2, 3, 100, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(27, 3, 4, 60, CONV_TERM_TAIL_BITING, 0, NULL, NULL, __VA_ARGS__) \
+	X(28, 4, 6, 120, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(29, 2, 8, 180, CONV_TERM_FLUSH, 0, NULL, NULL, __VA_ARGS__) \
+	X(30, 2, 5, 224, CONV_TERM_TRUNCATION, 0, NULL, NULL, __VA_ARGS__) \
+
+#define CONV_SPEC_COUNT	31
@@ -17,19 +17,33 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
-#ifdef HAVE_SSE3
 #include <stdint.h>
+#include <string.h>
 #include <emmintrin.h>
 #include <tmmintrin.h>
 
-#if defined(HAVE_SSE4_1) || defined(HAVE_SSE41)
+#ifdef __SSE4_1__
 #include <smmintrin.h>
 #endif
 
-#ifdef HAVE_AVX2
+#ifdef __AVX2__
 #include <immintrin.h>
 #endif
 
+/* Kernel naming
+ *     This file is compiled once for each supported instruction set with the
+ *     matching compiler flags, so only compiler defined feature macros are
+ *     used below. SIMD_SUFFIX names the instruction set and is appended to
+ *     the exported metric units, e.g. gen_metrics_k5_n2_ssse3.
+ */
+#ifndef SIMD_SUFFIX
+#define SIMD_SUFFIX	ssse3
+#endif
+
+#define _SIMD_FUNC(NAME,SUFFIX)		NAME##_##SUFFIX
+#define __SIMD_FUNC(NAME,SUFFIX)	_SIMD_FUNC(NAME,SUFFIX)
+#define SIMD_FUNC(NAME)			__SIMD_FUNC(NAME,SIMD_SUFFIX)
+
 /* Octo-Viterbi butterfly:
  *     Compute 8-wide butterfly generating 16 path decisions and 16 accumulated
  *     sums. Inputs all packed 16-bit integers in three 128-bit XMM registers.
@@ -59,6 +73,47 @@
 	M1 = _mm_cmpgt_epi16(M0, M1); \
 }
 
+/* Octo-Viterbi butterfly (modulo):
+ *     Same as the saturating butterfly with path metrics allowed to wrap
+ *     around. Metrics are compared by the sign of their two's-complement
+ *     difference, which is valid as long as the spread of all path metrics
+ *     stays below 2^15. No normalization is required. The selected metric is
+ *     formed by adding the positive part of the difference.
+ */
+#define SSE_BUTTERFLY_MOD(M0,M1,M2,M3,M4) \
+{ \
+	__m128i _z = _mm_setzero_si128(); \
+	M3 = _mm_add_epi16(M0, M2); \
+	M4 = _mm_sub_epi16(M1, M2); \
+	M0 = _mm_sub_epi16(M0, M2); \
+	M1 = _mm_add_epi16(M1, M2); \
+	M2 = _mm_sub_epi16(M3, M4); \
+	M3 = _mm_cmpgt_epi16(M2, _z); \
+	M2 = _mm_add_epi16(M4, _mm_max_epi16(M2, _z)); \
+	M4 = _mm_sub_epi16(M0, M1); \
+	M0 = _mm_add_epi16(M1, _mm_max_epi16(M4, _z)); \
+	M1 = _mm_cmpgt_epi16(M4, _z); \
+	M4 = M0; \
+}
+
+/* Pack path selections:
+ *     Reduce 16 path selections (packed 16-bit integers of -1 or 0) held in
+ *     two registers to a 16-bit mask with one decision bit per state. The
+ *     first register holds the lower 8 states. This is a destructive
+ *     operation and the first source register is overwritten.
+ *
+ *     Input:
+ *     M0:1 - Path selections (packed 16-bit integers)
+ *
+ *     Output:
+ *     P    - 16-bit decision mask
+ */
+#define SSE_PACK_PATHS(M0,M1,P) \
+{ \
+	M0 = _mm_packs_epi16(M0, M1); \
+	P = (int16_t) _mm_movemask_epi8(M0); \
+}
+
 /* Two lane deinterleaving K = 5:
  *     Take 16 interleaved 16-bit integers and deinterleave to 2 packed 128-bit
  *     registers. The operation summarized below. Four registers are used with
@@ -163,6 +218,71 @@
 	M5 = _mm_hadds_epi16(M0, M1); \
 }
 
+/* Unique branch metrics N = 2:
+ *     There are only 2^N distinct branch metrics, one for each combination
+ *     of trellis output signs, so compute them once per step instead of per
+ *     state. Bit j of the metric index is set if output j is negative.
+ *
+ *     Input:
+ *     M0   - Expanded and packed 16-bit input value
+ *
+ *     Output:
+ *     M1   - Branch metrics 0-3, repeated
+ */
+#define SSE_UNIQUE_METRIC_N2(M0,M1) \
+{ \
+	M1 = _mm_sign_epi16(M0, _mm_setr_epi16(1, 1, -1, 1, 1, -1, -1, -1)); \
+	M1 = _mm_hadds_epi16(M1, M1); \
+}
+
+/* Unique branch metrics N = 4:
+ *     Compute metrics 0-7, where the last output is positive, with the same
+ *     additions as SSE_BRANCH_METRIC_N4. Each of the metrics 8-15 is the
+ *     negative of its complement, so reverse and negate for the upper half.
+ *     For N = 3 the padded input value is zero and only M5 is used.
+ *
+ *     Input:
+ *     M4   - Expanded and packed 16-bit input value
+ *
+ *     Output:
+ *     M5   - Branch metrics 0-7
+ *     M6   - Branch metrics 8-15
+ */
+#define SSE_UNIQUE_METRIC_N4(M0,M1,M2,M3,M4,M5,M6) \
+{ \
+	M0 = _mm_setr_epi16(1, 1, 1, 1, -1, 1, 1, 1); \
+	M1 = _mm_setr_epi16(1, -1, 1, 1, -1, -1, 1, 1); \
+	M2 = _mm_setr_epi16(1, 1, -1, 1, -1, 1, -1, 1); \
+	M3 = _mm_setr_epi16(1, -1, -1, 1, -1, -1, -1, 1); \
+	SSE_BRANCH_METRIC_N4(M0, M1, M2, M3, M4, M5) \
+	M6 = _mm_shuffle_epi8(M5, _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, \
+						 6, 7, 4, 5, 2, 3, 0, 1)); \
+	M6 = _mm_sign_epi16(M6, _mm_set1_epi16(-1)); \
+}
+
+/* Distribute branch metrics N = 4:
+ *     Shuffle unique branch metrics into butterfly order with one 16-bit
+ *     index word per butterfly, generated with the trellis. Indices of
+ *     metrics 8-15 have the high bit of each byte set, which selects zero
+ *     from the lower half, and the upper half is selected by flipping it.
+ *     For N = 2 and 3 a single shuffle of the lower half is sufficient.
+ *
+ *     Input:
+ *     M0   - Branch metrics 0-7
+ *     M1   - Branch metrics 8-15
+ *     M2   - Branch metric index words of 8 butterflies
+ *
+ *     Output:
+ *     M3   - 8 distributed 16-bit branch metrics
+ */
+#define SSE_SHUFFLE_METRIC_N4(M0,M1,M2,M3) \
+{ \
+	M3 = _mm_shuffle_epi8(M0, M2); \
+	M2 = _mm_xor_si128(M2, _mm_set1_epi8(-128)); \
+	M2 = _mm_shuffle_epi8(M1, M2); \
+	M3 = _mm_or_si128(M3, M2); \
+}
+
 /* Broadcast 16-bit integer
  *     Repeat the low 16-bit integer to all elements of the 128-bit SSE
  *     register. Only AVX2 has a dedicated broadcast instruction; use repeat
@@ -175,7 +295,7 @@
  *     Output:
  *     M0 - Contains broadcasted values
  */
-#ifdef HAVE_AVX2
+#ifdef __AVX2__
 #define SSE_BROADCAST(M0) \
 { \
 	M0 = _mm_broadcastw_epi16(M0); \
@@ -202,7 +322,7 @@
  *     Output:
  *     M0 - Minimum value placed in low 16-bit element
  */
-#if defined(HAVE_SSE4_1) || defined(HAVE_SSE41)
+#ifdef __SSE4_1__
 #define SSE_MINPOS(M0,M1) \
 { \
 	M0 = _mm_minpos_epu16(M0); \
@@ -276,13 +396,14 @@
  *     Compute branch metrics followed by path metrics for half rate 16-state
  *     trellis. 8 butterflies are computed. Accumulated path sums are not
  *     preserved and read and written into the same memory location. Normalize
- *     sums if requires.
+ *     sums if requires. Path decisions are packed to one bit per state. With
+ *     'mod' set, path metrics wrap around and are never normalized.
  */
 __always_inline void _sse_metrics_k5_n2(const int16_t *val,
 					const int16_t *out,
 					int16_t *sums,
 					int16_t *paths,
-					int norm)
+					int norm, int mod)
 {
 	__m128i m0, m1, m2, m3, m4, m5, m6;
 
@@ -305,15 +426,18 @@ __always_inline void _sse_metrics_k5_n2(const int16_t *val,
 	SSE_DEINTERLEAVE_K5(m0, m1, m3, m4)
 
 	/* (PMU) Butterflies: 0-7 */
-	SSE_BUTTERFLY(m3, m4, m2, m5, m6)
+	if (mod)
+		SSE_BUTTERFLY_MOD(m3, m4, m2, m5, m6)
+	else
+		SSE_BUTTERFLY(m3, m4, m2, m5, m6)
 
 	if (norm)
 		SSE_NORMALIZE_K5(m2, m6, m0, m1)
 
+	SSE_PACK_PATHS(m5, m4, paths[0])
+
 	_mm_store_si128((__m128i *) &sums[0], m2);
 	_mm_store_si128((__m128i *) &sums[8], m6);
-	_mm_store_si128((__m128i *) &paths[0], m5);
-	_mm_store_si128((__m128i *) &paths[8], m4);
 }
 
 /* Combined BMU/PMU (K=5, N=3 and N=4)
@@ -327,7 +451,7 @@ __always_inline void _sse_metrics_k5_n4(const int16_t *val,
 					const int16_t *out,
 					int16_t *sums,
 					int16_t *paths,
-					int norm)
+					int norm, int mod)
 {
 	__m128i m0, m1, m2, m3, m4, m5, m6;
 
@@ -349,28 +473,32 @@ __always_inline void _sse_metrics_k5_n4(const int16_t *val,
 	SSE_DEINTERLEAVE_K5(m0, m1, m3, m4)
 
 	/* (PMU) Butterflies: 0-7 */
-	SSE_BUTTERFLY(m3, m4, m2, m5, m6)
+	if (mod)
+		SSE_BUTTERFLY_MOD(m3, m4, m2, m5, m6)
+	else
+		SSE_BUTTERFLY(m3, m4, m2, m5, m6)
 
 	if (norm)
 		SSE_NORMALIZE_K5(m2, m6, m0, m1)
 
+	SSE_PACK_PATHS(m5, m4, paths[0])
+
 	_mm_store_si128((__m128i *) &sums[0], m2);
 	_mm_store_si128((__m128i *) &sums[8], m6);
-	_mm_store_si128((__m128i *) &paths[0], m5);
-	_mm_store_si128((__m128i *) &paths[8], m4);
 }
 
 /* Combined BMU/PMU (K=7, N=2)
  *     Compute branch metrics followed by path metrics for half rate 64-state
  *     trellis. 32 butterfly operations are computed. Deinterleaving path
  *     metrics requires usage of the full SSE register file, so separate sums
- *     before computing branch metrics to avoid register spilling.
+ *     before computing branch metrics to avoid register spilling. The 4
+ *     unique branch metrics are distributed with the trellis index words.
  */
 __always_inline void _sse_metrics_k7_n2(const int16_t *val,
 					const const int16_t *out,
 					int16_t *sums,
 					int16_t *paths,
-					int norm)
+					int norm, int mod)
 {
 	__m128i m0, m1, m2, m3, m4, m5, m6, m7, m8,
 		m9, m10, m11, m12, m13, m14, m15;
@@ -389,41 +517,47 @@ __always_inline void _sse_metrics_k7_n2(const int16_t *val,
 	SSE_DEINTERLEAVE_K7(m0, m1, m2, m3 ,m4 ,m5, m6, m7,
 			    m8, m9, m10, m11, m12, m13, m14, m15)
 
-	/* (BMU) Load input symbols */
+	/* (BMU) Load input symbols and compute unique branch metrics */
 	m7 = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
 
-	/* (BMU) Load trellis outputs */
-	m0 = _mm_load_si128((__m128i *) &out[0]);
-	m1 = _mm_load_si128((__m128i *) &out[8]);
-	m2 = _mm_load_si128((__m128i *) &out[16]);
-	m3 = _mm_load_si128((__m128i *) &out[24]);
+	SSE_UNIQUE_METRIC_N2(m7, m0)
 
-	SSE_BRANCH_METRIC_N2(m0, m1, m2, m3, m7, m4, m5)
+	/* (BMU) Distribute branch metrics to butterflies */
+	m1 = _mm_load_si128((__m128i *) &out[0]);
+	m2 = _mm_load_si128((__m128i *) &out[8]);
+	m3 = _mm_load_si128((__m128i *) &out[16]);
+	m7 = _mm_load_si128((__m128i *) &out[24]);
 
-	m0 = _mm_load_si128((__m128i *) &out[32]);
-	m1 = _mm_load_si128((__m128i *) &out[40]);
-	m2 = _mm_load_si128((__m128i *) &out[48]);
-	m3 = _mm_load_si128((__m128i *) &out[56]);
-
-	SSE_BRANCH_METRIC_N2(m0, m1, m2, m3, m7, m6, m7)
+	m4 = _mm_shuffle_epi8(m0, m1);
+	m5 = _mm_shuffle_epi8(m0, m2);
+	m6 = _mm_shuffle_epi8(m0, m3);
+	m7 = _mm_shuffle_epi8(m0, m7);
 
 	/* (PMU) Butterflies: 0-15 */
-	SSE_BUTTERFLY(m8, m9, m4, m0, m1)
-	SSE_BUTTERFLY(m10, m11, m5, m2, m3)
-
-	_mm_store_si128((__m128i *) &paths[0], m0);
-	_mm_store_si128((__m128i *) &paths[8], m2);
-	_mm_store_si128((__m128i *) &paths[32], m9);
-	_mm_store_si128((__m128i *) &paths[40], m11);
+	if (mod)
+		SSE_BUTTERFLY_MOD(m8, m9, m4, m0, m1)
+	else
+		SSE_BUTTERFLY(m8, m9, m4, m0, m1)
+	if (mod)
+		SSE_BUTTERFLY_MOD(m10, m11, m5, m2, m3)
+	else
+		SSE_BUTTERFLY(m10, m11, m5, m2, m3)
+
+	SSE_PACK_PATHS(m0, m2, paths[0])
+	SSE_PACK_PATHS(m9, m11, paths[2])
 
 	/* (PMU) Butterflies: 17-31 */
-	SSE_BUTTERFLY(m12, m13, m6, m0, m2)
-	SSE_BUTTERFLY(m14, m15, m7, m9, m11)
-
-	_mm_store_si128((__m128i *) &paths[16], m0);
-	_mm_store_si128((__m128i *) &paths[24], m9);
-	_mm_store_si128((__m128i *) &paths[48], m13);
-	_mm_store_si128((__m128i *) &paths[56], m15);
+	if (mod)
+		SSE_BUTTERFLY_MOD(m12, m13, m6, m0, m2)
+	else
+		SSE_BUTTERFLY(m12, m13, m6, m0, m2)
+	if (mod)
+		SSE_BUTTERFLY_MOD(m14, m15, m7, m9, m11)
+	else
+		SSE_BUTTERFLY(m14, m15, m7, m9, m11)
+
+	SSE_PACK_PATHS(m0, m9, paths[1])
+	SSE_PACK_PATHS(m13, m15, paths[3])
 
 	if (norm)
 		SSE_NORMALIZE_K7(m4, m1, m5, m3, m6, m2,
@@ -443,9 +577,11 @@ __always_inline void _sse_metrics_k7_n2(const int16_t *val,
  *     Compute branch metrics followed by path metrics for half rate 64-state
  *     trellis. 32 butterfly operations are computed. Deinterleave path
  *     metrics before computing branch metrics as in the half rate case.
+ *     Rate 1/4 distributes from both halves of the 16 unique metrics.
  */
-__always_inline void _sse_metrics_k7_n4(const int16_t *val, const int16_t *out,
-					int16_t *sums, int16_t *paths, int norm)
+__always_inline void _sse_metrics_k7_n4(int n, const int16_t *val,
+					const int16_t *out, int16_t *sums,
+					int16_t *paths, int norm, int mod)
 {
 	__m128i m0, m1, m2, m3, m4, m5, m6, m7;
 	__m128i m8, m9, m10, m11, m12, m13, m14, m15;
@@ -464,116 +600,1114 @@ __always_inline void _sse_metrics_k7_n4(const int16_t *val, const int16_t *out,
 	SSE_DEINTERLEAVE_K7(m0, m1, m2, m3 ,m4 ,m5, m6, m7,
 			    m8, m9, m10, m11, m12, m13, m14, m15)
 
-	/* (BMU) Load and expand 8-bit input out to 16-bits */
+	/* (BMU) Load input symbols and compute unique branch metrics */
 	m7 = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
 
-	/* (BMU) Load and compute branch metrics */
+	SSE_UNIQUE_METRIC_N4(m0, m1, m2, m3, m7, m4, m5)
+
+	/* (BMU) Distribute branch metrics to butterflies */
+	m0 = m4;
+	m1 = m5;
+	m2 = _mm_load_si128((__m128i *) &out[0]);
+	m3 = _mm_load_si128((__m128i *) &out[8]);
+	m6 = _mm_load_si128((__m128i *) &out[16]);
+	m7 = _mm_load_si128((__m128i *) &out[24]);
+
+	if (n == 4) {
+		SSE_SHUFFLE_METRIC_N4(m0, m1, m2, m4)
+		SSE_SHUFFLE_METRIC_N4(m0, m1, m3, m5)
+		SSE_SHUFFLE_METRIC_N4(m0, m1, m6, m2)
+		SSE_SHUFFLE_METRIC_N4(m0, m1, m7, m3)
+		m6 = m2;
+		m7 = m3;
+	} else {
+		m4 = _mm_shuffle_epi8(m0, m2);
+		m5 = _mm_shuffle_epi8(m0, m3);
+		m6 = _mm_shuffle_epi8(m0, m6);
+		m7 = _mm_shuffle_epi8(m0, m7);
+	}
+
+	/* (PMU) Butterflies: 0-15 */
+	if (mod)
+		SSE_BUTTERFLY_MOD(m8, m9, m4, m0, m1)
+	else
+		SSE_BUTTERFLY(m8, m9, m4, m0, m1)
+	if (mod)
+		SSE_BUTTERFLY_MOD(m10, m11, m5, m2, m3)
+	else
+		SSE_BUTTERFLY(m10, m11, m5, m2, m3)
+
+	SSE_PACK_PATHS(m0, m2, paths[0])
+	SSE_PACK_PATHS(m9, m11, paths[2])
+
+	/* (PMU) Butterflies: 17-31 */
+	if (mod)
+		SSE_BUTTERFLY_MOD(m12, m13, m6, m0, m2)
+	else
+		SSE_BUTTERFLY(m12, m13, m6, m0, m2)
+	if (mod)
+		SSE_BUTTERFLY_MOD(m14, m15, m7, m9, m11)
+	else
+		SSE_BUTTERFLY(m14, m15, m7, m9, m11)
+
+	SSE_PACK_PATHS(m0, m9, paths[1])
+	SSE_PACK_PATHS(m13, m15, paths[3])
+
+	if (norm)
+		SSE_NORMALIZE_K7(m4, m1, m5, m3, m6, m2,
+				 m7, m11, m0, m8, m9, m10)
+
+	_mm_store_si128((__m128i *) &sums[0], m4);
+	_mm_store_si128((__m128i *) &sums[8], m5);
+	_mm_store_si128((__m128i *) &sums[16], m6);
+	_mm_store_si128((__m128i *) &sums[24], m7);
+	_mm_store_si128((__m128i *) &sums[32], m1);
+	_mm_store_si128((__m128i *) &sums[40], m3);
+	_mm_store_si128((__m128i *) &sums[48], m2);
+	_mm_store_si128((__m128i *) &sums[56], m11);
+}
+
+/* Register exchange step
+ *     hist - Bit histories of all states before the step
+ *     next - Bit histories of all states after the step
+ *     bits - Decoded bit of each state when the even predecessor survives,
+ *            followed by the decoded bit when the odd predecessor survives
+ */
+struct rex_step {
+	const uint64_t *hist;
+	uint64_t *next;
+	const uint64_t *bits;
+};
+
+/* Bitwise select
+ *     Select bits of M0 where the mask M2 is set and bits of M1 otherwise.
+ *     Masks are all ones or all zeros per byte, so the SSE 4.1 byte blend
+ *     gives the same result.
+ */
+#ifdef __SSE4_1__
+#define SSE_SELECT(M0,M1,M2)	_mm_blendv_epi8(M1, M0, M2)
+#else
+#define SSE_SELECT(M0,M1,M2) \
+	_mm_or_si128(_mm_and_si128(M2, M0), _mm_andnot_si128(M2, M1))
+#endif
+
+/* Register exchange of 2 butterflies
+ *     Butterfly 's' reads the histories of states 2s and 2s + 1 and writes
+ *     states s and s + ns / 2. Each new history is the history of the
+ *     surviving predecessor shifted up by one with the decoded bit of the
+ *     state appended. Path selections are expanded to 64-bit masks.
+ *
+ *     Input:
+ *     M0 - Path selections of states s and s + 1
+ *     M1 - Path selections of states s + ns / 2 and s + ns / 2 + 1
+ */
+__always_inline static void _sse_rex2(int ns, int s, __m128i m0, __m128i m1,
+				      const struct rex_step *rex)
+{
+	__m128i m2, m3, m4, m5;
+
+	m2 = _mm_load_si128((__m128i *) &rex->hist[2 * s + 0]);
+	m3 = _mm_load_si128((__m128i *) &rex->hist[2 * s + 2]);
+	m4 = _mm_unpacklo_epi64(m2, m3);
+	m5 = _mm_unpackhi_epi64(m2, m3);
+
+	m2 = SSE_SELECT(m4, m5, m0);
+	m3 = SSE_SELECT(_mm_load_si128((__m128i *) &rex->bits[s]),
+			_mm_load_si128((__m128i *) &rex->bits[ns + s]), m0);
+	m2 = _mm_or_si128(_mm_slli_epi64(m2, 1), m3);
+	_mm_store_si128((__m128i *) &rex->next[s], m2);
+
+	s += ns / 2;
+	m2 = SSE_SELECT(m4, m5, m1);
+	m3 = SSE_SELECT(_mm_load_si128((__m128i *) &rex->bits[s]),
+			_mm_load_si128((__m128i *) &rex->bits[ns + s]), m1);
+	m2 = _mm_or_si128(_mm_slli_epi64(m2, 1), m3);
+	_mm_store_si128((__m128i *) &rex->next[s], m2);
+}
+
+#ifdef __AVX2__
+/* Register exchange of 4 butterflies
+ *     Same as above with 4 histories per 256-bit register. Histories are
+ *     gathered into butterfly order after the in-lane unpack.
+ */
+__always_inline static void _sse_rex4(int ns, int s, __m256i m0, __m256i m1,
+				      const struct rex_step *rex)
+{
+	__m256i m2, m3, m4, m5;
+
+	m2 = _mm256_load_si256((__m256i *) &rex->hist[2 * s + 0]);
+	m3 = _mm256_load_si256((__m256i *) &rex->hist[2 * s + 4]);
+	m4 = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(m2, m3),
+				      _MM_SHUFFLE(3, 1, 2, 0));
+	m5 = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(m2, m3),
+				      _MM_SHUFFLE(3, 1, 2, 0));
+
+	m2 = _mm256_blendv_epi8(m5, m4, m0);
+	m3 = _mm256_blendv_epi8(
+		_mm256_load_si256((__m256i *) &rex->bits[ns + s]),
+		_mm256_load_si256((__m256i *) &rex->bits[s]), m0);
+	m2 = _mm256_or_si256(_mm256_slli_epi64(m2, 1), m3);
+	_mm256_store_si256((__m256i *) &rex->next[s], m2);
+
+	s += ns / 2;
+	m2 = _mm256_blendv_epi8(m5, m4, m1);
+	m3 = _mm256_blendv_epi8(
+		_mm256_load_si256((__m256i *) &rex->bits[ns + s]),
+		_mm256_load_si256((__m256i *) &rex->bits[s]), m1);
+	m2 = _mm256_or_si256(_mm256_slli_epi64(m2, 1), m3);
+	_mm256_store_si256((__m256i *) &rex->next[s], m2);
+}
+#endif
+
+/* Register exchange of a butterfly group
+ *     Update the histories of the 'nb' butterflies starting at 's' from
+ *     their path selections (packed 16-bit integers of -1 or 0), which are
+ *     still held in registers after the add-compare-select, so the path
+ *     decisions are neither packed nor read back. A set selection takes the
+ *     even predecessor 2s.
+ *
+ *     Input:
+ *     M0 - Path selections of states s to s + nb - 1
+ *     M1 - Path selections of states s + ns / 2 to s + ns / 2 + nb - 1
+ */
+__always_inline static void _sse_rex(int ns, int s, int nb,
+				     __m128i m0, __m128i m1,
+				     const struct rex_step *rex)
+{
+	int j = 0;
+	__m128i m2;
+
+#ifdef __AVX2__
+	for (; j + 4 <= nb; j += 4) {
+		if (j) {
+			m0 = _mm_unpackhi_epi64(m0, m0);
+			m1 = _mm_unpackhi_epi64(m1, m1);
+		}
+		_sse_rex4(ns, s + j, _mm256_cvtepi16_epi64(m0),
+			  _mm256_cvtepi16_epi64(m1), rex);
+	}
+#endif
+	for (; j < nb; j += 2) {
+		m2 = _mm_set_epi64x(0x0101010101010101ULL * (2 * j + 2),
+				    0x0101010101010101ULL * (2 * j));
+		_sse_rex2(ns, s + j, _mm_shuffle_epi8(m0, m2),
+			  _mm_shuffle_epi8(m1, m2), rex);
+	}
+}
+
+/* Combined BMU/PMU (any K)
+ *     Template for trellises of 4 to 256 states at rates 1/2 to 1/4. Units
+ *     are instantiated below with constant 'ns' and 'n', so all loops unroll
+ *     to straight-line code. Butterflies are computed 8 at a time from pairs
+ *     of deinterleaved path metric registers, and new path metrics are kept
+ *     in registers until all butterflies are done since they are written
+ *     over the accumulated sums they were computed from. Trellises of 4 and
+ *     8 states fill part of a single register. Their trellis outputs are
+ *     padded to 16 states and both halves of the 4-state metrics are kept
+ *     identical so that normalization sees only valid states. Trellises of
+ *     32 states and above compute the unique branch metrics once and read
+ *     branch metric index words in place of trellis outputs. With 'rex'
+ *     set, survivor histories are updated from the path selections of each
+ *     group and path decisions are not stored.
+ */
+#define SSE_GROUPS(NS)		((NS) < 16 ? 1 : (NS) / 16)
+
+__always_inline static void _sse_metrics(int ns, int n,
+					 const int16_t *val,
+					 const int16_t *out,
+					 int16_t *sums,
+					 int16_t *paths,
+					 const struct rex_step *rex,
+					 int norm, int mod)
+{
+	int i;
+	__m128i m0, m1, m2, m3, m4, m5, m6, vals, bm0, bm1;
+	__m128i lo[SSE_GROUPS(ns)], hi[SSE_GROUPS(ns)];
+	__m128i d0[SSE_GROUPS(ns)], d1[SSE_GROUPS(ns)];
+
+	/* (BMU) Load input sequence */
+	vals = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
+
+	/* (BMU) Compute unique branch metrics */
+	if ((ns >= 32) && (n == 2))
+		SSE_UNIQUE_METRIC_N2(vals, bm0)
+	else if (ns >= 32)
+		SSE_UNIQUE_METRIC_N4(m0, m1, m2, m3, vals, bm0, bm1)
+
+	for (i = 0; i < SSE_GROUPS(ns); i++) {
+		/* (BMU) Compute branch metrics of 8 butterflies */
+		if (ns >= 32) {
+			m0 = _mm_load_si128((__m128i *) &out[8 * i]);
+			if (n == 4)
+				SSE_SHUFFLE_METRIC_N4(bm0, bm1, m0, m2)
+			else
+				m2 = _mm_shuffle_epi8(bm0, m0);
+		} else if (n == 2) {
+			m0 = _mm_load_si128((__m128i *) &out[16 * i + 0]);
+			m1 = _mm_load_si128((__m128i *) &out[16 * i + 8]);
+			m0 = _mm_sign_epi16(vals, m0);
+			m1 = _mm_sign_epi16(vals, m1);
+			m2 = _mm_hadds_epi16(m0, m1);
+		} else {
+			m0 = _mm_load_si128((__m128i *) &out[32 * i + 0]);
+			m1 = _mm_load_si128((__m128i *) &out[32 * i + 8]);
+			m2 = _mm_load_si128((__m128i *) &out[32 * i + 16]);
+			m3 = _mm_load_si128((__m128i *) &out[32 * i + 24]);
+
+			SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, vals, m2)
+		}
+
+		/* (PMU) Load and deinterleave accumulated path metrics */
+		if (ns == 4) {
+			m0 = _mm_loadl_epi64((__m128i *) sums);
+			m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(
+				7, 6, 3, 2, 7, 6, 3, 2,
+				5, 4, 1, 0, 5, 4, 1, 0));
+			m4 = _mm_unpackhi_epi64(m3, m3);
+		} else if (ns == 8) {
+			m0 = _mm_load_si128((__m128i *) sums);
+			m3 = _mm_shuffle_epi8(m0, _mm_set_epi8(
+				_I8_SHUFFLE_MASK));
+			m4 = _mm_unpackhi_epi64(m3, m3);
+		} else {
+			m0 = _mm_load_si128((__m128i *) &sums[16 * i + 0]);
+			m1 = _mm_load_si128((__m128i *) &sums[16 * i + 8]);
+
+			SSE_DEINTERLEAVE_K5(m0, m1, m3, m4)
+		}
+
+		/* (PMU) Butterflies */
+		if (mod)
+			SSE_BUTTERFLY_MOD(m3, m4, m2, m5, m6)
+		else
+			SSE_BUTTERFLY(m3, m4, m2, m5, m6)
+
+		lo[i] = m2;
+		hi[i] = m6;
+		d0[i] = m5;
+		d1[i] = m4;
+
+		/* (PMU) Register exchange of the group */
+		if (rex)
+			_sse_rex(ns, 8 * i, ns < 16 ? ns / 2 : 8, m5, m4, rex);
+	}
+
+	/* (PMU) Gather partial registers into state order */
+	if (ns == 4) {
+		lo[0] = _mm_unpacklo_epi32(lo[0], hi[0]);
+		lo[0] = _mm_unpacklo_epi64(lo[0], lo[0]);
+		d0[0] = _mm_unpacklo_epi32(d0[0], d1[0]);
+		d1[0] = _mm_setzero_si128();
+	} else if (ns == 8) {
+		lo[0] = _mm_unpacklo_epi64(lo[0], hi[0]);
+		d0[0] = _mm_unpacklo_epi64(d0[0], d1[0]);
+		d1[0] = _mm_setzero_si128();
+	}
+
+	/* (PMU) Pack path decisions of 16 states per word */
+	if (!rex && (ns <= 16)) {
+		SSE_PACK_PATHS(d0[0], d1[0], paths[0])
+	} else if (!rex) {
+		for (i = 0; i < ns / 32; i++) {
+			SSE_PACK_PATHS(d0[2 * i], d0[2 * i + 1], paths[i])
+			SSE_PACK_PATHS(d1[2 * i], d1[2 * i + 1],
+				       paths[ns / 32 + i])
+		}
+	}
+
+	/* (PMU) Normalize */
+	if (norm) {
+		m0 = lo[0];
+		for (i = 0; i < SSE_GROUPS(ns); i++) {
+			m0 = _mm_min_epi16(m0, lo[i]);
+			if (ns >= 16)
+				m0 = _mm_min_epi16(m0, hi[i]);
+		}
+
+		SSE_MINPOS(m0, m1)
+		SSE_BROADCAST(m0)
+
+		for (i = 0; i < SSE_GROUPS(ns); i++) {
+			lo[i] = _mm_subs_epi16(lo[i], m0);
+			hi[i] = _mm_subs_epi16(hi[i], m0);
+		}
+	}
+
+	/* (PMU) Store path metrics */
+	if (ns < 16) {
+		_mm_store_si128((__m128i *) sums, lo[0]);
+	} else {
+		for (i = 0; i < SSE_GROUPS(ns); i++) {
+			_mm_store_si128((__m128i *) &sums[8 * i], lo[i]);
+			_mm_store_si128((__m128i *) &sums[ns / 2 + 8 * i],
+					hi[i]);
+		}
+	}
+}
+
+void SIMD_FUNC(gen_metrics_k5_n2)(const int8_t *val, const int16_t *out,
+				  int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
+
+	_sse_metrics_k5_n2(_val, out, sums, paths, norm, 0);
+}
+
+void SIMD_FUNC(gen_metrics_k5_n3)(const int8_t *val, const int16_t *out,
+				  int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
+
+	_sse_metrics_k5_n4(_val, out, sums, paths, norm, 0);
+}
+
+void SIMD_FUNC(gen_metrics_k5_n4)(const int8_t *val, const int16_t *out,
+				  int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
+
+	_sse_metrics_k5_n4(_val, out, sums, paths, norm, 0);
+}
+
+void SIMD_FUNC(gen_metrics_k7_n2)(const int8_t *val, const int16_t *out,
+				  int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
+
+	_sse_metrics_k7_n2(_val, out, sums, paths, norm, 0);
+}
+
+void SIMD_FUNC(gen_metrics_k7_n3)(const int8_t *val, const int16_t *out,
+				  int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
+
+	_sse_metrics_k7_n4(3, _val, out, sums, paths, norm, 0);
+}
+
+void SIMD_FUNC(gen_metrics_k7_n4)(const int8_t *val, const int16_t *out,
+				  int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
+
+	_sse_metrics_k7_n4(4, _val, out, sums, paths, norm, 0);
+}
+
+/* Modulo path metric units
+ *     Path metrics wrap around and normalization is never run, so the
+ *     normalization argument is ignored.
+ */
+void SIMD_FUNC(gen_metrics_mod_k5_n2)(const int8_t *val, const int16_t *out,
+				      int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
+
+	_sse_metrics_k5_n2(_val, out, sums, paths, 0, 1);
+}
+
+void SIMD_FUNC(gen_metrics_mod_k5_n3)(const int8_t *val, const int16_t *out,
+				      int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
+
+	_sse_metrics_k5_n4(_val, out, sums, paths, 0, 1);
+}
+
+void SIMD_FUNC(gen_metrics_mod_k5_n4)(const int8_t *val, const int16_t *out,
+				      int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
+
+	_sse_metrics_k5_n4(_val, out, sums, paths, 0, 1);
+}
+
+void SIMD_FUNC(gen_metrics_mod_k7_n2)(const int8_t *val, const int16_t *out,
+				      int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
+
+	_sse_metrics_k7_n2(_val, out, sums, paths, 0, 1);
+}
+
+void SIMD_FUNC(gen_metrics_mod_k7_n3)(const int8_t *val, const int16_t *out,
+				      int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
+
+	_sse_metrics_k7_n4(3, _val, out, sums, paths, 0, 1);
+}
+
+void SIMD_FUNC(gen_metrics_mod_k7_n4)(const int8_t *val, const int16_t *out,
+				      int16_t *sums, int16_t *paths, int norm)
+{
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
+
+	_sse_metrics_k7_n4(4, _val, out, sums, paths, 0, 1);
+}
+
+/* Template instantiation for the remaining constraint lengths */
+#define SSE_METRIC_UNITS(K) \
+void SIMD_FUNC(gen_metrics_k##K##_n2)(const int8_t *val, const int16_t *out, \
+				      int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] }; \
+	_sse_metrics(1 << (K - 1), 2, _val, out, sums, paths, NULL, norm, 0); \
+} \
+void SIMD_FUNC(gen_metrics_k##K##_n3)(const int8_t *val, const int16_t *out, \
+				      int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 }; \
+	_sse_metrics(1 << (K - 1), 3, _val, out, sums, paths, NULL, norm, 0); \
+} \
+void SIMD_FUNC(gen_metrics_k##K##_n4)(const int8_t *val, const int16_t *out, \
+				      int16_t *sums, int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] }; \
+	_sse_metrics(1 << (K - 1), 4, _val, out, sums, paths, NULL, norm, 0); \
+} \
+void SIMD_FUNC(gen_metrics_mod_k##K##_n2)(const int8_t *val, \
+					  const int16_t *out, int16_t *sums, \
+					  int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[0], val[1] }; \
+	_sse_metrics(1 << (K - 1), 2, _val, out, sums, paths, NULL, 0, 1); \
+} \
+void SIMD_FUNC(gen_metrics_mod_k##K##_n3)(const int8_t *val, \
+					  const int16_t *out, int16_t *sums, \
+					  int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], 0 }; \
+	_sse_metrics(1 << (K - 1), 3, _val, out, sums, paths, NULL, 0, 1); \
+} \
+void SIMD_FUNC(gen_metrics_mod_k##K##_n4)(const int8_t *val, \
+					  const int16_t *out, int16_t *sums, \
+					  int16_t *paths, int norm) \
+{ \
+	const int16_t _val[4] = { val[0], val[1], val[2], val[3] }; \
+	_sse_metrics(1 << (K - 1), 4, _val, out, sums, paths, NULL, 0, 1); \
+}
+
+SSE_METRIC_UNITS(3)
+SSE_METRIC_UNITS(4)
+SSE_METRIC_UNITS(6)
+SSE_METRIC_UNITS(8)
+SSE_METRIC_UNITS(9)
+
+/* Register exchange units
+ *     Per-step units of all constraint lengths that update the survivor
+ *     histories in place of storing path decisions. K = 5 and 7 use the
+ *     template rather than the dedicated units.
+ */
+#define SSE_REX_UNIT(K,N,V0,V1,V2,V3) \
+void SIMD_FUNC(gen_rex_k##K##_n##N)(const int8_t *val, const int16_t *out, \
+				    int16_t *sums, const uint64_t *hist, \
+				    uint64_t *next, const uint64_t *bits, \
+				    int norm) \
+{ \
+	const int16_t _val[4] = { V0, V1, V2, V3 }; \
+	const struct rex_step rex = { hist, next, bits }; \
+	_sse_metrics(1 << (K - 1), N, _val, out, sums, NULL, &rex, norm, 0); \
+}
+
+#define SSE_REX_UNITS(K) \
+	SSE_REX_UNIT(K, 2, val[0], val[1], val[0], val[1]) \
+	SSE_REX_UNIT(K, 3, val[0], val[1], val[2], 0) \
+	SSE_REX_UNIT(K, 4, val[0], val[1], val[2], val[3])
+
+SSE_REX_UNITS(3)
+SSE_REX_UNITS(4)
+SSE_REX_UNITS(5)
+SSE_REX_UNITS(6)
+SSE_REX_UNITS(7)
+SSE_REX_UNITS(8)
+SSE_REX_UNITS(9)
+
+/* Expand one step of soft input
+ *     Sign extend 'n' 8-bit soft symbols to 16 bits and repeat them across
+ *     the register in the layout of the per-step units, with the fourth
+ *     symbol zero for N = 3. Only the symbols of the step are read.
+ */
+__always_inline static __m128i _sse_expand(int n, const int8_t *seq)
+{
+	__m128i m0;
+	uint16_t v2;
+	uint32_t v4;
+
+	if (n == 2) {
+		memcpy(&v2, seq, sizeof(v2));
+		m0 = _mm_cvtsi32_si128(v2);
+	} else if (n == 3) {
+		memcpy(&v2, seq, sizeof(v2));
+		m0 = _mm_cvtsi32_si128(v2 | ((uint8_t) seq[2] << 16));
+	} else {
+		memcpy(&v4, seq, sizeof(v4));
+		m0 = _mm_cvtsi32_si128(v4);
+	}
+
+	m0 = _mm_srai_epi16(_mm_unpacklo_epi8(m0, m0), 8);
+
+	if (n == 2)
+		return _mm_shuffle_epi32(m0, _MM_SHUFFLE(0, 0, 0, 0));
+
+	return _mm_unpacklo_epi64(m0, m0);
+}
+
+/* Whole-frame BMU/PMU (K=5)
+ *     Run the combined BMU/PMU over 'len' consecutive unpunctured trellis
+ *     steps. Trellis outputs, the deinterleave mask and all 16 path metrics
+ *     stay in registers for the whole run, so each step only reads its
+ *     input symbols and writes its packed path decisions. 'norm' is the
+ *     normalization countdown of the first step, with zero normalizing, and
+ *     the countdown after the last step is returned.
+ */
+__always_inline static int _sse_frame_k5(int n, const int8_t *seq,
+					 const int16_t *out, int16_t *sums,
+					 int16_t *paths, int len,
+					 int intrvl, int norm)
+{
+	int i;
+	__m128i m0, m1, m2, m3, m4, m5, m6;
+	__m128i o0, o1, o2, o3, s0, s1, mask;
+
+	o0 = _mm_load_si128((__m128i *) &out[0]);
+	o1 = _mm_load_si128((__m128i *) &out[8]);
+	if (n > 2) {
+		o2 = _mm_load_si128((__m128i *) &out[16]);
+		o3 = _mm_load_si128((__m128i *) &out[24]);
+	}
+
+	s0 = _mm_load_si128((__m128i *) &sums[0]);
+	s1 = _mm_load_si128((__m128i *) &sums[8]);
+	mask = _mm_set_epi8(_I8_SHUFFLE_MASK);
+
+	for (i = 0; i < len; i++, seq += n) {
+		/* (BMU) Compute branch metrics */
+		m4 = _sse_expand(n, seq);
+		if (n == 2) {
+			m0 = _mm_sign_epi16(m4, o0);
+			m1 = _mm_sign_epi16(m4, o1);
+			m2 = _mm_hadds_epi16(m0, m1);
+		} else {
+			m0 = o0;
+			m1 = o1;
+			m2 = o2;
+			m3 = o3;
+			SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m4, m2)
+		}
+
+		/* (PMU) Deinterleave path metrics held in registers */
+		m0 = _mm_shuffle_epi8(s0, mask);
+		m1 = _mm_shuffle_epi8(s1, mask);
+		m3 = _mm_unpacklo_epi64(m0, m1);
+		m4 = _mm_unpackhi_epi64(m0, m1);
+
+		/* (PMU) Butterflies: 0-7 */
+		SSE_BUTTERFLY(m3, m4, m2, m5, m6)
+
+		if (!norm)
+			SSE_NORMALIZE_K5(m2, m6, m0, m1)
+		if (++norm == intrvl)
+			norm = 0;
+
+		SSE_PACK_PATHS(m5, m4, paths[i])
+
+		s0 = m2;
+		s1 = m6;
+	}
+
+	_mm_store_si128((__m128i *) &sums[0], s0);
+	_mm_store_si128((__m128i *) &sums[8], s1);
+
+	return norm;
+}
+
+int SIMD_FUNC(gen_frame_k5_n2)(const int8_t *seq, const int16_t *out,
+			       int16_t *sums, int16_t *paths, int len,
+			       int intrvl, int norm)
+{
+	return _sse_frame_k5(2, seq, out, sums, paths, len, intrvl, norm);
+}
+
+int SIMD_FUNC(gen_frame_k5_n3)(const int8_t *seq, const int16_t *out,
+			       int16_t *sums, int16_t *paths, int len,
+			       int intrvl, int norm)
+{
+	return _sse_frame_k5(3, seq, out, sums, paths, len, intrvl, norm);
+}
+
+int SIMD_FUNC(gen_frame_k5_n4)(const int8_t *seq, const int16_t *out,
+			       int16_t *sums, int16_t *paths, int len,
+			       int intrvl, int norm)
+{
+	return _sse_frame_k5(4, seq, out, sums, paths, len, intrvl, norm);
+}
+
+/* 8-bit path metrics
+ *     Path metrics held as packed 8-bit integers fit 16 states per register,
+ *     so the K=5 trellis occupies a single register and K=7 four registers.
+ *     The input is scaled by the caller so that the magnitude of any branch
+ *     metric is below 48. Renormalization is adaptive: metrics are reduced
+ *     only once one of them exceeds the threshold, which leaves enough
+ *     headroom for the following step.
+ */
+#define METRIC8_THRESH		(INT8_MAX - 48)
+
+/* Packed 8-bit signed maximum
+ *     Only SSE 4.1 has a dedicated instruction. Otherwise select with the
+ *     comparison result P of the same operands, which the butterfly already
+ *     computes.
+ */
+#ifdef __SSE4_1__
+#define SSE_MAX_EPI8(M0,M1,P)	_mm_max_epi8(M0, M1)
+#else
+#define SSE_MAX_EPI8(M0,M1,P) \
+	_mm_or_si128(_mm_and_si128(P, M0), _mm_andnot_si128(P, M1))
+#endif
+
+/* 16-Viterbi butterfly (8-bit):
+ *     Compute 16-wide butterfly generating 32 path decisions and 32
+ *     accumulated sums. Inputs all packed 8-bit integers in three 128-bit
+ *     XMM registers.
+ *
+ *     Input:
+ *     M0 - Path metrics 0 (packed 8-bit integers)
+ *     M1 - Path metrics 1 (packed 8-bit integers)
+ *     M2 - Branch metrics (packed 8-bit integers)
+ *
+ *     Output:
+ *     M3 - Selected and accumulated path metrics 0
+ *     M1 - Selected and accumulated path metrics 1
+ *     M2 - Path selections 0
+ *     M4 - Path selections 1
+ */
+#define SSE_BUTTERFLY8(M0,M1,M2,M3,M4) \
+{ \
+	M3 = _mm_adds_epi8(M0, M2); \
+	M4 = _mm_subs_epi8(M1, M2); \
+	M0 = _mm_subs_epi8(M0, M2); \
+	M1 = _mm_adds_epi8(M1, M2); \
+	M2 = _mm_cmpgt_epi8(M3, M4); \
+	M3 = SSE_MAX_EPI8(M3, M4, M2); \
+	M4 = _mm_cmpgt_epi8(M0, M1); \
+	M1 = SSE_MAX_EPI8(M0, M1, M4); \
+}
+
+/* Deinterleave 16 packed 8-bit integers to even (low) and odd (high) halves */
+#define _I8_DEINTERLEAVE_MASK \
+	15, 13, 11, 9, 7, 5, 3, 1, 14, 12, 10, 8, 6, 4, 2, 0
+
+/* Adaptive renormalization (8-bit)
+ *     If any metric exceeds the threshold, subtract the excess of the largest
+ *     metric from all metrics, so the best paths keep their resolution and
+ *     losing paths clip at the lower limit instead. The maximum is taken in
+ *     the unsigned domain after flipping the sign bit because SSE2 only has
+ *     an unsigned 8-bit maximum. Metrics pinned at either limit mean that
+ *     the metric spread no longer fits in 8 bits. Returns 1 if saturation
+ *     was detected and 0 otherwise.
+ */
+__always_inline static int _sse_renorm8(__m128i *m, int cnt)
+{
+	int i;
+	__m128i m0, m1, m2, m3;
+
+	m2 = _mm_set1_epi8(INT8_MIN);
+	m3 = _mm_set1_epi8(METRIC8_THRESH);
+	m0 = _mm_cmpgt_epi8(m[0], m3);
+	for (i = 1; i < cnt; i++)
+		m0 = _mm_or_si128(m0, _mm_cmpgt_epi8(m[i], m3));
+
+	if (_mm_movemask_epi8(m0)) {
+		/* Horizontal maximum */
+		m1 = _mm_xor_si128(m[0], m2);
+		for (i = 1; i < cnt; i++)
+			m1 = _mm_max_epu8(m1, _mm_xor_si128(m[i], m2));
+
+		m1 = _mm_max_epu8(m1, _mm_srli_si128(m1, 8));
+		m1 = _mm_max_epu8(m1, _mm_srli_si128(m1, 4));
+		m1 = _mm_max_epu8(m1, _mm_srli_si128(m1, 2));
+		m1 = _mm_max_epu8(m1, _mm_srli_si128(m1, 1));
+
+		m1 = _mm_shuffle_epi8(m1, _mm_setzero_si128());
+		m1 = _mm_sub_epi8(_mm_xor_si128(m1, m2), m3);
+
+		for (i = 0; i < cnt; i++)
+			m[i] = _mm_subs_epi8(m[i], m1);
+	}
+
+	/* Lower or upper limit */
+	m1 = _mm_set1_epi8(INT8_MAX);
+	m0 = _mm_or_si128(_mm_cmpeq_epi8(m[0], m2), _mm_cmpeq_epi8(m[0], m1));
+	for (i = 1; i < cnt; i++) {
+		m0 = _mm_or_si128(m0, _mm_cmpeq_epi8(m[i], m2));
+		m0 = _mm_or_si128(m0, _mm_cmpeq_epi8(m[i], m1));
+	}
+
+	return _mm_movemask_epi8(m0) ? 1 : 0;
+}
+
+/* Combined BMU/PMU (K=5, N=2, 8-bit)
+ *     Branch metrics are computed at 16 bits as in the 16-bit units and then
+ *     packed down. All 16 path metrics are held in one register.
+ */
+__always_inline static int _sse_metrics8_k5_n2(const int16_t *val,
+					       const int16_t *out,
+					       int8_t *sums,
+					       int16_t *paths)
+{
+	int sat;
+	__m128i m0, m1, m2, m3, m4;
+
+	/* (BMU) Load input sequence */
+	m2 = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
+
+	/* (BMU) Load trellis outputs */
+	m0 = _mm_load_si128((__m128i *) &out[0]);
+	m1 = _mm_load_si128((__m128i *) &out[8]);
+
+	/* (BMU) Compute and pack branch metrics */
+	m0 = _mm_sign_epi16(m2, m0);
+	m1 = _mm_sign_epi16(m2, m1);
+	m2 = _mm_hadds_epi16(m0, m1);
+	m2 = _mm_packs_epi16(m2, m2);
+
+	/* (PMU) Load and deinterleave accumulated path metrics */
+	m0 = _mm_load_si128((__m128i *) &sums[0]);
+	m1 = _mm_set_epi8(_I8_DEINTERLEAVE_MASK);
+	m0 = _mm_shuffle_epi8(m0, m1);
+	m1 = _mm_unpackhi_epi64(m0, m0);
+
+	/* (PMU) Butterflies: 0-7 */
+	SSE_BUTTERFLY8(m0, m1, m2, m3, m4)
+
+	m3 = _mm_unpacklo_epi64(m3, m1);
+	m2 = _mm_unpacklo_epi64(m2, m4);
+	paths[0] = (int16_t) _mm_movemask_epi8(m2);
+
+	sat = _sse_renorm8(&m3, 1);
+
+	_mm_store_si128((__m128i *) &sums[0], m3);
+
+	return sat;
+}
+
+/* Combined BMU/PMU (K=5, N=3 and N=4, 8-bit) */
+__always_inline static int _sse_metrics8_k5_n4(const int16_t *val,
+					       const int16_t *out,
+					       int8_t *sums,
+					       int16_t *paths)
+{
+	int sat;
+	__m128i m0, m1, m2, m3, m4, m5;
+
+	/* (BMU) Load input sequence */
+	m4 = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
+
+	/* (BMU) Load trellis outputs */
 	m0 = _mm_load_si128((__m128i *) &out[0]);
 	m1 = _mm_load_si128((__m128i *) &out[8]);
 	m2 = _mm_load_si128((__m128i *) &out[16]);
 	m3 = _mm_load_si128((__m128i *) &out[24]);
 
-	SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m7, m4)
+	/* (BMU) Compute and pack branch metrics */
+	SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m4, m5)
+	m2 = _mm_packs_epi16(m5, m5);
+
+	/* (PMU) Load and deinterleave accumulated path metrics */
+	m0 = _mm_load_si128((__m128i *) &sums[0]);
+	m1 = _mm_set_epi8(_I8_DEINTERLEAVE_MASK);
+	m0 = _mm_shuffle_epi8(m0, m1);
+	m1 = _mm_unpackhi_epi64(m0, m0);
+
+	/* (PMU) Butterflies: 0-7 */
+	SSE_BUTTERFLY8(m0, m1, m2, m3, m4)
+
+	m3 = _mm_unpacklo_epi64(m3, m1);
+	m2 = _mm_unpacklo_epi64(m2, m4);
+	paths[0] = (int16_t) _mm_movemask_epi8(m2);
+
+	sat = _sse_renorm8(&m3, 1);
+
+	_mm_store_si128((__m128i *) &sums[0], m3);
+
+	return sat;
+}
+
+/* 64-state path metric unit (8-bit)
+ *     Shared by all K=7 rates. Takes 32 packed 8-bit branch metrics in two
+ *     registers. All 64 path metrics are held in four registers.
+ */
+__always_inline static int _sse_path_metrics8_k7(__m128i bm0, __m128i bm1,
+						 int8_t *sums,
+						 int16_t *paths)
+{
+	int sat;
+	__m128i m0, m1, m2, m3, m4, m5, m6, m7;
+	__m128i m[4];
+
+	/* (PMU) Load and deinterleave accumulated path metrics */
+	m4 = _mm_set_epi8(_I8_DEINTERLEAVE_MASK);
+	m0 = _mm_shuffle_epi8(_mm_load_si128((__m128i *) &sums[0]), m4);
+	m1 = _mm_shuffle_epi8(_mm_load_si128((__m128i *) &sums[16]), m4);
+	m2 = _mm_shuffle_epi8(_mm_load_si128((__m128i *) &sums[32]), m4);
+	m3 = _mm_shuffle_epi8(_mm_load_si128((__m128i *) &sums[48]), m4);
+
+	m4 = _mm_unpacklo_epi64(m0, m1);
+	m5 = _mm_unpackhi_epi64(m0, m1);
+	m6 = _mm_unpacklo_epi64(m2, m3);
+	m7 = _mm_unpackhi_epi64(m2, m3);
+
+	/* (PMU) Butterflies: 0-15 and 16-31 */
+	SSE_BUTTERFLY8(m4, m5, bm0, m0, m1)
+	SSE_BUTTERFLY8(m6, m7, bm1, m2, m3)
+
+	paths[0] = (int16_t) _mm_movemask_epi8(bm0);
+	paths[1] = (int16_t) _mm_movemask_epi8(bm1);
+	paths[2] = (int16_t) _mm_movemask_epi8(m1);
+	paths[3] = (int16_t) _mm_movemask_epi8(m3);
+
+	m[0] = m0;
+	m[1] = m2;
+	m[2] = m5;
+	m[3] = m7;
+
+	sat = _sse_renorm8(m, 4);
+
+	_mm_store_si128((__m128i *) &sums[0], m[0]);
+	_mm_store_si128((__m128i *) &sums[16], m[1]);
+	_mm_store_si128((__m128i *) &sums[32], m[2]);
+	_mm_store_si128((__m128i *) &sums[48], m[3]);
+
+	return sat;
+}
+
+/* Combined BMU/PMU (K=7, N=2, 8-bit) */
+__always_inline static int _sse_metrics8_k7_n2(const int16_t *val,
+					       const int16_t *out,
+					       int8_t *sums,
+					       int16_t *paths)
+{
+	__m128i m0, m1, m2, m3, m4, m5, m6, m7, m8;
+
+	/* (BMU) Load input sequence */
+	m4 = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
+
+	/* (BMU) Load trellis outputs and compute branch metrics */
+	m0 = _mm_load_si128((__m128i *) &out[0]);
+	m1 = _mm_load_si128((__m128i *) &out[8]);
+	m2 = _mm_load_si128((__m128i *) &out[16]);
+	m3 = _mm_load_si128((__m128i *) &out[24]);
+
+	SSE_BRANCH_METRIC_N2(m0, m1, m2, m3, m4, m5, m6)
 
 	m0 = _mm_load_si128((__m128i *) &out[32]);
 	m1 = _mm_load_si128((__m128i *) &out[40]);
 	m2 = _mm_load_si128((__m128i *) &out[48]);
 	m3 = _mm_load_si128((__m128i *) &out[56]);
 
-	SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m7, m5)
+	SSE_BRANCH_METRIC_N2(m0, m1, m2, m3, m4, m7, m8)
 
-	m0 = _mm_load_si128((__m128i *) &out[64]);
-	m1 = _mm_load_si128((__m128i *) &out[72]);
-	m2 = _mm_load_si128((__m128i *) &out[80]);
-	m3 = _mm_load_si128((__m128i *) &out[88]);
+	m5 = _mm_packs_epi16(m5, m6);
+	m7 = _mm_packs_epi16(m7, m8);
 
-	SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m7, m6)
-
-	m0 = _mm_load_si128((__m128i *) &out[96]);
-	m1 = _mm_load_si128((__m128i *) &out[104]);
-	m2 = _mm_load_si128((__m128i *) &out[112]);
-	m3 = _mm_load_si128((__m128i *) &out[120]);
-
-	SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m7, m7)
+	return _sse_path_metrics8_k7(m5, m7, sums, paths);
+}
 
-	/* (PMU) Butterflies: 0-15 */
-	SSE_BUTTERFLY(m8, m9, m4, m0, m1)
-	SSE_BUTTERFLY(m10, m11, m5, m2, m3)
+/* Combined BMU/PMU (K=7, N=3 and N=4, 8-bit) */
+__always_inline static int _sse_metrics8_k7_n4(const int16_t *val,
+					       const int16_t *out,
+					       int8_t *sums,
+					       int16_t *paths)
+{
+	int i;
+	__m128i m0, m1, m2, m3, m4, m5;
+	__m128i bm[4];
 
-	_mm_store_si128((__m128i *) &paths[0], m0);
-	_mm_store_si128((__m128i *) &paths[8], m2);
-	_mm_store_si128((__m128i *) &paths[32], m9);
-	_mm_store_si128((__m128i *) &paths[40], m11);
+	/* (BMU) Load input sequence */
+	m4 = _mm_castpd_si128(_mm_loaddup_pd((double const *) val));
 
-	/* (PMU) Butterflies: 17-31 */
-	SSE_BUTTERFLY(m12, m13, m6, m0, m2)
-	SSE_BUTTERFLY(m14, m15, m7, m9, m11)
+	/* (BMU) Load trellis outputs and compute branch metrics */
+	for (i = 0; i < 4; i++) {
+		m0 = _mm_load_si128((__m128i *) &out[32 * i + 0]);
+		m1 = _mm_load_si128((__m128i *) &out[32 * i + 8]);
+		m2 = _mm_load_si128((__m128i *) &out[32 * i + 16]);
+		m3 = _mm_load_si128((__m128i *) &out[32 * i + 24]);
 
-	_mm_store_si128((__m128i *) &paths[16], m0);
-	_mm_store_si128((__m128i *) &paths[24], m9);
-	_mm_store_si128((__m128i *) &paths[48], m13);
-	_mm_store_si128((__m128i *) &paths[56], m15);
+		SSE_BRANCH_METRIC_N4(m0, m1, m2, m3, m4, m5)
+		bm[i] = m5;
+	}
 
-	if (norm)
-		SSE_NORMALIZE_K7(m4, m1, m5, m3, m6, m2,
-				 m7, m11, m0, m8, m9, m10)
+	bm[0] = _mm_packs_epi16(bm[0], bm[1]);
+	bm[2] = _mm_packs_epi16(bm[2], bm[3]);
 
-	_mm_store_si128((__m128i *) &sums[0], m4);
-	_mm_store_si128((__m128i *) &sums[8], m5);
-	_mm_store_si128((__m128i *) &sums[16], m6);
-	_mm_store_si128((__m128i *) &sums[24], m7);
-	_mm_store_si128((__m128i *) &sums[32], m1);
-	_mm_store_si128((__m128i *) &sums[40], m3);
-	_mm_store_si128((__m128i *) &sums[48], m2);
-	_mm_store_si128((__m128i *) &sums[56], m11);
+	return _sse_path_metrics8_k7(bm[0], bm[2], sums, paths);
 }
 
-void gen_metrics_k5_n2(const int8_t *val, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm)
+int SIMD_FUNC(gen_metrics8_k5_n2)(const int8_t *val, const int16_t *out,
+				  int8_t *sums, int16_t *paths)
 {
 	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
 
-	_sse_metrics_k5_n2(_val, out, sums, paths, norm);
+	return _sse_metrics8_k5_n2(_val, out, sums, paths);
 }
 
-void gen_metrics_k5_n3(const int8_t *val, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm)
+int SIMD_FUNC(gen_metrics8_k5_n3)(const int8_t *val, const int16_t *out,
+				  int8_t *sums, int16_t *paths)
 {
 	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
 
-	_sse_metrics_k5_n4(_val, out, sums, paths, norm);
+	return _sse_metrics8_k5_n4(_val, out, sums, paths);
 }
 
-void gen_metrics_k5_n4(const int8_t *val, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm)
+int SIMD_FUNC(gen_metrics8_k5_n4)(const int8_t *val, const int16_t *out,
+				  int8_t *sums, int16_t *paths)
 {
 	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
 
-	_sse_metrics_k5_n4(_val, out, sums, paths, norm);
+	return _sse_metrics8_k5_n4(_val, out, sums, paths);
 }
 
-void gen_metrics_k7_n2(const int8_t *val, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm)
+int SIMD_FUNC(gen_metrics8_k7_n2)(const int8_t *val, const int16_t *out,
+				  int8_t *sums, int16_t *paths)
 {
 	const int16_t _val[4] = { val[0], val[1], val[0], val[1] };
 
-	_sse_metrics_k7_n2(_val, out, sums, paths, norm);
+	return _sse_metrics8_k7_n2(_val, out, sums, paths);
 }
 
-void gen_metrics_k7_n3(const int8_t *val, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm)
+int SIMD_FUNC(gen_metrics8_k7_n3)(const int8_t *val, const int16_t *out,
+				  int8_t *sums, int16_t *paths)
 {
 	const int16_t _val[4] = { val[0], val[1], val[2], 0 };
 
-	_sse_metrics_k7_n4(_val, out, sums, paths, norm);
+	return _sse_metrics8_k7_n4(_val, out, sums, paths);
 }
 
-void gen_metrics_k7_n4(const int8_t *val, const int16_t *out,
-		       int16_t *sums, int16_t *paths, int norm)
+int SIMD_FUNC(gen_metrics8_k7_n4)(const int8_t *val, const int16_t *out,
+				  int8_t *sums, int16_t *paths)
 {
 	const int16_t _val[4] = { val[0], val[1], val[2], val[3] };
 
-	_sse_metrics_k7_n4(_val, out, sums, paths, norm);
+	return _sse_metrics8_k7_n4(_val, out, sums, paths);
 }
 
-#endif /* HAVE_SSE3 */
+/* Inter-frame batch metric unit
+ *     Compute branch and path metrics for one trellis step of 'lanes'
+ *     independent frames of the same code. Each 16-bit lane holds one frame,
+ *     so butterflies are computed 8 frames at a time and any trellis size is
+ *     handled by the same unit. Trellis outputs are all +/-1, so only 2^N
+ *     distinct branch metrics exist per frame. These are computed once and
+ *     selected by the per-butterfly index 'bidx'. Path decisions are packed
+ *     with one bit per frame.
+ *
+ *     ns       - Number of trellis states
+ *     n        - Code order
+ *     lanes    - Number of frames (multiple of 8)
+ *     val      - Soft input of the step, 'lanes' values per code bit
+ *     bidx     - Branch metric index of each butterfly
+ *     sums     - Accumulated path metrics, 'lanes' values per state
+ *     new_sums - Updated path metrics, 'lanes' values per state
+ *     paths    - Path decisions, 'lanes' bits per state
+ *     norm     - Set to '1' to normalize the updated path metrics
+ */
+__always_inline static void _sse_batch_metrics(int ns, int n, int lanes,
+					       const int16_t *val,
+					       const uint8_t *bidx,
+					       const int16_t *sums,
+					       int16_t *new_sums,
+					       uint8_t *paths, int norm)
+{
+	int i, j, c, g, mask;
+	int groups = lanes / 8;
+	const int16_t *s;
+	int16_t *t;
+	__m128i m0, m1, m2, m3, m4, min;
+	__m128i v[4], bm[16];
+
+	for (g = 0; g < groups; g++) {
+		/* (BMU) Unique branch metrics */
+		for (j = 0; j < n; j++)
+			v[j] = _mm_load_si128((__m128i *) &val[j * lanes + 8 * g]);
+
+		for (c = 0; c < (1 << n); c++) {
+			bm[c] = _mm_setzero_si128();
+			for (j = 0; j < n; j++) {
+				if ((c >> j) & 0x01)
+					bm[c] = _mm_subs_epi16(bm[c], v[j]);
+				else
+					bm[c] = _mm_adds_epi16(bm[c], v[j]);
+			}
+		}
+
+		/* (PMU) Butterflies */
+		min = _mm_set1_epi16(INT16_MAX);
+		s = &sums[8 * g];
+		t = &new_sums[8 * g];
+
+		for (i = 0; i < ns / 2; i++) {
+			m0 = _mm_load_si128((__m128i *) &s[(2 * i + 0) * lanes]);
+			m1 = _mm_load_si128((__m128i *) &s[(2 * i + 1) * lanes]);
+			m2 = bm[bidx[i]];
+
+			SSE_BUTTERFLY(m0, m1, m2, m3, m4)
+
+			_mm_store_si128((__m128i *) &t[i * lanes], m2);
+			_mm_store_si128((__m128i *) &t[(i + ns / 2) * lanes], m4);
+
+			mask = _mm_movemask_epi8(_mm_packs_epi16(m3, m1));
+			paths[i * groups + g] = mask;
+			paths[(i + ns / 2) * groups + g] = mask >> 8;
+
+			min = _mm_min_epi16(min, _mm_min_epi16(m2, m4));
+		}
+
+		if (!norm)
+			continue;
+
+		/* Per-frame normalization */
+		for (i = 0; i < ns; i++) {
+			m0 = _mm_load_si128((__m128i *) &t[i * lanes]);
+			m0 = _mm_subs_epi16(m0, min);
+			_mm_store_si128((__m128i *) &t[i * lanes], m0);
+		}
+	}
+}
+
+/* Expand the batch unit for the common trellis sizes and code orders so
+ * that the butterfly and branch metric loops are fully unrolled. Other
+ * constraint lengths run the same unit with loops bounded at runtime.
+ */
+void SIMD_FUNC(gen_batch_metrics)(int ns, int n, int lanes,
+				  const int16_t *val, const uint8_t *bidx,
+				  const int16_t *sums, int16_t *new_sums,
+				  uint8_t *paths, int norm)
+{
+	switch ((ns << 4) | n) {
+	case (16 << 4) | 2:
+		_sse_batch_metrics(16, 2, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (16 << 4) | 3:
+		_sse_batch_metrics(16, 3, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (16 << 4) | 4:
+		_sse_batch_metrics(16, 4, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (64 << 4) | 2:
+		_sse_batch_metrics(64, 2, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (64 << 4) | 3:
+		_sse_batch_metrics(64, 3, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	case (64 << 4) | 4:
+		_sse_batch_metrics(64, 4, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+		break;
+	default:
+		_sse_batch_metrics(ns, n, lanes, val, bidx,
+				   sums, new_sums, paths, norm);
+	}
+}
@@ -1014,6 +1014,26 @@ static const uint8_t lte_pbch_next_state[][2] = {
 	{ 56, 57 }, { 58, 59 }, { 60, 61 }, { 62, 63 },
 };
 
+/* IEEE 802.11 rate 1/2 mother code (zero terminated stream) */
+const struct osmo_conv_code wlan_conv_stream = {
+	.N = 2,
+	.K = 7,
+	.len = 100000,
+	.term = CONV_TERM_FLUSH,
+	.next_output = gmr1_tch3_speech_next_output,
+	.next_state  = gmr1_tch3_speech_next_state,
+};
+
+/* DVB-S inner code rate 1/2 (unterminated stream) */
+const struct osmo_conv_code dvb_conv_stream = {
+	.N = 2,
+	.K = 7,
+	.len = 100000,
+	.term = CONV_TERM_TRUNCATION,
+	.next_output = wimax_fch_next_output,
+	.next_state  = wimax_fch_next_state,
+};
+
 /* LTE PBCH */
 const struct osmo_conv_code lte_conv_pbch = {
 	.N = 3,
@@ -1024,6 +1044,372 @@ const struct osmo_conv_code lte_conv_pbch = {
 	.next_state  = lte_pbch_next_state,
 };
 
+static const uint8_t umts_bch_next_output[][2] = {
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  3,  0 }, {  2,  1 }, {  0,  3 }, {  1,  2 },
+	{  0,  3 }, {  1,  2 }, {  3,  0 }, {  2,  1 },
+	{  1,  2 }, {  0,  3 }, {  2,  1 }, {  3,  0 },
+	{  2,  1 }, {  3,  0 }, {  1,  2 }, {  0,  3 },
+};
+
+static const uint8_t umts_bch_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{  64,  65 }, {  66,  67 }, {  68,  69 }, {  70,  71 },
+	{  72,  73 }, {  74,  75 }, {  76,  77 }, {  78,  79 },
+	{  80,  81 }, {  82,  83 }, {  84,  85 }, {  86,  87 },
+	{  88,  89 }, {  90,  91 }, {  92,  93 }, {  94,  95 },
+	{  96,  97 }, {  98,  99 }, { 100, 101 }, { 102, 103 },
+	{ 104, 105 }, { 106, 107 }, { 108, 109 }, { 110, 111 },
+	{ 112, 113 }, { 114, 115 }, { 116, 117 }, { 118, 119 },
+	{ 120, 121 }, { 122, 123 }, { 124, 125 }, { 126, 127 },
+	{ 128, 129 }, { 130, 131 }, { 132, 133 }, { 134, 135 },
+	{ 136, 137 }, { 138, 139 }, { 140, 141 }, { 142, 143 },
+	{ 144, 145 }, { 146, 147 }, { 148, 149 }, { 150, 151 },
+	{ 152, 153 }, { 154, 155 }, { 156, 157 }, { 158, 159 },
+	{ 160, 161 }, { 162, 163 }, { 164, 165 }, { 166, 167 },
+	{ 168, 169 }, { 170, 171 }, { 172, 173 }, { 174, 175 },
+	{ 176, 177 }, { 178, 179 }, { 180, 181 }, { 182, 183 },
+	{ 184, 185 }, { 186, 187 }, { 188, 189 }, { 190, 191 },
+	{ 192, 193 }, { 194, 195 }, { 196, 197 }, { 198, 199 },
+	{ 200, 201 }, { 202, 203 }, { 204, 205 }, { 206, 207 },
+	{ 208, 209 }, { 210, 211 }, { 212, 213 }, { 214, 215 },
+	{ 216, 217 }, { 218, 219 }, { 220, 221 }, { 222, 223 },
+	{ 224, 225 }, { 226, 227 }, { 228, 229 }, { 230, 231 },
+	{ 232, 233 }, { 234, 235 }, { 236, 237 }, { 238, 239 },
+	{ 240, 241 }, { 242, 243 }, { 244, 245 }, { 246, 247 },
+	{ 248, 249 }, { 250, 251 }, { 252, 253 }, { 254, 255 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{  64,  65 }, {  66,  67 }, {  68,  69 }, {  70,  71 },
+	{  72,  73 }, {  74,  75 }, {  76,  77 }, {  78,  79 },
+	{  80,  81 }, {  82,  83 }, {  84,  85 }, {  86,  87 },
+	{  88,  89 }, {  90,  91 }, {  92,  93 }, {  94,  95 },
+	{  96,  97 }, {  98,  99 }, { 100, 101 }, { 102, 103 },
+	{ 104, 105 }, { 106, 107 }, { 108, 109 }, { 110, 111 },
+	{ 112, 113 }, { 114, 115 }, { 116, 117 }, { 118, 119 },
+	{ 120, 121 }, { 122, 123 }, { 124, 125 }, { 126, 127 },
+	{ 128, 129 }, { 130, 131 }, { 132, 133 }, { 134, 135 },
+	{ 136, 137 }, { 138, 139 }, { 140, 141 }, { 142, 143 },
+	{ 144, 145 }, { 146, 147 }, { 148, 149 }, { 150, 151 },
+	{ 152, 153 }, { 154, 155 }, { 156, 157 }, { 158, 159 },
+	{ 160, 161 }, { 162, 163 }, { 164, 165 }, { 166, 167 },
+	{ 168, 169 }, { 170, 171 }, { 172, 173 }, { 174, 175 },
+	{ 176, 177 }, { 178, 179 }, { 180, 181 }, { 182, 183 },
+	{ 184, 185 }, { 186, 187 }, { 188, 189 }, { 190, 191 },
+	{ 192, 193 }, { 194, 195 }, { 196, 197 }, { 198, 199 },
+	{ 200, 201 }, { 202, 203 }, { 204, 205 }, { 206, 207 },
+	{ 208, 209 }, { 210, 211 }, { 212, 213 }, { 214, 215 },
+	{ 216, 217 }, { 218, 219 }, { 220, 221 }, { 222, 223 },
+	{ 224, 225 }, { 226, 227 }, { 228, 229 }, { 230, 231 },
+	{ 232, 233 }, { 234, 235 }, { 236, 237 }, { 238, 239 },
+	{ 240, 241 }, { 242, 243 }, { 244, 245 }, { 246, 247 },
+	{ 248, 249 }, { 250, 251 }, { 252, 253 }, { 254, 255 },
+};
+
+/* UMTS BCH (rate 1/2) */
+const struct osmo_conv_code umts_conv_bch = {
+	.N = 2,
+	.K = 9,
+	.len = 262,
+	.next_output = umts_bch_next_output,
+	.next_state  = umts_bch_next_state,
+};
+
+static const uint8_t umts_dch_next_output[][2] = {
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  5,  2 }, {  6,  1 }, {  0,  7 }, {  3,  4 },
+	{  3,  4 }, {  0,  7 }, {  6,  1 }, {  5,  2 },
+	{  7,  0 }, {  4,  3 }, {  2,  5 }, {  1,  6 },
+	{  1,  6 }, {  2,  5 }, {  4,  3 }, {  7,  0 },
+	{  0,  7 }, {  3,  4 }, {  5,  2 }, {  6,  1 },
+	{  6,  1 }, {  5,  2 }, {  3,  4 }, {  0,  7 },
+	{  2,  5 }, {  1,  6 }, {  7,  0 }, {  4,  3 },
+	{  4,  3 }, {  7,  0 }, {  1,  6 }, {  2,  5 },
+};
+
+/* UMTS DCH (rate 1/3) */
+const struct osmo_conv_code umts_conv_dch = {
+	.N = 3,
+	.K = 9,
+	.len = 244,
+	.next_output = umts_dch_next_output,
+	.next_state  = umts_bch_next_state,
+};
+
+static const uint8_t conv_k3_next_output[][2] = {
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+};
+
+static const uint8_t conv_k3_next_state[][2] = {
+	{ 0, 1 }, { 2, 3 }, { 0, 1 }, { 2, 3 },
+};
+
+/* K=3 code (rate 1/2) */
+const struct osmo_conv_code conv_k3 = {
+	.N = 2,
+	.K = 3,
+	.len = 100,
+	.next_output = conv_k3_next_output,
+	.next_state  = conv_k3_next_state,
+};
+
+static const uint8_t conv_k4_next_output[][2] = {
+	{ 0, 7 }, { 3, 4 }, { 5, 2 }, { 6, 1 },
+	{ 7, 0 }, { 4, 3 }, { 2, 5 }, { 1, 6 },
+};
+
+static const uint8_t conv_k4_next_state[][2] = {
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+};
+
+/* K=4 code (rate 1/3, tail-biting) */
+const struct osmo_conv_code conv_k4 = {
+	.N = 3,
+	.K = 4,
+	.len = 60,
+	.term = CONV_TERM_TAIL_BITING,
+	.next_output = conv_k4_next_output,
+	.next_state  = conv_k4_next_state,
+};
+
+static const uint8_t conv_k6_next_output[][2] = {
+	{  0, 15 }, {  7,  8 }, { 11,  4 }, { 12,  3 },
+	{  5, 10 }, {  2, 13 }, { 14,  1 }, {  9,  6 },
+	{ 12,  3 }, { 11,  4 }, {  7,  8 }, {  0, 15 },
+	{  9,  6 }, { 14,  1 }, {  2, 13 }, {  5, 10 },
+	{ 15,  0 }, {  8,  7 }, {  4, 11 }, {  3, 12 },
+	{ 10,  5 }, { 13,  2 }, {  1, 14 }, {  6,  9 },
+	{  3, 12 }, {  4, 11 }, {  8,  7 }, { 15,  0 },
+	{  6,  9 }, {  1, 14 }, { 13,  2 }, { 10,  5 },
+};
+
+static const uint8_t conv_k6_next_state[][2] = {
+	{  0,  1 }, {  2,  3 }, {  4,  5 }, {  6,  7 },
+	{  8,  9 }, { 10, 11 }, { 12, 13 }, { 14, 15 },
+	{ 16, 17 }, { 18, 19 }, { 20, 21 }, { 22, 23 },
+	{ 24, 25 }, { 26, 27 }, { 28, 29 }, { 30, 31 },
+	{  0,  1 }, {  2,  3 }, {  4,  5 }, {  6,  7 },
+	{  8,  9 }, { 10, 11 }, { 12, 13 }, { 14, 15 },
+	{ 16, 17 }, { 18, 19 }, { 20, 21 }, { 22, 23 },
+	{ 24, 25 }, { 26, 27 }, { 28, 29 }, { 30, 31 },
+};
+
+/* K=6 code (rate 1/4) */
+const struct osmo_conv_code conv_k6 = {
+	.N = 4,
+	.K = 6,
+	.len = 120,
+	.next_output = conv_k6_next_output,
+	.next_state  = conv_k6_next_state,
+};
+
+static const uint8_t conv_k8_next_output[][2] = {
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 0, 3 }, { 1, 2 }, { 3, 0 }, { 2, 1 },
+	{ 1, 2 }, { 0, 3 }, { 2, 1 }, { 3, 0 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 2, 1 }, { 3, 0 }, { 1, 2 }, { 0, 3 },
+	{ 3, 0 }, { 2, 1 }, { 0, 3 }, { 1, 2 },
+};
+
+static const uint8_t conv_k8_next_state[][2] = {
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{  64,  65 }, {  66,  67 }, {  68,  69 }, {  70,  71 },
+	{  72,  73 }, {  74,  75 }, {  76,  77 }, {  78,  79 },
+	{  80,  81 }, {  82,  83 }, {  84,  85 }, {  86,  87 },
+	{  88,  89 }, {  90,  91 }, {  92,  93 }, {  94,  95 },
+	{  96,  97 }, {  98,  99 }, { 100, 101 }, { 102, 103 },
+	{ 104, 105 }, { 106, 107 }, { 108, 109 }, { 110, 111 },
+	{ 112, 113 }, { 114, 115 }, { 116, 117 }, { 118, 119 },
+	{ 120, 121 }, { 122, 123 }, { 124, 125 }, { 126, 127 },
+	{   0,   1 }, {   2,   3 }, {   4,   5 }, {   6,   7 },
+	{   8,   9 }, {  10,  11 }, {  12,  13 }, {  14,  15 },
+	{  16,  17 }, {  18,  19 }, {  20,  21 }, {  22,  23 },
+	{  24,  25 }, {  26,  27 }, {  28,  29 }, {  30,  31 },
+	{  32,  33 }, {  34,  35 }, {  36,  37 }, {  38,  39 },
+	{  40,  41 }, {  42,  43 }, {  44,  45 }, {  46,  47 },
+	{  48,  49 }, {  50,  51 }, {  52,  53 }, {  54,  55 },
+	{  56,  57 }, {  58,  59 }, {  60,  61 }, {  62,  63 },
+	{  64,  65 }, {  66,  67 }, {  68,  69 }, {  70,  71 },
+	{  72,  73 }, {  74,  75 }, {  76,  77 }, {  78,  79 },
+	{  80,  81 }, {  82,  83 }, {  84,  85 }, {  86,  87 },
+	{  88,  89 }, {  90,  91 }, {  92,  93 }, {  94,  95 },
+	{  96,  97 }, {  98,  99 }, { 100, 101 }, { 102, 103 },
+	{ 104, 105 }, { 106, 107 }, { 108, 109 }, { 110, 111 },
+	{ 112, 113 }, { 114, 115 }, { 116, 117 }, { 118, 119 },
+	{ 120, 121 }, { 122, 123 }, { 124, 125 }, { 126, 127 },
+};
+
+/* K=8 code (rate 1/2) */
+const struct osmo_conv_code conv_k8 = {
+	.N = 2,
+	.K = 8,
+	.len = 180,
+	.next_output = conv_k8_next_output,
+	.next_state  = conv_k8_next_state,
+};
+
 /* Truncated code */
 const struct osmo_conv_code conv_trunc = {
 	.N = 2,
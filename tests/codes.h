@@ -25,6 +25,14 @@ const struct osmo_conv_code gsm_conv_tch_ahs_4_75;
 const struct osmo_conv_code wimax_conv_fch;
 const struct osmo_conv_code gmr1_conv_tch3_speech;
 const struct osmo_conv_code lte_conv_pbch;
+const struct osmo_conv_code umts_conv_bch;
+const struct osmo_conv_code umts_conv_dch;
+const struct osmo_conv_code conv_k3;
+const struct osmo_conv_code conv_k4;
+const struct osmo_conv_code conv_k6;
+const struct osmo_conv_code conv_k8;
+const struct osmo_conv_code wlan_conv_stream;
+const struct osmo_conv_code dvb_conv_stream;
 const struct osmo_conv_code conv_trunc;
 
 #endif /* CODES_H */
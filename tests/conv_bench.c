@@ -0,0 +1,410 @@
+/*
+ * Viterbi kernel microbenchmark
+ *
+ * Drives the per-step metric units and the traceback of the decoder on
+ * their own, pinned to one core with warm caches, and reports time stamp
+ * counter cycles per trellis step and per state.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <malloc.h>
+#include <sched.h>
+#include <time.h>
+#include <getopt.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include <osmocom/core/bits.h>
+#include <osmocom/core/conv.h>
+
+#include "codes.h"
+
+#define DEFAULT_STEPS		1024
+#define DEFAULT_WARMUP		100
+#define DEFAULT_REPS		1000
+#define MAX_STATES		256
+#define MAX_KERNEL_SETS		8
+
+/* Command line arguments
+ *     core   - CPU to pin to or -1 for the current CPU
+ *     steps  - Number of trellis steps per metric unit repetition
+ *     warmup - Number of untimed repetitions before measuring
+ *     reps   - Number of timed repetitions
+ *     simd   - SIMD kernel set name or NULL for automatic selection
+ *     all    - Benchmark every available kernel set
+ */
+struct bench_options {
+	int core;
+	int steps;
+	int warmup;
+	int reps;
+	const char *simd;
+	int all;
+};
+
+/* Benchmarked codes, one per constraint length and rate */
+struct bench_code {
+	const char *name;
+	const struct osmo_conv_code *code;
+};
+
+static const struct bench_code bench_codes[] = {
+	{ "GSM xCCH",         &gsm_conv_xcch },
+	{ "GSM TCH/AFS 10.2", &gsm_conv_tch_afs_10_2 },
+	{ "GSM TCH/AFS 6.7",  &gsm_conv_tch_afs_6_7 },
+	{ "WiMax FCH",        &wimax_conv_fch },
+	{ "GSM TCH/AFS 7.95", &gsm_conv_tch_afs_7_95 },
+	{ "GSM TCH/AFS 5.9",  &gsm_conv_tch_afs_5_9 },
+	{ NULL, NULL },
+};
+
+struct vdecoder;
+struct vdecoder *conv_decoder_create(const struct osmo_conv_code *code);
+int conv_decoder_run(struct vdecoder *dec,
+		     const sbit_t *input, ubit_t *output);
+void conv_decoder_free(struct vdecoder *dec);
+int conv_decoder_metric_unit(const struct vdecoder *dec,
+			     void (**unit)(const int8_t *, const int16_t *,
+					   int16_t *, int16_t *, int),
+			     const int16_t **table, int *intrvl);
+int conv_decoder_frame_unit(const struct vdecoder *dec,
+			    int (**unit)(const int8_t *, const int16_t *,
+					 int16_t *, int16_t *, int, int, int),
+			    const int16_t **table);
+int conv_decoder_traceback(struct vdecoder *dec, ubit_t *output);
+
+int conv_simd_select(const char *name);
+const char *conv_simd_current(void);
+const char *conv_simd_variant(int idx);
+
+/* Cycle counter
+ *     The time stamp counter on x86, fenced so that earlier instructions
+ *     retire before it is read. Elsewhere nanoseconds are counted instead.
+ */
+static uint64_t read_cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	_mm_lfence();
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a;
+	uint64_t y = *(const uint64_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+/* Pin the calling thread to a single CPU */
+static int pin_core(int core)
+{
+	cpu_set_t set;
+
+	if (core < 0)
+		core = sched_getcpu();
+	if (core < 0)
+		return -1;
+
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	if (sched_setaffinity(0, sizeof(set), &set) < 0)
+		return -1;
+
+	return core;
+}
+
+static void print_row(const char *label, const char *norm,
+		      uint64_t *cycles, int reps, int steps, int states)
+{
+	double med, min;
+
+	qsort(cycles, reps, sizeof(uint64_t), cmp_u64);
+	med = (double) cycles[reps / 2] / steps;
+	min = (double) cycles[0] / steps;
+
+	if (states)
+		printf("[..] %-24s %-4s %10.2f %10.3f %10.2f\n", label, norm,
+		       med, med / states, min);
+	else
+		printf("[..] %-24s %-4s %10.2f %10s %10.2f\n", label, norm,
+		       med, "-", min);
+}
+
+/* Time one metric unit over 'steps' trellis steps per repetition
+ *     Path metrics are reset before every repetition, outside the timed
+ *     region. Without normalization, 16-bit path metrics starting from zero
+ *     saturate after the normalization interval of the decoder, so callers
+ *     limit non-normalizing runs to that many steps.
+ */
+static void bench_unit(const struct bench_options *opt,
+		       void (*unit)(const int8_t *, const int16_t *,
+				    int16_t *, int16_t *, int),
+		       const int16_t *table, int n, int stride, int norm,
+		       int steps, const int8_t *seq, int16_t *sums,
+		       int16_t *paths, uint64_t *cycles)
+{
+	int i, r;
+	uint64_t t0;
+
+	for (r = -opt->warmup; r < opt->reps; r++) {
+		memset(sums, 0, sizeof(int16_t) * MAX_STATES);
+
+		t0 = read_cycles();
+		for (i = 0; i < steps; i++) {
+			unit(&seq[n * i], table, sums,
+			     &paths[i * stride], norm);
+		}
+		if (r >= 0)
+			cycles[r] = read_cycles() - t0;
+	}
+}
+
+/* Time a whole-frame unit over 'steps' trellis steps per repetition
+ *     The unit normalizes on the decoder interval itself, as it does in a
+ *     decoder run.
+ */
+static void bench_frame(const struct bench_options *opt,
+			int (*unit)(const int8_t *, const int16_t *,
+				    int16_t *, int16_t *, int, int, int),
+			const int16_t *table, int intrvl, const int8_t *seq,
+			int16_t *sums, int16_t *paths, uint64_t *cycles)
+{
+	int r;
+	uint64_t t0;
+
+	for (r = -opt->warmup; r < opt->reps; r++) {
+		memset(sums, 0, sizeof(int16_t) * MAX_STATES);
+
+		t0 = read_cycles();
+		unit(seq, table, sums, paths, opt->steps, intrvl, 0);
+		if (r >= 0)
+			cycles[r] = read_cycles() - t0;
+	}
+}
+
+static void bench_traceback(const struct bench_options *opt,
+			    struct vdecoder *dec, ubit_t *out,
+			    uint64_t *cycles)
+{
+	int r;
+	uint64_t t0;
+
+	for (r = -opt->warmup; r < opt->reps; r++) {
+		t0 = read_cycles();
+		conv_decoder_traceback(dec, out);
+		if (r >= 0)
+			cycles[r] = read_cycles() - t0;
+	}
+}
+
+static int bench_code(const struct bench_options *opt,
+		      const struct bench_code *bc)
+{
+	int i, stride, len, seq_len, ns, intrvl, steps;
+	int n = bc->code->N, k = bc->code->K;
+	char label[64];
+	int8_t *seq;
+	int16_t *sums, *paths;
+	ubit_t *out;
+	uint64_t *cycles;
+	struct vdecoder *dec;
+	const int16_t *table;
+	void (*unit)(const int8_t *, const int16_t *,
+		     int16_t *, int16_t *, int);
+	int (*frame)(const int8_t *, const int16_t *,
+		     int16_t *, int16_t *, int, int, int);
+
+	ns = 1 << (k - 1);
+	len = bc->code->len;
+	if (bc->code->term == CONV_TERM_FLUSH)
+		len += k - 1;
+
+	dec = conv_decoder_create(bc->code);
+	if (!dec) {
+		fprintf(stderr, "[!] Failed to create decoder for %s\n",
+			bc->name);
+		return -1;
+	}
+
+	stride = conv_decoder_metric_unit(dec, &unit, &table, &intrvl);
+	if (stride < 0) {
+		conv_decoder_free(dec);
+		return -1;
+	}
+
+	/* Random soft input for both the units and a decoded frame */
+	seq_len = (opt->steps > len ? opt->steps : len) * n;
+	seq = malloc(seq_len);
+	sums = memalign(32, sizeof(int16_t) * MAX_STATES);
+	paths = memalign(32, sizeof(int16_t) * stride * opt->steps);
+	out = malloc(len);
+	cycles = malloc(sizeof(uint64_t) * opt->reps);
+
+	for (i = 0; i < seq_len; i++)
+		seq[i] = (rand() % 255) - 127;
+
+	snprintf(label, sizeof(label), "gen_metrics_k%i_n%i", k, n);
+	bench_unit(opt, unit, table, n, stride, 1, opt->steps,
+		   seq, sums, paths, cycles);
+	print_row(label, "yes", cycles, opt->reps, opt->steps, ns);
+
+	steps = opt->steps < intrvl ? opt->steps : intrvl;
+	bench_unit(opt, unit, table, n, stride, 0, steps,
+		   seq, sums, paths, cycles);
+	print_row(label, "no", cycles, opt->reps, steps, ns);
+
+	/* K = 5 decoders run unpunctured spans with the whole-frame unit and
+	 * only call the per-step unit on steps with erased symbols */
+	if (conv_decoder_frame_unit(dec, &frame, &table) >= 0) {
+		snprintf(label, sizeof(label), "gen_frame_k%i_n%i", k, n);
+		bench_frame(opt, frame, table, intrvl, seq,
+			    sums, paths, cycles);
+		print_row(label, "int", cycles, opt->reps, opt->steps, ns);
+	}
+
+	/* Traceback over the decisions of a decoded random frame */
+	conv_decoder_run(dec, seq, out);
+	snprintf(label, sizeof(label), "traceback_k%i_n%i", k, n);
+	bench_traceback(opt, dec, out, cycles);
+	print_row(label, "", cycles, opt->reps, len, 0);
+
+	free(cycles);
+	free(out);
+	free(paths);
+	free(sums);
+	free(seq);
+	conv_decoder_free(dec);
+
+	return 0;
+}
+
+static int bench_kernels(const struct bench_options *opt)
+{
+	const struct bench_code *bc;
+
+	printf("[+] Kernel set: %s\n", conv_simd_current());
+	printf("[..] %-24s %-4s %10s %10s %10s\n", "Unit", "Norm",
+	       "cyc/step", "cyc/state", "min/step");
+
+	for (bc = bench_codes; bc->name; bc++) {
+		if (bench_code(opt, bc) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static void print_help()
+{
+	fprintf(stdout, "Options:\n"
+		"  -h    This text\n"
+		"  -c    CPU core to pin to (default current core)\n"
+		"  -n    Trellis steps per metric unit repetition (default %i)\n"
+		"  -w    Warm-up repetitions (default %i)\n"
+		"  -r    Timed repetitions (default %i)\n"
+		"  -k    Select SIMD kernel set ('all' to run each available)\n",
+		DEFAULT_STEPS, DEFAULT_WARMUP, DEFAULT_REPS);
+}
+
+static void handle_options(int argc, char **argv, struct bench_options *opt)
+{
+	int option;
+
+	opt->core = -1;
+	opt->steps = DEFAULT_STEPS;
+	opt->warmup = DEFAULT_WARMUP;
+	opt->reps = DEFAULT_REPS;
+	opt->simd = NULL;
+	opt->all = 0;
+
+	while ((option = getopt(argc, argv, "hc:n:w:r:k:")) != -1) {
+		switch (option) {
+		case 'c':
+			opt->core = atoi(optarg);
+			break;
+		case 'n':
+			opt->steps = atoi(optarg);
+			break;
+		case 'w':
+			opt->warmup = atoi(optarg);
+			break;
+		case 'r':
+			opt->reps = atoi(optarg);
+			break;
+		case 'k':
+			if (!strcmp(optarg, "all"))
+				opt->all = 1;
+			else
+				opt->simd = optarg;
+			break;
+		case 'h':
+		default:
+			print_help();
+			exit(0);
+		}
+	}
+
+	if ((opt->steps < 1) || (opt->warmup < 0) || (opt->reps < 1)) {
+		printf("Steps and repetitions must be at least 1\n");
+		exit(0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int i, core;
+	const char *name;
+	struct bench_options opt;
+
+	handle_options(argc, argv, &opt);
+
+	if (opt.simd && conv_simd_select(opt.simd) < 0) {
+		fprintf(stderr, "[!] SIMD kernel set '%s' not available\n",
+			opt.simd);
+		return -1;
+	}
+
+	core = pin_core(opt.core);
+	if (core < 0) {
+		fprintf(stderr, "[!] Failed to pin to core %i\n", opt.core);
+		return -1;
+	}
+
+	srand(1);
+
+#if defined(__i386__) || defined(__x86_64__)
+	printf("[+] Time stamp counter cycles on core %i\n", core);
+#else
+	printf("[+] Nanoseconds on core %i\n", core);
+#endif
+	printf("[+] %i steps, %i warm-up and %i timed repetitions\n",
+	       opt.steps, opt.warmup, opt.reps);
+
+	if (!opt.all)
+		return bench_kernels(&opt) < 0 ? -1 : 0;
+
+	for (i = 0; i < MAX_KERNEL_SETS; i++) {
+		name = conv_simd_variant(i);
+		if (!name)
+			break;
+
+		conv_simd_select(name);
+		if (bench_kernels(&opt) < 0)
+			return -1;
+	}
+
+	return 0;
+}
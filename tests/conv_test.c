@@ -1,10 +1,23 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <malloc.h>
+#include <math.h>
 #include <time.h>
 #include <sys/time.h>
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <getopt.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 #include <osmocom/core/bits.h>
 #include <osmocom/core/conv.h>
@@ -17,9 +30,29 @@
 #define MAX_LEN_BYTES		(9182/8)
 #define DEFAULT_ITER		10000
 #define DEFAULT_THREADS		1
-#define MAX_THREADS		32
+#define MAX_KERNEL_SETS		8
 #define MAX_CODES		2048
 
+/* Number of random bursts compared between packed and unpacked encoders
+ * and the widest bit-sliced encoder batch
+ */
+#define PACKED_ITER		100
+#define ENC_BATCH_MAX		256
+
+/* Number of full-scale bursts compared between 8-bit and 16-bit path
+ * metrics and the frame errors the 8-bit decoder may add
+ */
+#define FULL_SCALE_ITER		200
+#define FULL_SCALE_MARGIN	4
+
+/* Windowed stream decoder test
+ *     Number of streams per test and largest input chunk passed to the
+ *     decoder at once. Decision depths are multiples of K.
+ */
+#define STREAM_ITER		10
+#define STREAM_MAX_CHUNK	4096
+#define STREAM_NUM_DEPTHS	3
+
 /* Parameters for soft symbol generation
  *     Signal-to-noise ratio specified in dB and symbol amplitude, which has a
  *     valid range from 0 (no signal) to 127 (saturation).
@@ -27,6 +60,29 @@
 #define DEFAULT_SOFT_SNR	8.0
 #define DEFAULT_SOFT_AMP	32.0
 
+/* Benchmark input and latency report
+ *     Each benchmark thread cycles through a set of pre-generated noisy
+ *     frames at the test SNR. Every decode call is timed and latencies are
+ *     reported as percentiles and a histogram with log spaced buckets.
+ */
+#define BENCH_FRAMES		64
+#define LAT_BUCKETS		10
+#define LAT_BAR_WIDTH		40
+#define LAT_POINTS		5
+
+/* Baseline comparison defaults
+ *     Allowed throughput drop and BER/FER rise in percent. BER and FER
+ *     are also allowed one more error event than the baseline rate.
+ */
+#define DEFAULT_TOLERANCE	5.0
+#define DEFAULT_BER_TOLERANCE	20.0
+
+#ifdef CLOCK_MONOTONIC_RAW
+#define BENCH_CLOCK		CLOCK_MONOTONIC_RAW
+#else
+#define BENCH_CLOCK		CLOCK_MONOTONIC
+#endif
+
 /* Command line arguments
  *     iter     - Number of iterations
  *     threads  - Number of concurrent threads to launch for benchmark test
@@ -34,7 +90,29 @@
  *     length   - Enable length checks
  *     skip     - Skip baseline comparison
  *     ber      - Enable the bit-error-rate test
+ *     stream   - Enable the windowed stream decoder test
  *     num      - Run code number if specified 
+ *     simd     - SIMD kernel set name or NULL for automatic selection
+ *     simd_all - Benchmark every available SIMD kernel set
+ *     batch    - Number of frames per batch decode or 0 to disable
+ *     metric8  - Also test the decoder with 8-bit path metrics
+ *     modulo   - Also test the decoder with modulo path metrics
+ *     packed   - Also test the decoder with packed output
+ *     exchange - Also test the decoder with register exchange survivors
+ *     generic  - Also test the generic path of specialized decoders
+ *     encode   - Enable the encoder benchmark
+ *     allocs   - Also test the workspace decoder and count heap
+ *                allocations in the benchmark decode loops
+ *     sweep    - Run the thread scaling sweep up to this many threads
+ *     pin      - Benchmark thread placement policy
+ *     fifo     - Run benchmark threads with SCHED_FIFO priority
+ *     json     - File to write results to as JSON, '-' for stdout
+ *     csv      - File to write results to as CSV, '-' for stdout
+ *     baseline - Result file to compare against
+ *     tol      - Allowed throughput drop against the baseline in percent
+ *     ber_tol  - Allowed BER and FER rise against the baseline in percent
+ *     missing  - Allow results that have no baseline record
+ *     counters - Read hardware performance counters in the benchmarks
  */
 struct cmd_options {
 	int iter;
@@ -44,27 +122,234 @@ struct cmd_options {
 	int skip;
 	int base;
 	int ber;
+	int stream;
 	int num;
 	float snr;
+	const char *simd;
+	int simd_all;
+	int batch;
+	int metric8;
+	int modulo;
+	int packed;
+	int exchange;
+	int generic;
+	int encode;
+	int allocs;
+	int sweep;
+	int pin;
+	int fifo;
+	const char *json;
+	const char *csv;
+	const char *baseline;
+	float tol;
+	float ber_tol;
+	int missing;
+	int counters;
+};
+
+/* Decoder under test
+ *     DEC_BASE    - Baseline libosmocore decoder
+ *     DEC_SIMD    - All-in-one decoder call
+ *     DEC_PERSIST - Persistent decoder reused across all bursts
+ *     DEC_BATCH   - Batch decoder running several bursts in lockstep
+ *     DEC_METRIC8 - Persistent decoder with 8-bit path metrics
+ *     DEC_MODULO  - Persistent decoder with modulo path metrics
+ *     DEC_PACKED  - Persistent decoder with packed output
+ *     DEC_EXCHANGE - Persistent decoder with register exchange survivors
+ *     DEC_GENERIC - Persistent decoder with specializations disabled
+ *     DEC_WORKSPACE - All-in-one decoder call with a caller workspace
+ */
+enum dec_type {
+	DEC_BASE,
+	DEC_SIMD,
+	DEC_PERSIST,
+	DEC_BATCH,
+	DEC_METRIC8,
+	DEC_MODULO,
+	DEC_PACKED,
+	DEC_EXCHANGE,
+	DEC_GENERIC,
+	DEC_WORKSPACE,
+};
+
+static const char *dec_names[] = {
+	[DEC_BASE]	= "base",
+	[DEC_SIMD]	= "simd",
+	[DEC_PERSIST]	= "persistent",
+	[DEC_BATCH]	= "batch",
+	[DEC_METRIC8]	= "8bit",
+	[DEC_MODULO]	= "modulo",
+	[DEC_PACKED]	= "packed",
+	[DEC_EXCHANGE]	= "exchange",
+	[DEC_GENERIC]	= "generic",
+	[DEC_WORKSPACE]	= "workspace",
 };
 
-/* Argument passing struct for benchmark threads */
+/* Benchmark thread placement
+ *     PIN_NONE    - Leave placement to the scheduler
+ *     PIN_COMPACT - Fill each physical core, SMT siblings included, in turn
+ *     PIN_SCATTER - Spread over packages and physical cores before using
+ *                   any SMT sibling
+ *     PIN_CORE    - One thread per physical core, SMT siblings unused
+ */
+enum pin_policy {
+	PIN_NONE,
+	PIN_COMPACT,
+	PIN_SCATTER,
+	PIN_CORE,
+};
+
+static const char *pin_names[] = {
+	[PIN_NONE]	= "none",
+	[PIN_COMPACT]	= "compact",
+	[PIN_SCATTER]	= "scatter",
+	[PIN_CORE]	= "core",
+};
+
+/* Logical CPU and its place in the package and core topology
+ *     thread - Rank among the SMT siblings of its physical core
+ */
+struct cpu_info {
+	int cpu;
+	int package;
+	int core;
+	int thread;
+};
+
+/* Hardware performance counters
+ *     HW_CYCLES      - CPU cycles
+ *     HW_INSTR       - Retired instructions
+ *     HW_L1D_MISS    - L1 data cache read misses
+ *     HW_CACHE_MISS  - Last level cache misses
+ *     HW_BRANCH_MISS - Mispredicted branches
+ */
+enum hw_counter {
+	HW_CYCLES,
+	HW_INSTR,
+	HW_L1D_MISS,
+	HW_CACHE_MISS,
+	HW_BRANCH_MISS,
+	HW_NUM,
+};
+
+static const char *hw_names[HW_NUM] = {
+	[HW_CYCLES]	 = "Cycles",
+	[HW_INSTR]	 = "Instructions",
+	[HW_L1D_MISS]	 = "L1D misses",
+	[HW_CACHE_MISS]	 = "Cache misses",
+	[HW_BRANCH_MISS] = "Branch misses",
+};
+
+/* Argument passing struct for benchmark threads
+ *     frames  - Pre-generated noisy input frames
+ *     lat     - Latency of each decode call in nanoseconds
+ *     num_lat - Number of recorded latencies
+ *     cpu     - CPU the thread is pinned to or -1
+ *     prio    - Result of the SCHED_FIFO request, if made
+ *     hw      - Hardware counter totals of the decode loop or NAN
+ */
 struct benchmark_thread_arg {
 	const struct conv_test_vector *tst;
 	struct osmo_conv_code *code;
-	int base;
+	struct vdecoder *dec;
+	struct vbatch *batch;
+	enum dec_type type;
+	int width;
 	int iter;
 	int err;
+	void *ws;
+	size_t ws_len;
+	unsigned long allocs;
+	sbit_t *frames;
+	unsigned long *lat;
+	int num_lat;
+	int cpu;
+	int prio;
+	double hw[HW_NUM];
 };
 
 /* Convolutional encoder (uses generator polynomials - not API compatible) */
 int test_conv_encode(const struct osmo_conv_code *code,
 		     const unsigned rgen, const unsigned *gen,
 		     const ubit_t *input, ubit_t *output);
+int conv_encode_workspace_size(const struct osmo_conv_code *code);
+int test_conv_encode_ws(const struct osmo_conv_code *code,
+			const unsigned rgen, const unsigned *gen,
+			const ubit_t *input, ubit_t *output,
+			void *ws, size_t size);
+
+/* Table driven encoder on packed bits */
+struct vencoder;
+struct vencoder *conv_encoder_create(const struct osmo_conv_code *code,
+				     const unsigned rgen, const unsigned *gen);
+int conv_encoder_run(struct vencoder *enc,
+		     const pbit_t *input, pbit_t *output);
+void conv_encoder_free(struct vencoder *enc);
+
+/* Bit-sliced batch encoder */
+struct vencbatch;
+struct vencbatch *conv_encoder_batch_create(const struct osmo_conv_code *code,
+					    const unsigned rgen,
+					    const unsigned *gen, int width);
+int conv_encoder_batch_run(struct vencbatch *batch,
+			   const pbit_t * const *input, pbit_t **output);
+void conv_encoder_batch_free(struct vencbatch *batch);
 
 /* API drop-in replacement */
 int test_conv_decode(const struct osmo_conv_code *code,
 		     const sbit_t *input, ubit_t *output);
+int test_conv_decode_packed(const struct osmo_conv_code *code,
+			    const sbit_t *input, pbit_t *output, int lsb);
+
+/* Persistent decoder */
+struct vdecoder;
+struct vdecoder *conv_decoder_create(const struct osmo_conv_code *code);
+int conv_decoder_run(struct vdecoder *dec,
+		     const sbit_t *input, ubit_t *output);
+void conv_decoder_free(struct vdecoder *dec);
+int conv_decoder_run_packed(struct vdecoder *dec, const sbit_t *input,
+			    pbit_t *output, int lsb);
+int conv_decoder_set_exchange(struct vdecoder *dec, int enable);
+int conv_decoder_set_specialized(struct vdecoder *dec, int enable);
+struct vdecoder *conv_decoder_create_i8(const struct osmo_conv_code *code);
+int conv_decoder_saturated(const struct vdecoder *dec);
+struct vdecoder *conv_decoder_create_mod(const struct osmo_conv_code *code);
+int conv_decoder_set_max_iter(struct vdecoder *dec, int max_iter);
+int conv_decoder_iterations(const struct vdecoder *dec);
+
+/* Decoder in a caller provided workspace */
+int conv_decoder_workspace_size(const struct osmo_conv_code *code);
+struct vdecoder *conv_decoder_init(void *ws, size_t size,
+				   const struct osmo_conv_code *code);
+int test_conv_decode_ws(const struct osmo_conv_code *code,
+			const sbit_t *input, ubit_t *output,
+			void *ws, size_t size);
+
+/* Windowed stream decoder */
+struct vwindow;
+struct vwindow *conv_window_create(const struct osmo_conv_code *code,
+				   int depth);
+int conv_window_push(struct vwindow *win, const sbit_t *input,
+		     int steps, ubit_t *output);
+int conv_window_flush(struct vwindow *win, ubit_t *output);
+void conv_window_free(struct vwindow *win);
+
+/* Batch decoder */
+struct vbatch;
+struct vbatch *conv_batch_create(const struct osmo_conv_code *code,
+				 int width);
+int conv_batch_run(struct vbatch *batch, const sbit_t * const *input,
+		   ubit_t **output);
+void conv_batch_free(struct vbatch *batch);
+
+/* Runtime SIMD kernel selection */
+int conv_simd_select(const char *name);
+const char *conv_simd_current(void);
+const char *conv_simd_variant(int idx);
+
+/* Shared trellis cache */
+void conv_trellis_cache_stats(unsigned long *hits, unsigned long *misses);
+void conv_trellis_cache_flush(void);
 
 struct conv_test_vector {
 	const char *name;
@@ -79,7 +364,26 @@ struct conv_test_vector {
 	pbit_t vec_out[MAX_LEN_BYTES];
 };
 
-static void enable_prio(float prio)
+/* Continuous stream codes for windowed decoding */
+struct stream_test_vector {
+	const char *name;
+	const char *spec;
+	const struct osmo_conv_code *code;
+	unsigned rgen;
+	unsigned gen[4];
+};
+
+/* Benchmark thread scheduling
+ *     Threads only ask for SCHED_FIFO priority when 'fifo_prio' is set and
+ *     are pinned to 'pin_cpus' in the order of 'pin_policy', wrapping
+ *     around when there are more threads than CPUs.
+ */
+static int fifo_prio;
+static enum pin_policy pin_policy;
+static struct cpu_info *pin_cpus;
+static int num_pin_cpus;
+
+static int enable_prio(float prio)
 {
     int min, max;
     struct sched_param param;
@@ -93,9 +397,275 @@ static void enable_prio(float prio)
     min = sched_get_priority_min(SCHED_FIFO);
     sched_getparam(0, &param);
     param.sched_priority = (int) ((max - min) * prio + min);
-    sched_setscheduler(0, SCHED_FIFO, &param);
+    return sched_setscheduler(0, SCHED_FIFO, &param);
+}
+
+/* Read a topology attribute of a CPU or return -1 if not available */
+static int read_topology(int cpu, const char *name)
+{
+	int val = -1;
+	char path[128];
+	FILE *fp;
+
+	snprintf(path, sizeof(path),
+		 "/sys/devices/system/cpu/cpu%i/topology/%s", cpu, name);
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return -1;
+	if (fscanf(fp, "%i", &val) != 1)
+		val = -1;
+	fclose(fp);
+
+	return val;
+}
+
+/* Packages, then physical cores, then SMT siblings */
+static int cmp_compact(const void *a, const void *b)
+{
+	const struct cpu_info *x = a, *y = b;
+
+	if (x->package != y->package)
+		return x->package - y->package;
+	if (x->core != y->core)
+		return x->core - y->core;
+	return x->thread - y->thread;
+}
+
+/* SMT siblings, then physical cores, then packages */
+static int cmp_scatter(const void *a, const void *b)
+{
+	const struct cpu_info *x = a, *y = b;
+
+	if (x->thread != y->thread)
+		return x->thread - y->thread;
+	if (x->core != y->core)
+		return x->core - y->core;
+	return x->package - y->package;
+}
+
+/* Order the CPUs this process may run on for a placement policy
+ *     Without sysfs topology each CPU is taken as its own physical core.
+ *     Returns the number of CPUs or -1 on error.
+ */
+static int pin_cpu_list(enum pin_policy pin, struct cpu_info **list)
+{
+	int i, j, n = 0;
+	cpu_set_t set;
+	struct cpu_info *cpus;
+
+	if (sched_getaffinity(0, sizeof(set), &set) < 0)
+		return -1;
+
+	cpus = malloc(sizeof(struct cpu_info) * CPU_COUNT(&set));
+	if (!cpus)
+		return -1;
+
+	for (i = 0; i < CPU_SETSIZE; i++) {
+		if (!CPU_ISSET(i, &set))
+			continue;
+
+		cpus[n].cpu = i;
+		cpus[n].package = read_topology(i, "physical_package_id");
+		cpus[n].core = read_topology(i, "core_id");
+		if (cpus[n].core < 0)
+			cpus[n].core = i;
+		cpus[n].thread = 0;
+
+		for (j = 0; j < n; j++) {
+			if ((cpus[j].package == cpus[n].package) &&
+			    (cpus[j].core == cpus[n].core))
+				cpus[n].thread++;
+		}
+		n++;
+	}
+
+	if (pin == PIN_CORE) {
+		for (i = 0, j = 0; i < n; i++) {
+			if (!cpus[i].thread)
+				cpus[j++] = cpus[i];
+		}
+		n = j;
+	}
+
+	qsort(cpus, n, sizeof(struct cpu_info),
+	      pin == PIN_SCATTER ? cmp_scatter : cmp_compact);
+
+	*list = cpus;
+
+	return n;
+}
+
+/* Hardware counter access
+ *     Each benchmark thread opens its own counters for user space only and
+ *     counts its decode loop, including the per-call timestamps. Counters
+ *     the kernel or CPU does not provide read as NAN. Counts are scaled up
+ *     when the kernel multiplexed them.
+ */
+static int hw_counters;
+
+#ifdef __linux__
+static const struct {
+	uint32_t type;
+	uint64_t config;
+} hw_events[HW_NUM] = {
+	[HW_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	[HW_INSTR] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	[HW_L1D_MISS] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+			  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+	[HW_CACHE_MISS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	[HW_BRANCH_MISS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+/* Open a disabled counter for the calling thread or return -errno */
+static int hw_open(enum hw_counter c)
+{
+	int fd;
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = hw_events[c].type;
+	attr.config = hw_events[c].config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+			   PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+	return fd < 0 ? -errno : fd;
+}
+
+static void hw_start(int *fds)
+{
+	int i;
+
+	for (i = 0; i < HW_NUM; i++) {
+		fds[i] = hw_open(i);
+		if (fds[i] >= 0) {
+			ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+static void hw_stop(int *fds, double *counts)
+{
+	int i;
+	uint64_t val[3];
+
+	for (i = 0; i < HW_NUM; i++) {
+		if (fds[i] >= 0)
+			ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+	}
+
+	for (i = 0; i < HW_NUM; i++) {
+		counts[i] = NAN;
+		if (fds[i] < 0)
+			continue;
+
+		if ((read(fds[i], val, sizeof(val)) == sizeof(val)) && val[2])
+			counts[i] = (double) val[0] * val[1] / val[2];
+		close(fds[i]);
+	}
+}
+
+/* Check that the cycle counter can be opened at all */
+static int hw_probe(void)
+{
+	int fd = hw_open(HW_CYCLES);
+
+	if (fd < 0)
+		return fd;
+	close(fd);
+
+	return 0;
+}
+#else
+static void hw_start(int *fds)
+{
+}
+
+static void hw_stop(int *fds, double *counts)
+{
+	int i;
+
+	for (i = 0; i < HW_NUM; i++)
+		counts[i] = NAN;
+}
+
+static int hw_probe(void)
+{
+	return -ENOSYS;
+}
+#endif
+
+/* Heap allocation counting
+ *     The allocator entry points are interposed and forwarded to glibc.
+ *     Allocations are counted per thread while 'alloc_count_on' is set,
+ *     which the benchmark threads do around the decode loop only.
+ */
+static int alloc_check;
+static __thread int alloc_count_on;
+static __thread unsigned long alloc_count;
+
+#ifdef __GLIBC__
+#define ALLOC_COUNT_SUPPORTED	1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+
+void *malloc(size_t size)
+{
+	alloc_count += alloc_count_on;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+	alloc_count += alloc_count_on;
+	return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	alloc_count += alloc_count_on;
+	return __libc_realloc(ptr, size);
 }
 
+void *memalign(size_t align, size_t size)
+{
+	alloc_count += alloc_count_on;
+	return __libc_memalign(align, size);
+}
+
+void *aligned_alloc(size_t align, size_t size)
+{
+	alloc_count += alloc_count_on;
+	return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **ptr, size_t align, size_t size)
+{
+	void *p;
+
+	alloc_count += alloc_count_on;
+	p = __libc_memalign(align, size);
+	if (!p)
+		return ENOMEM;
+
+	*ptr = p;
+	return 0;
+}
+#else
+#define ALLOC_COUNT_SUPPORTED	0
+#endif
+
 const struct conv_test_vector tests[] = {
 	{
 		.name = "GSM xCCH",
@@ -355,6 +925,78 @@ const struct conv_test_vector tests[] = {
 		.vec_in  = { },
 		.vec_out = { },
 	},
+	{
+		.name = "UMTS BCH",
+		.spec = "(N=2, K=9, non-recursive, flushed, not punctured)",
+		.code = &umts_conv_bch,
+		.rgen = 0,
+		.gen = { 0561, 0753 },
+		.in_len  = 262,
+		.out_len = 540,
+		.has_vec = 0,
+		.vec_in  = { },
+		.vec_out = { },
+	},
+	{
+		.name = "UMTS DCH",
+		.spec = "(N=3, K=9, non-recursive, flushed, not punctured)",
+		.code = &umts_conv_dch,
+		.rgen = 0,
+		.gen = { 0557, 0663, 0711 },
+		.in_len  = 244,
+		.out_len = 756,
+		.has_vec = 0,
+		.vec_in  = { },
+		.vec_out = { },
+	},
+	{
+		.name = "K=3 Code",
+		.spec = "(N=2, K=3, non-recursive, flushed, not punctured)",
+		.code = &conv_k3,
+		.rgen = 0,
+		.gen = { 05, 07 },
+		.in_len  = 100,
+		.out_len = 204,
+		.has_vec = 0,
+		.vec_in  = { },
+		.vec_out = { },
+	},
+	{
+		.name = "K=4 Code",
+		.spec = "(N=3, K=4, non-recursive, tail-biting, not punctured)",
+		.code = &conv_k4,
+		.rgen = 0,
+		.gen = { 013, 015, 017 },
+		.in_len  = 60,
+		.out_len = 180,
+		.has_vec = 0,
+		.vec_in  = { },
+		.vec_out = { },
+	},
+	{
+		.name = "K=6 Code",
+		.spec = "(N=4, K=6, non-recursive, flushed, not punctured)",
+		.code = &conv_k6,
+		.rgen = 0,
+		.gen = { 053, 067, 071, 075 },
+		.in_len  = 120,
+		.out_len = 500,
+		.has_vec = 0,
+		.vec_in  = { },
+		.vec_out = { },
+	},
+	{
+		.name = "K=8 Code",
+		.spec = "(N=2, K=8, non-recursive, flushed, not punctured)",
+		.code = &conv_k8,
+		.rgen = 0,
+		.gen = { 0247, 0371 },
+		.in_len  = 180,
+		.out_len = 374,
+		.has_vec = 0,
+		.vec_in  = { },
+		.vec_out = { },
+	},
 	{
 		.name = "Random Code",
 		.spec = "(N=2, K=5, non-recursive, truncated, non-punctured)",
@@ -370,6 +1012,24 @@ const struct conv_test_vector tests[] = {
 	{ /* end */ },
 };
 
+const struct stream_test_vector streams[] = {
+	{
+		.name = "IEEE 802.11",
+		.spec = "(N=2, K=7, non-recursive, flushed, stream)",
+		.code = &wlan_conv_stream,
+		.rgen = 0,
+		.gen = { 0133, 0171 },
+	},
+	{
+		.name = "DVB-S",
+		.spec = "(N=2, K=7, non-recursive, truncated, stream)",
+		.code = &dvb_conv_stream,
+		.rgen = 0,
+		.gen = { 0171, 0133 },
+	},
+	{ /* end */ },
+};
+
 static void print_codes()
 {
 	int i = 1;
@@ -382,6 +1042,17 @@ static void print_codes()
 	printf("\n");
 }
 
+static void print_simd_variants()
+{
+	int i;
+	const char *name;
+
+	printf("\n");
+	for (i = 0; (name = conv_simd_variant(i)); i++)
+		printf("SIMD %i:  %s\n", i, name);
+	printf("\n");
+}
+
 static void fill_random(ubit_t *b, int n)
 {
 	int i, r, m, c;
@@ -437,10 +1108,97 @@ static int ubit_to_xerr(sbit_t *dst, ubit_t *src, int n, float snr)
 	return err;
 }
 
+/* Machine-readable result record
+ *     test   - "ber", "stream", "bench", "sweep" or "encode"
+ *     engine - Decoder or encoder under test
+ *     simd   - Kernel set selected while running
+ *     bits   - Decoded bits per burst
+ *     lat    - Latency p50, p90, p99, p99.9 and maximum in microseconds
+ *     Values that do not apply to a test are NAN.
+ */
+struct result {
+	char test[8];
+	char code[32];
+	int k;
+	int n;
+	char engine[32];
+	char simd[32];
+	int threads;
+	int iter;
+	int bits;
+	double mbps;
+	double lat[LAT_POINTS];
+	double ber;
+	double fer;
+};
+
+static const char *lat_fields[LAT_POINTS] = {
+	"p50_us", "p90_us", "p99_us", "p999_us", "max_us",
+};
+
+/* Results of this run in the order they were measured */
+static struct result *results;
+static int num_results;
+
+/* Append a result record with all values set to NAN
+ *     Returns NULL if the record could not be stored, in which case the
+ *     result is only printed.
+ */
+static struct result *add_record(const char *test, const char *name,
+				 const struct osmo_conv_code *code, int bits,
+				 const char *engine, int threads, int iter)
+{
+	int i;
+	struct result *res;
+
+	if (!(num_results & (num_results - 1))) {
+		res = realloc(results, sizeof(struct result) *
+			      (num_results ? num_results * 2 : 16));
+		if (!res)
+			return NULL;
+		results = res;
+	}
+
+	res = &results[num_results++];
+	snprintf(res->test, sizeof(res->test), "%s", test);
+	snprintf(res->code, sizeof(res->code), "%s", name);
+	snprintf(res->engine, sizeof(res->engine), "%s", engine);
+	snprintf(res->simd, sizeof(res->simd), "%s", conv_simd_current());
+	res->k = code->K;
+	res->n = code->N;
+	res->threads = threads;
+	res->iter = iter;
+	res->bits = bits;
+	res->mbps = NAN;
+	res->ber = NAN;
+	res->fer = NAN;
+	for (i = 0; i < LAT_POINTS; i++)
+		res->lat[i] = NAN;
+
+	return res;
+}
+
+static struct result *add_result(const char *test,
+				 const struct conv_test_vector *tst,
+				 const char *engine, int threads, int iter)
+{
+	return add_record(test, tst->name, tst->code, tst->in_len,
+			  engine, threads, iter);
+}
+
 /* Output error input/output error rates */
 static void print_error_results(const struct conv_test_vector *tst,
+				const char *engine,
 				int iber, int ober, int fer, int iter)
 {
+	struct result *res;
+
+	res = add_result("ber", tst, engine, 1, iter);
+	if (res) {
+		res->ber = (double) ober / (iter * tst->out_len);
+		res->fer = (double) fer / iter;
+	}
+
 	printf("[..] Input BER.......................... %f\n",
 	       (float) iber / (iter * tst->out_len));
 	printf("[..] Output BER......................... %f\n",
@@ -454,43 +1212,112 @@ static void print_error_results(const struct conv_test_vector *tst,
 }
 
 /* Timed performance benchmark */
+static void print_timed_results(double elapsed,
+				const struct conv_test_vector *tst,
+				int iter, int threads)
+{
+	printf("[..] Elapsed time....................... %f secs\n", elapsed);
+	printf("[..] Rate............................... %f Mbps\n",
+	       (float) threads * tst->in_len * iter / elapsed / 1e6);
+}
+
+/* Timed encoder benchmark, recorded as an 'encode' result */
 static double get_timed_results(struct timeval *tv0, struct timeval *tv1,
 			        const struct conv_test_vector *tst,
-				int iter, int threads)
+				int iter, int threads, const char *engine)
 {
 	double elapsed;
+	struct result *res;
 
 	elapsed = (tv1->tv_sec - tv0->tv_sec);
 	elapsed += (tv1->tv_usec - tv0->tv_usec) / 1e6;
-	printf("[..] Elapsed time....................... %f secs\n", elapsed);
-	printf("[..] Rate............................... %f Mbps\n",
-	       (float) threads * tst->in_len * iter / elapsed / 1e6);
+	print_timed_results(elapsed, tst, iter, threads);
+
+	res = add_result("encode", tst, engine, threads, iter);
+	if (res)
+		res->mbps = (double) threads * tst->in_len * iter /
+			    elapsed / 1e6;
 
 	return elapsed;
 }
 
+/* Shared trellis cache usage */
+static void print_cache_stats(void)
+{
+	unsigned long hits, misses;
+
+	conv_trellis_cache_stats(&hits, &misses);
+	printf("[+] Trellis cache: %lu hits, %lu misses\n", hits, misses);
+}
+
 /* Bit error rate test */
 static int error_test(const struct conv_test_vector *tst,
-		      int iter, float snr, int base)
+		      int iter, float snr, enum dec_type type)
 {
-	int i, n, l, iber = 0, ober = 0, fer = 0;
+	int i, n, l, iber = 0, ober = 0, fer = 0, sat = 0, iters = 0, max = 0;
+	int ws_len = 0, enc_len = 0;
 	sbit_t *bs;
 	ubit_t *bu0, *bu1;
+	pbit_t *bp;
+	void *ws = NULL, *enc_ws = NULL;
+	struct vdecoder *dec = NULL;
 	int (*decode) (const struct osmo_conv_code *, const sbit_t *, ubit_t *);
 
 	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
 	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
 	bs  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+	bp  = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+
+	/* Workspaces are allocated once and reused for every frame */
+	if (type == DEC_WORKSPACE) {
+		ws_len = conv_decoder_workspace_size(tst->code);
+		enc_len = conv_encode_workspace_size(tst->code);
+		if ((ws_len < 0) || (enc_len < 0)) {
+			fprintf(stderr, "[!] Failed workspace size query\n");
+			return -1;
+		}
+		ws = memalign(32, ws_len);
+		enc_ws = malloc(enc_len);
+	}
 
-	if (base)
+	if (type == DEC_BASE)
 		decode = osmo_conv_decode;
 	else
 		decode = test_conv_decode;
 
+	if ((type == DEC_PERSIST) || (type == DEC_PACKED) ||
+	    (type == DEC_EXCHANGE) || (type == DEC_GENERIC))
+		dec = conv_decoder_create(tst->code);
+	else if (type == DEC_METRIC8)
+		dec = conv_decoder_create_i8(tst->code);
+	else if (type == DEC_MODULO)
+		dec = conv_decoder_create_mod(tst->code);
+
+	if ((type == DEC_PERSIST || type == DEC_METRIC8 ||
+	     type == DEC_MODULO || type == DEC_PACKED ||
+	     type == DEC_EXCHANGE || type == DEC_GENERIC) && !dec) {
+		fprintf(stderr, "[!] Failed to create decoder\n");
+		return -1;
+	}
+
+	if ((type == DEC_EXCHANGE) && (conv_decoder_set_exchange(dec, 1) < 0)) {
+		fprintf(stderr, "[!] Failed to enable register exchange\n");
+		conv_decoder_free(dec);
+		return -1;
+	}
+
+	if (type == DEC_GENERIC)
+		conv_decoder_set_specialized(dec, 0);
+
 	for (i = 0; i < iter; i++) {
 		fill_random(bu0, tst->in_len);
 
-		l = test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
+		if (type == DEC_WORKSPACE)
+			l = test_conv_encode_ws(tst->code, tst->rgen, tst->gen,
+						bu0, bu1, enc_ws, enc_len);
+		else
+			l = test_conv_encode(tst->code, tst->rgen, tst->gen,
+					     bu0, bu1);
 		if (l != tst->out_len) {
 			printf("ERROR !\n");
 			fprintf(stderr, "[!] Failed encoding length check (%i)\n",
@@ -499,7 +1326,31 @@ static int error_test(const struct conv_test_vector *tst,
 		}
 
 		iber += ubit_to_err(bs, bu1, l, snr);
-		decode(tst->code, bs, bu1);
+
+		if (type == DEC_PACKED) {
+			conv_decoder_run_packed(dec, bs, bp, 0);
+			osmo_pbit2ubit(bu1, bp, tst->in_len);
+		} else if (dec) {
+			conv_decoder_run(dec, bs, bu1);
+		} else if (type == DEC_WORKSPACE) {
+			if (test_conv_decode_ws(tst->code, bs, bu1,
+						ws, ws_len) < 0) {
+				fprintf(stderr, "[!] Workspace decode failed\n");
+				return -1;
+			}
+		} else {
+			decode(tst->code, bs, bu1);
+		}
+
+		if (type == DEC_METRIC8)
+			sat += conv_decoder_saturated(dec);
+
+		if (dec) {
+			n = conv_decoder_iterations(dec);
+			iters += n;
+			if (n > max)
+				max = n;
+		}
 
 		for (n = 0; n < tst->in_len; n++) {
                         if (bu0[n] != bu1[n])
@@ -510,8 +1361,17 @@ static int error_test(const struct conv_test_vector *tst,
 			fer++;
 	}
 
-	print_error_results(tst, iber, ober, fer, iter);
-
+	print_error_results(tst, dec_names[type], iber, ober, fer, iter);
+	if (type == DEC_METRIC8)
+		printf("[..] Saturated frames................... %i\n", sat);
+	if (dec && (tst->code->term == CONV_TERM_TAIL_BITING))
+		printf("[..] Tail-biting iterations............. %f (max %i)\n",
+		       (float) iters / iter, max);
+
+	conv_decoder_free(dec);
+	free(enc_ws);
+	free(ws);
+	free(bp);
 	free(bs);
 	free(bu1);
 	free(bu0);
@@ -519,194 +1379,1851 @@ static int error_test(const struct conv_test_vector *tst,
 	return 0;
 }
 
-static int init_thread_arg(struct benchmark_thread_arg *arg,
-			    const struct conv_test_vector *tst,
-			    int iter, int base)
+/* Batch bit error rate test
+ *     Same as the single burst test with 'width' bursts encoded and passed
+ *     through the channel before each batch decode.
+ */
+static int batch_error_test(const struct conv_test_vector *tst,
+			    int iter, float snr, int width)
 {
-	sbit_t *bs;
-	ubit_t *bu;
+	int i, j, n, l, iber = 0, ober = 0, fer = 0;
+	char engine[32];
+	sbit_t *bs[width];
+	ubit_t *bu0[width], *bu1[width];
+	struct vbatch *batch;
+
+	batch = conv_batch_create(tst->code, width);
+	if (!batch) {
+		fprintf(stderr, "[!] Failed to create batch decoder\n");
+		return -1;
+	}
+
+	for (j = 0; j < width; j++) {
+		bu0[j] = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+		bu1[j] = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+		bs[j]  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+	}
+
+	iter = (iter + width - 1) / width * width;
+
+	for (i = 0; i < iter; i += width) {
+		for (j = 0; j < width; j++) {
+			fill_random(bu0[j], tst->in_len);
+
+			l = test_conv_encode(tst->code, tst->rgen, tst->gen,
+					     bu0[j], bu1[j]);
+			if (l != tst->out_len) {
+				printf("ERROR !\n");
+				fprintf(stderr, "[!] Failed encoding length "
+					"check (%i)\n", l);
+				return -1;
+			}
+
+			iber += ubit_to_err(bs[j], bu1[j], l, snr);
+		}
+
+		conv_batch_run(batch, (const sbit_t * const *) bs, bu1);
+
+		for (j = 0; j < width; j++) {
+			for (n = 0; n < tst->in_len; n++) {
+				if (bu0[j][n] != bu1[j][n])
+					ober++;
+			}
+
+			if (memcmp(bu0[j], bu1[j], tst->in_len))
+				fer++;
+		}
+	}
+
+	snprintf(engine, sizeof(engine), "%s%i", dec_names[DEC_BATCH], width);
+	print_error_results(tst, engine, iber, ober, fer, iter);
+
+	for (j = 0; j < width; j++) {
+		free(bs[j]);
+		free(bu1[j]);
+		free(bu0[j]);
+	}
+	conv_batch_free(batch);
+
+	return 0;
+}
+
+/* Windowed decoding of one stream in random sized chunks */
+static int window_decode(struct vwindow *win, const sbit_t *bs,
+			 ubit_t *bu, int n, int len)
+{
+	int i = 0, l = 0, rc, chunk;
+
+	while (i < len) {
+		chunk = rand() % STREAM_MAX_CHUNK + 1;
+		if (chunk > len - i)
+			chunk = len - i;
+
+		rc = conv_window_push(win, &bs[n * i], chunk, &bu[l]);
+		if (rc < 0)
+			return rc;
+
+		i += chunk;
+		l += rc;
+	}
+
+	rc = conv_window_flush(win, &bu[l]);
+	if (rc < 0)
+		return rc;
+
+	return l + rc;
+}
+
+/* Windowed stream decoder test
+ *     Compare bit error rates of the windowed decoder at several decision
+ *     depths against the full traceback decoder on identical noisy streams.
+ *     Each decoder is recorded as a 'stream' result.
+ */
+static int stream_test(const struct stream_test_vector *tst, float snr)
+{
+	int i, j, n, l, e, steps, iber = 0;
+	int ober[STREAM_NUM_DEPTHS + 1] = { 0 };
+	int fer[STREAM_NUM_DEPTHS + 1] = { 0 };
+	const struct osmo_conv_code *code = tst->code;
+	const int depths[STREAM_NUM_DEPTHS] = { 5, 7, 10 };
+	struct vwindow *win[STREAM_NUM_DEPTHS];
+	struct vdecoder *dec;
+	sbit_t *bs;
+	ubit_t *bu0, *bu1;
+	char label[64], engine[32];
+	struct result *res;
+
+	steps = code->len + code->K - 1;
+
+	bu0 = malloc(sizeof(ubit_t) * steps * code->N);
+	bu1 = malloc(sizeof(ubit_t) * steps * code->N);
+	bs  = malloc(sizeof(sbit_t) * steps * code->N);
+
+	dec = conv_decoder_create(code);
+	if (!dec) {
+		fprintf(stderr, "[!] Failed to create decoder\n");
+		return -1;
+	}
+
+	for (i = 0; i < STREAM_NUM_DEPTHS; i++) {
+		win[i] = conv_window_create(code, depths[i] * code->K);
+		if (!win[i]) {
+			fprintf(stderr, "[!] Failed to create window decoder\n");
+			return -1;
+		}
+	}
+
+	for (i = 0; i < STREAM_ITER; i++) {
+		fill_random(bu0, code->len);
+
+		l = test_conv_encode(code, tst->rgen, tst->gen, bu0, bu1);
+		iber += ubit_to_err(bs, bu1, l, snr);
+		steps = l / code->N;
+
+		conv_decoder_run(dec, bs, bu1);
+		for (n = 0, e = 0; n < code->len; n++)
+			e += bu0[n] != bu1[n];
+		ober[0] += e;
+		fer[0] += e > 0;
+
+		for (j = 0; j < STREAM_NUM_DEPTHS; j++) {
+			l = window_decode(win[j], bs, bu1, code->N, steps);
+			if (l != code->len) {
+				fprintf(stderr, "[!] Failed window decoding "
+					"length check (%i)\n", l);
+				return -1;
+			}
+
+			for (n = 0, e = 0; n < code->len; n++)
+				e += bu0[n] != bu1[n];
+			ober[j + 1] += e;
+			fer[j + 1] += e > 0;
+		}
+	}
+
+	l = STREAM_ITER * code->len;
+
+	printf("[..] Input BER.......................... %f\n",
+	       (float) iber / (STREAM_ITER * steps * code->N));
+	printf("[..] Full traceback BER................. %f\n",
+	       (float) ober[0] / l);
+
+	for (i = 0; i < STREAM_NUM_DEPTHS; i++) {
+		snprintf(label, sizeof(label), "Window depth %i (%iK) BER",
+			 depths[i] * code->K, depths[i]);
+		printf("[..] %s", label);
+		for (n = strlen(label); n < 35; n++)
+			printf(".");
+		printf(" %f\n", (float) ober[i + 1] / l);
+	}
+
+	for (i = 0; i <= STREAM_NUM_DEPTHS; i++) {
+		if (i)
+			snprintf(engine, sizeof(engine), "window%i",
+				 depths[i - 1] * code->K);
+		else
+			snprintf(engine, sizeof(engine), "%s",
+				 dec_names[DEC_PERSIST]);
+
+		res = add_record("stream", tst->name, code, code->len,
+				 engine, 1, STREAM_ITER);
+		if (res) {
+			res->ber = (double) ober[i] / l;
+			res->fer = (double) fer[i] / STREAM_ITER;
+		}
+	}
+
+	for (i = 0; i < STREAM_NUM_DEPTHS; i++)
+		conv_window_free(win[i]);
+	conv_decoder_free(dec);
+	free(bs);
+	free(bu1);
+	free(bu0);
+
+	return 0;
+}
+
+static int init_thread_arg(struct benchmark_thread_arg *arg,
+			    const struct conv_test_vector *tst,
+			    int iter, enum dec_type type, int width, float snr)
+{
+	int i, l;
+	ubit_t *bu0, *bu1;
 	int (*decode) (const struct osmo_conv_code *, const sbit_t *, ubit_t *);
 	struct osmo_conv_code *code;
 
 	code = (struct osmo_conv_code *) malloc(sizeof(struct osmo_conv_code));
 	memcpy(code, tst->code, sizeof(struct osmo_conv_code));
 
-	bu = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
-	bs = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+
+	arg->frames = malloc(sizeof(sbit_t) * tst->out_len * BENCH_FRAMES);
+	arg->lat = malloc(sizeof(unsigned long) * iter);
+	arg->ws = NULL;
+	arg->dec = NULL;
+	arg->batch = NULL;
+
+	if (!arg->frames || !arg->lat)
+		goto fail;
+
+	/* Noisy frames of random data at the test SNR */
+	for (i = 0; i < BENCH_FRAMES; i++) {
+		fill_random(bu0, tst->in_len);
+		l = test_conv_encode(code, tst->rgen, tst->gen, bu0, bu1);
+		if (l != tst->out_len) {
+			fprintf(stderr, "[!] Failed encoding length check (%i)\n",
+				l);
+			goto fail;
+		}
+
+		ubit_to_err(&arg->frames[i * tst->out_len], bu1, l, snr);
+	}
 
-	if (base)
+	if (type == DEC_BASE)
 		decode = osmo_conv_decode;
 	else
 		decode = test_conv_decode;
 
-	decode(code, bs, bu);
+	decode(code, arg->frames, bu1);
+
+	arg->ws_len = 0;
+	if (type == DEC_WORKSPACE) {
+		arg->ws_len = conv_decoder_workspace_size(code);
+		arg->ws = memalign(32, arg->ws_len);
+		if (!arg->ws)
+			goto fail;
+	}
+
+	if ((type == DEC_PERSIST) || (type == DEC_METRIC8) ||
+	    (type == DEC_MODULO) || (type == DEC_PACKED) ||
+	    (type == DEC_EXCHANGE) || (type == DEC_GENERIC)) {
+		if ((type == DEC_PERSIST) || (type == DEC_PACKED) ||
+		    (type == DEC_EXCHANGE) || (type == DEC_GENERIC))
+			arg->dec = conv_decoder_create(code);
+		else if (type == DEC_METRIC8)
+			arg->dec = conv_decoder_create_i8(code);
+		else
+			arg->dec = conv_decoder_create_mod(code);
+		if (arg->dec && (type == DEC_EXCHANGE) &&
+		    (conv_decoder_set_exchange(arg->dec, 1) < 0)) {
+			conv_decoder_free(arg->dec);
+			arg->dec = NULL;
+		}
+		if (arg->dec && (type == DEC_GENERIC))
+			conv_decoder_set_specialized(arg->dec, 0);
+		if (!arg->dec)
+			goto fail;
+	}
+
+	if (type == DEC_BATCH) {
+		arg->batch = conv_batch_create(code, width);
+		if (!arg->batch)
+			goto fail;
+	}
 
 	arg->tst = tst;
-	arg->base = base;
+	arg->type = type;
+	arg->width = width;
 	arg->iter = iter;
 	arg->code = code;
 	arg->err = 0;
+	arg->allocs = 0;
+	arg->num_lat = 0;
 
-	free(bs);
-	free(bu);
+	free(bu0);
+	free(bu1);
 
 	return 0;
+fail:
+	free(arg->ws);
+	free(arg->lat);
+	free(arg->frames);
+	free(bu0);
+	free(bu1);
+	free(code);
+
+	return -1;
 }
 
-/* One benchmark benchmark thread with random valued input */
-static void *thread_test(void *ptr)
+/* Release benchmark thread resources */
+static void free_thread_arg(struct benchmark_thread_arg *arg)
+{
+	conv_decoder_free(arg->dec);
+	conv_batch_free(arg->batch);
+	free(arg->ws);
+	free(arg->lat);
+	free(arg->frames);
+	free(arg->code);
+}
+
+/* One batch decode of consecutive frames starting at frame 'n' */
+static void batch_test(struct benchmark_thread_arg *arg, int n, ubit_t *bu)
 {
 	int i;
+	const sbit_t *in[arg->width];
+	ubit_t *out[arg->width];
+
+	for (i = 0; i < arg->width; i++) {
+		in[i] = &arg->frames[((n + i) % BENCH_FRAMES) *
+				     arg->tst->out_len];
+		out[i] = bu;
+	}
+
+	conv_batch_run(arg->batch, in, out);
+}
+
+/* Monotonic timestamp in nanoseconds */
+static unsigned long time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(BENCH_CLOCK, &ts);
+
+	return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+/* One benchmark thread
+ *     Decode the pre-generated frames in turn and record the latency of
+ *     every decode call. A batch decode call is one sample.
+ */
+static void *thread_test(void *ptr)
+{
+	int i, n;
 	sbit_t *bs;
-	ubit_t *bu0, *bu1;
+	ubit_t *bu;
+	unsigned long t0;
+	int fds[HW_NUM];
 	struct benchmark_thread_arg *arg = (struct benchmark_thread_arg *) ptr;
 	int (*decode) (const struct osmo_conv_code *, const sbit_t *, ubit_t *);
+	int step = arg->batch ? arg->width : 1;
 
-	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
-	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
-	bs  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+	bu = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
 
-	enable_prio(0.5);
+	if (fifo_prio)
+		arg->prio = enable_prio(0.5);
 
-	if (arg->base)
+	if (arg->type == DEC_BASE)
 		decode = osmo_conv_decode;
 	else
 		decode = test_conv_decode;
 
-	for (i = 0; i < arg->iter; i++)
-		decode(arg->code, bs, bu1);
+	if (hw_counters)
+		hw_start(fds);
+
+	alloc_count = 0;
+	alloc_count_on = alloc_check;
+
+	for (i = 0, n = 0; i < arg->iter; i += step, n++) {
+		bs = &arg->frames[(i % BENCH_FRAMES) * arg->tst->out_len];
+
+		t0 = time_ns();
+		if (arg->batch)
+			batch_test(arg, i, bu);
+		else if (arg->type == DEC_PACKED)
+			conv_decoder_run_packed(arg->dec, bs, bu, 0);
+		else if (arg->dec)
+			conv_decoder_run(arg->dec, bs, bu);
+		else if (arg->ws)
+			test_conv_decode_ws(arg->code, bs, bu,
+					    arg->ws, arg->ws_len);
+		else
+			decode(arg->code, bs, bu);
+		arg->lat[n] = time_ns() - t0;
+	}
 
-	free(bs);
-	free(bu1);
-	free(bu0);
+	alloc_count_on = 0;
+	arg->allocs = alloc_count;
+	arg->num_lat = n;
+
+	if (hw_counters)
+		hw_stop(fds, arg->hw);
+
+	free(bu);
+
+	pthread_exit(NULL);
+}
+
+static int cmp_ulong(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *) a;
+	unsigned long y = *(const unsigned long *) b;
+
+	return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted latencies in microseconds */
+static double lat_percentile(const unsigned long *lat, int n, double p)
+{
+	int i = (int) (p / 100.0 * n + 0.999999) - 1;
+
+	if (i < 0)
+		i = 0;
+	if (i >= n)
+		i = n - 1;
+
+	return lat[i] / 1e3;
+}
+
+/* Merged and sorted latencies of all threads or NULL if none */
+static unsigned long *merge_latency(struct benchmark_thread_arg *args,
+				    int num_threads, int *num)
+{
+	int i, n = 0;
+	unsigned long *lat;
+
+	for (i = 0; i < num_threads; i++)
+		n += args[i].num_lat;
+	if (!n)
+		return NULL;
+
+	lat = malloc(sizeof(unsigned long) * n);
+	if (!lat)
+		return NULL;
+
+	for (i = 0, n = 0; i < num_threads; i++) {
+		memcpy(&lat[n], args[i].lat,
+		       sizeof(unsigned long) * args[i].num_lat);
+		n += args[i].num_lat;
+	}
+	qsort(lat, n, sizeof(unsigned long), cmp_ulong);
+
+	*num = n;
+
+	return lat;
+}
+
+/* Reported latency points of sorted latencies in microseconds */
+static void latency_points(const unsigned long *lat, int n,
+			   double *points)
+{
+	int i;
+	static const double pcts[] = { 50.0, 90.0, 99.0, 99.9 };
+
+	for (i = 0; i < LAT_POINTS - 1; i++)
+		points[i] = lat_percentile(lat, n, pcts[i]);
+	points[LAT_POINTS - 1] = lat[n - 1] / 1e3;
+}
+
+/* Per-frame latency report
+ *     Latencies of all threads are merged and sorted. Histogram buckets are
+ *     spaced logarithmically between the fastest and slowest decode, so the
+ *     tail stays visible next to the bulk of the samples. The reported
+ *     points are also stored in 'res' if given.
+ */
+static void print_latency(struct benchmark_thread_arg *args,
+			  int num_threads, enum dec_type type,
+			  struct result *res)
+{
+	int i, j, n, b, max = 0;
+	int hist[LAT_BUCKETS] = { 0 };
+	unsigned long *lat;
+	double lo, hi, ratio, edge;
+	double points[LAT_POINTS];
+	static const char *labels[LAT_POINTS] = {
+		"p50", "p90", "p99", "p99.9", "max",
+	};
+	char label[64];
+
+	lat = merge_latency(args, num_threads, &n);
+	if (!lat)
+		return;
+
+	latency_points(lat, n, points);
+	if (res)
+		memcpy(res->lat, points, sizeof(points));
+
+	for (i = 0; i < LAT_POINTS; i++) {
+		snprintf(label, sizeof(label), "Latency %s%s", labels[i],
+			 type == DEC_BATCH ? " (batch)" : "");
+		printf("[..] %s", label);
+		for (j = strlen(label); j < 35; j++)
+			printf(".");
+		printf(" %.3f us\n", points[i]);
+	}
+
+	/* Log spaced buckets from the fastest to the slowest decode */
+	lo = lat[0] ? lat[0] : 1;
+	hi = lat[n - 1] > lo ? lat[n - 1] : lo + 1;
+	ratio = pow(hi / lo, 1.0 / LAT_BUCKETS);
+
+	for (i = 0; i < n; i++) {
+		b = lat[i] <= lo ? 0 : (int) (log(lat[i] / lo) / log(ratio));
+		if (b >= LAT_BUCKETS)
+			b = LAT_BUCKETS - 1;
+		if (++hist[b] > max)
+			max = hist[b];
+	}
+
+	printf("[..] Latency histogram (us):\n");
+	for (i = 0, edge = lo; i < LAT_BUCKETS; i++, edge *= ratio) {
+		printf("[..]   %10.3f - %10.3f %8i ", edge / 1e3,
+		       edge * ratio / 1e3, hist[i]);
+		for (j = 0; j < (hist[i] * LAT_BAR_WIDTH + max - 1) / max; j++)
+			printf("#");
+		printf("\n");
+	}
+
+	free(lat);
+}
+
+/* Fire off benchmark threads and measure elapsed time
+ *     Threads are pinned according to the placement policy. On success the
+ *     thread arguments are left for the caller to report on and release.
+ *     On failure all of them are released, including those of threads
+ *     that could not be started.
+ */
+static double run_threads(const struct conv_test_vector *tst,
+			  struct benchmark_thread_arg *args,
+			  int num_threads, int iter,
+			  enum dec_type type, int width, float snr)
+{
+	int i, rc, started, err = 0, prio = 0;
+	static int prio_warned;
+	void *status;
+	struct timeval tv0, tv1;
+	pthread_t *threads;
+	pthread_attr_t attr;
+	cpu_set_t set;
+
+	threads = malloc(sizeof(pthread_t) * num_threads);
+	if (!threads)
+		return -1.0;
+
+	for (i = 0; i < num_threads; i++) {
+		rc = init_thread_arg(&args[i], tst, iter, type, width, snr);
+		if (rc < 0) {
+			while (i--)
+				free_thread_arg(&args[i]);
+			free(threads);
+			return -1.0;
+		}
+		args[i].cpu = -1;
+		args[i].prio = 0;
+		if (num_pin_cpus)
+			args[i].cpu = pin_cpus[i % num_pin_cpus].cpu;
+	}
+
+	gettimeofday(&tv0, NULL);
+	for (i = 0; i < num_threads; i++) {
+		pthread_attr_init(&attr);
+		if (args[i].cpu >= 0) {
+			CPU_ZERO(&set);
+			CPU_SET(args[i].cpu, &set);
+			pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+		}
+		rc = pthread_create(&threads[i], &attr,
+				    thread_test, (void *) &args[i]);
+		pthread_attr_destroy(&attr);
+		if (rc) {
+			fprintf(stderr, "[!] Failed to start benchmark "
+				"thread %i: %s\n", i, strerror(rc));
+			err = 1;
+			break;
+		}
+	}
+	started = i;
+	for (i = 0; i < started; i++) {
+		pthread_join(threads[i], &status);
+		err |= args[i].err;
+		prio |= args[i].prio;
+	}
+	gettimeofday(&tv1, NULL);
+
+	free(threads);
+
+	if (prio && !prio_warned) {
+		fprintf(stderr, "[!] SCHED_FIFO not permitted, "
+			"running at normal priority\n");
+		prio_warned = 1;
+	}
+
+	if (err) {
+		for (i = 0; i < num_threads; i++)
+			free_thread_arg(&args[i]);
+		return -1.0;
+	}
+
+	return (tv1.tv_sec - tv0.tv_sec) + (tv1.tv_usec - tv0.tv_usec) / 1e6;
+}
+
+/* Hardware counter report
+ *     Totals of all threads normalized per decoded bit and per trellis
+ *     step, counting each burst as one pass over its trellis.
+ */
+static void print_counters(const struct conv_test_vector *tst,
+			   struct benchmark_thread_arg *args,
+			   int num_threads, int iter)
+{
+	int i, c, n, avail = 0;
+	double sum[HW_NUM], bits, steps;
+	char label[64];
+
+	steps = tst->code->len;
+	if (tst->code->term == CONV_TERM_FLUSH)
+		steps += tst->code->K - 1;
+	steps *= (double) num_threads * iter;
+	bits = (double) num_threads * iter * tst->in_len;
+
+	for (c = 0; c < HW_NUM; c++) {
+		sum[c] = 0.0;
+		for (i = 0; i < num_threads; i++)
+			sum[c] += args[i].hw[c];
+		avail += !isnan(sum[c]);
+	}
+
+	if (!avail) {
+		printf("[..] Hardware counters.................. "
+		       "unavailable\n");
+		return;
+	}
+
+	for (c = 0; c < HW_NUM; c++) {
+		snprintf(label, sizeof(label), "%s per bit/step", hw_names[c]);
+		printf("[..] %s", label);
+		for (n = strlen(label); n < 35; n++)
+			printf(".");
+		if (isnan(sum[c]))
+			printf(" n/a\n");
+		else
+			printf(" %.4f / %.4f\n", sum[c] / bits, sum[c] / steps);
+	}
+
+	if (!isnan(sum[HW_CYCLES]) && !isnan(sum[HW_INSTR]))
+		printf("[..] Instructions per cycle............. %.3f\n",
+		       sum[HW_INSTR] / sum[HW_CYCLES]);
+}
+
+/* Timed benchmark with elapsed time, rate and latency report */
+static double run_benchmark(const struct conv_test_vector *tst,
+			    struct benchmark_thread_arg *args,
+			    int num_threads, int iter,
+			    enum dec_type type, int width, float snr)
+{
+	int i;
+	unsigned long allocs = 0;
+	double elapsed;
+	char engine[32];
+	struct result *res;
+
+	/* Whole batches only */
+	if (type == DEC_BATCH)
+		iter = (iter + width - 1) / width * width;
+
+	elapsed = run_threads(tst, args, num_threads, iter, type, width, snr);
+	if (elapsed < 0.0)
+		return -1.0;
+
+	if (type == DEC_BATCH)
+		snprintf(engine, sizeof(engine), "%s%i",
+			 dec_names[type], width);
+	else
+		snprintf(engine, sizeof(engine), "%s", dec_names[type]);
+
+	res = add_result("bench", tst, engine, num_threads, iter);
+	if (res) {
+		res->mbps = (double) num_threads * tst->in_len * iter /
+			    elapsed / 1e6;
+	}
+
+	print_timed_results(elapsed, tst, iter, num_threads);
+	if (alloc_check) {
+		for (i = 0; i < num_threads; i++)
+			allocs += args[i].allocs;
+		printf("[..] Heap allocations................... %lu "
+		       "(%.2f per burst)\n", allocs,
+		       (double) allocs / ((double) iter * num_threads));
+	}
+	print_latency(args, num_threads, type, res);
+	if (hw_counters)
+		print_counters(tst, args, num_threads, iter);
+
+	for (i = 0; i < num_threads; i++)
+		free_thread_arg(&args[i]);
+
+	return elapsed;
+}
+
+/* Thread scaling sweep of the persistent decoder
+ *     Runs 1 to 'max_threads' threads, each decoding 'iter' bursts, and
+ *     reports the aggregate and per-thread rate and the parallel efficiency
+ *     against a single thread. The placement column shows the CPU taken by
+ *     the last thread added and whether it shares a physical core.
+ */
+static int sweep_benchmark(const struct conv_test_vector *tst,
+			   struct benchmark_thread_arg *args,
+			   int max_threads, int iter, float snr)
+{
+	int i, n, num;
+	double elapsed, rate, base = 0.0;
+	char place[32];
+	unsigned long *lat;
+	const struct cpu_info *cpu;
+	struct result *res;
+
+	printf("\n[.] Thread scaling (persistent, %s placement):\n",
+	       pin_names[pin_policy]);
+	printf("[..] %7s %12s %12s %10s  %s\n", "Threads", "Mbps",
+	       "Mbps/thread", "Efficiency", "Placement");
+
+	for (n = 1; n <= max_threads; n++) {
+		elapsed = run_threads(tst, args, n, iter, DEC_PERSIST, 0, snr);
+		if (elapsed < 0.0)
+			return -1;
+
+		rate = (double) n * tst->in_len * iter / elapsed / 1e6;
+		if (n == 1)
+			base = rate;
+
+		res = add_result("sweep", tst,
+				 dec_names[DEC_PERSIST], n, iter);
+		lat = merge_latency(args, n, &num);
+		if (res) {
+			res->mbps = rate;
+			if (lat)
+				latency_points(lat, num, res->lat);
+		}
+		free(lat);
+
+		for (i = 0; i < n; i++)
+			free_thread_arg(&args[i]);
+
+		if (!num_pin_cpus) {
+			snprintf(place, sizeof(place), "-");
+		} else {
+			cpu = &pin_cpus[(n - 1) % num_pin_cpus];
+			snprintf(place, sizeof(place), "cpu %i%s", cpu->cpu,
+				 n > num_pin_cpus ? " (shared)" :
+				 cpu->thread ? " (smt)" : "");
+		}
+
+		printf("[..] %7i %12.3f %12.3f %9.1f%%  %s\n", n, rate,
+		       rate / n, 100.0 * rate / (n * base), place);
+	}
+
+	return 0;
+}
+
+/* Benchmark the persistent decoder with each available kernel set
+ *     Speedup is reported against the last (generic) set. The kernel set in
+ *     use before the comparison is restored on return.
+ */
+static int compare_kernels(const struct conv_test_vector *tst,
+			   struct benchmark_thread_arg *args,
+			   int threads, int iter, float snr)
+{
+	int i, n, num;
+	char label[64];
+	const char *name, *current = conv_simd_current();
+	const char *names[MAX_KERNEL_SETS];
+	double elapsed[MAX_KERNEL_SETS];
+
+	printf("[..] Kernel set comparison:\n");
+
+	for (num = 0; num < MAX_KERNEL_SETS; num++) {
+		name = conv_simd_variant(num);
+		if (!name)
+			break;
+
+		conv_simd_select(name);
+		printf("[..] Testing SIMD (%s):\n", name);
+
+		names[num] = name;
+		elapsed[num] = run_benchmark(tst, args, threads,
+					     iter, DEC_PERSIST, 0, snr);
+		if (elapsed[num] < 0.0) {
+			conv_simd_select(current);
+			return -1;
+		}
+	}
+
+	conv_simd_select(current);
+
+	for (i = 0; i < num - 1; i++) {
+		snprintf(label, sizeof(label), "Speedup %s vs %s",
+			 names[i], names[num - 1]);
+		printf("[..] %s", label);
+		for (n = strlen(label); n < 35; n++)
+			printf(".");
+		printf(" %f\n", elapsed[num - 1] / elapsed[i]);
+	}
+
+	return 0;
+}
+
+/* Verify output values with predefined input */
+static int value_test(const struct conv_test_vector *tst)
+{
+	int l;
+	sbit_t *bs;
+	ubit_t *bu0, *bu1;
+
+	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bs  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+
+	osmo_pbit2ubit(bu0, tst->vec_in, tst->in_len);
+
+	l = test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
+	if (l != tst->out_len) {
+		fprintf(stderr, "[!] Failed encoding length check (%i)\n", l);
+		return -1;
+	}
+
+	osmo_pbit2ubit(bu0, tst->vec_out, tst->out_len);
+
+	if (memcmp(bu0, bu1, tst->out_len)) {
+		fprintf(stderr, "[!] Failed encoding: Results don't match\n");
+		return -1;
+	};
+
+	printf("OK\n");
+	printf("[..] Decoding base: \n");
+
+	ubit_to_sbit(bs, bu0, l);
+	l = osmo_conv_decode(tst->code, bs, bu1);
+	if (l != 0) {
+		fprintf(stderr, "[!] Failed decoding: non-zero path (%d)\n", l);
+		return -1;
+	}
+
+	osmo_pbit2ubit(bu0, tst->vec_in, tst->in_len);
+	if (memcmp(bu0, bu1, tst->in_len)) {
+		fprintf(stderr, "[!] Failed decoding: Results don't match\n");
+		return -1;
+	}
+
+	printf("[..] Decoding SIMD: \n");
+	printf("[..] Code N %i\n", tst->code->N);
+	printf("[..] Code K %i\n", tst->code->K);
+	l = test_conv_decode(tst->code, bs, bu1);
+	if (l != 0) {
+		fprintf(stderr,
+			"[!] Failed decoding: SIMD non-zero path (%d)\n", l);
+		return -1;
+	}
+
+	osmo_pbit2ubit(bu0, tst->vec_in, tst->in_len);
+	if (memcmp(bu0, bu1, tst->in_len)) {
+		fprintf(stderr, "[!] Failed decoding: Results don't match\n");
+		return -1;
+	}
+
+	free(bs);
+	free(bu1);
+	free(bu0);
+
+	printf("[..] Decoding: OK\n");
+	return 0;
+}
+
+/* Compare packed encoder output against the unpacked encoder */
+static int packed_test(const struct conv_test_vector *tst)
+{
+	int i, l0, l1, rc = -1;
+	ubit_t *bu0, *bu1;
+	pbit_t *bp0, *bp1, *bp2;
+	struct vencoder *enc;
+
+	enc = conv_encoder_create(tst->code, tst->rgen, tst->gen);
+	if (!enc) {
+		fprintf(stderr, "[!] Failed to create packed encoder\n");
+		return -1;
+	}
+
+	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bp0 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+	bp1 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+	bp2 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+
+	for (i = 0; i < PACKED_ITER; i++) {
+		fill_random(bu0, tst->in_len);
+		osmo_ubit2pbit(bp0, bu0, tst->in_len);
+
+		l0 = test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
+		l1 = conv_encoder_run(enc, bp0, bp1);
+		if (l0 != l1) {
+			fprintf(stderr, "[!] Failed packed encoding length "
+				"(%i, expected %i)\n", l1, l0);
+			goto out;
+		}
+
+		osmo_ubit2pbit(bp2, bu1, l0);
+		if (memcmp(bp1, bp2, (l0 + 7) / 8)) {
+			fprintf(stderr, "[!] Failed packed encoding: "
+				"Results don't match\n");
+			goto out;
+		}
+	}
+
+	printf("[.] Packed encoder : %i bursts -> OK\n", PACKED_ITER);
+	rc = 0;
+out:
+	free(bp2);
+	free(bp1);
+	free(bp0);
+	free(bu1);
+	free(bu0);
+	conv_encoder_free(enc);
+
+	return rc;
+}
+
+/* Pack bits LSB first for comparison with packed decoder output */
+static void ubit_to_pbit_lsb(pbit_t *out, const ubit_t *in, int n)
+{
+	int i;
+
+	memset(out, 0, (n + 7) / 8);
+	for (i = 0; i < n; i++)
+		out[i >> 3] |= in[i] << (i & 7);
+}
+
+/* Compare packed decoder output in both bit orders against unpacked output
+ *     Bursts are passed through the channel so that the decoded bits
+ *     include errors.
+ */
+static int packed_decode_test(const struct conv_test_vector *tst, float snr)
+{
+	int i, lsb, l, rc = -1;
+	sbit_t *bs;
+	ubit_t *bu0, *bu1;
+	pbit_t *bp0, *bp1;
+	struct vdecoder *dec;
+
+	dec = conv_decoder_create(tst->code);
+	if (!dec) {
+		fprintf(stderr, "[!] Failed to create decoder\n");
+		return -1;
+	}
+
+	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bs  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+	bp0 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+	bp1 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+
+	for (i = 0; i < PACKED_ITER; i++) {
+		fill_random(bu0, tst->in_len);
+		l = test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
+		ubit_to_err(bs, bu1, l, snr);
+
+		conv_decoder_run(dec, bs, bu1);
+
+		for (lsb = 0; lsb < 2; lsb++) {
+			if (lsb)
+				ubit_to_pbit_lsb(bp0, bu1, tst->in_len);
+			else
+				osmo_ubit2pbit(bp0, bu1, tst->in_len);
+
+			memset(bp1, 0xff, MAX_LEN_BYTES);
+			if (i & 1)
+				test_conv_decode_packed(tst->code, bs, bp1, lsb);
+			else
+				conv_decoder_run_packed(dec, bs, bp1, lsb);
+
+			if (memcmp(bp0, bp1, (tst->in_len + 7) / 8)) {
+				fprintf(stderr, "[!] Failed packed decoding: "
+					"Results don't match\n");
+				goto out;
+			}
+		}
+	}
+
+	printf("[.] Packed decoder : %i bursts -> OK\n", PACKED_ITER);
+	rc = 0;
+out:
+	free(bp1);
+	free(bp0);
+	free(bs);
+	free(bu1);
+	free(bu0);
+	conv_decoder_free(dec);
+
+	return rc;
+}
+
+/* 8-bit path metrics with full-scale input
+ *     Hard decisions at +/-127 give the widest path metric spread, which
+ *     the 8-bit decoder has to absorb by clipping losing paths. Compare
+ *     its error rates against the 16-bit decoder on the same bursts of
+ *     tail-biting and truncated codes, where the decoder cannot rely on
+ *     a known end state.
+ */
+static int full_scale_test(const struct conv_test_vector *tst, float snr)
+{
+	int i, j, n, l, rc = -1;
+	int ober[2] = { 0 }, fer[2] = { 0 }, err[2];
+	sbit_t *bs;
+	ubit_t *bu0, *bu1;
+	struct vdecoder *dec[2];
+
+	if (tst->code->term == CONV_TERM_FLUSH)
+		return 0;
+
+	dec[1] = conv_decoder_create_i8(tst->code);
+	if (!dec[1])
+		return 0;
+
+	dec[0] = conv_decoder_create(tst->code);
+	if (!dec[0]) {
+		fprintf(stderr, "[!] Failed to create decoder\n");
+		conv_decoder_free(dec[1]);
+		return -1;
+	}
+
+	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bs  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+
+	for (i = 0; i < FULL_SCALE_ITER; i++) {
+		fill_random(bu0, tst->in_len);
+		l = test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
+		ubit_to_xerr(bs, bu1, l, snr);
+
+		for (n = 0; n < 2; n++) {
+			conv_decoder_run(dec[n], bs, bu1);
+			for (j = 0, err[n] = 0; j < tst->in_len; j++)
+				err[n] += bu0[j] != bu1[j];
+			ober[n] += err[n];
+			fer[n] += err[n] > 0;
+		}
+	}
+
+	printf("[.] Full-scale 8-bit : BER %f FER %f (16-bit %f %f) ",
+	       (float) ober[1] / (FULL_SCALE_ITER * tst->in_len),
+	       (float) fer[1] / FULL_SCALE_ITER,
+	       (float) ober[0] / (FULL_SCALE_ITER * tst->in_len),
+	       (float) fer[0] / FULL_SCALE_ITER);
+
+	if (fer[1] > fer[0] + FULL_SCALE_MARGIN) {
+		printf("-> Bad !\n");
+		fprintf(stderr, "[!] Failed full-scale 8-bit decoding: "
+			"%i frame errors vs %i\n", fer[1], fer[0]);
+		goto out;
+	}
+
+	printf("-> OK\n");
+	rc = 0;
+out:
+	free(bs);
+	free(bu1);
+	free(bu0);
+	conv_decoder_free(dec[1]);
+	conv_decoder_free(dec[0]);
+
+	return rc;
+}
+
+/* Allocate or release per-frame packed buffers of a batch */
+static pbit_t **alloc_frames(int n)
+{
+	int i;
+	pbit_t **frames = malloc(sizeof(pbit_t *) * n);
+
+	for (i = 0; i < n; i++)
+		frames[i] = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+
+	return frames;
+}
+
+static void free_frames(pbit_t **frames, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		free(frames[i]);
+	free(frames);
+}
+
+/* Compare bit-sliced batch encoder output against the packed encoder */
+static int batch_encode_test(const struct conv_test_vector *tst)
+{
+	int i, l0, l1, rc = -1;
+	ubit_t *bu;
+	pbit_t *bp, **in, **out;
+	struct vencoder *enc;
+	struct vencbatch *batch;
+
+	enc = conv_encoder_create(tst->code, tst->rgen, tst->gen);
+	batch = conv_encoder_batch_create(tst->code, tst->rgen,
+					  tst->gen, ENC_BATCH_MAX);
+	if (!enc || !batch) {
+		fprintf(stderr, "[!] Failed to create batch encoder\n");
+		conv_encoder_batch_free(batch);
+		conv_encoder_free(enc);
+		return -1;
+	}
+
+	bu = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bp = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+	in = alloc_frames(ENC_BATCH_MAX);
+	out = alloc_frames(ENC_BATCH_MAX);
+
+	for (i = 0; i < ENC_BATCH_MAX; i++) {
+		fill_random(bu, tst->in_len);
+		osmo_ubit2pbit(in[i], bu, tst->in_len);
+	}
+
+	l0 = conv_encoder_batch_run(batch, (const pbit_t * const *) in, out);
+
+	for (i = 0; i < ENC_BATCH_MAX; i++) {
+		l1 = conv_encoder_run(enc, in[i], bp);
+		if ((l0 != l1) || memcmp(out[i], bp, (l1 + 7) / 8)) {
+			fprintf(stderr, "[!] Failed batch encoding: "
+				"Results don't match (burst %i)\n", i);
+			goto out;
+		}
+	}
+
+	printf("[.] Batch encoder  : %i bursts -> OK\n", ENC_BATCH_MAX);
+	rc = 0;
+out:
+	free_frames(out, ENC_BATCH_MAX);
+	free_frames(in, ENC_BATCH_MAX);
+	free(bp);
+	free(bu);
+	conv_encoder_batch_free(batch);
+	conv_encoder_free(enc);
+
+	return rc;
+}
+
+/* Timed bit-sliced batch encoding of at least 'iter' bursts */
+static double batch_encode_benchmark(const struct conv_test_vector *tst,
+				     int iter, int width)
+{
+	int i, num;
+	char engine[32];
+	ubit_t *bu;
+	pbit_t **in, **out;
+	struct vencbatch *batch;
+	struct timeval tv0, tv1;
+	double elapsed;
+
+	batch = conv_encoder_batch_create(tst->code, tst->rgen,
+					  tst->gen, width);
+	if (!batch)
+		return -1.0;
+
+	bu = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	in = alloc_frames(width);
+	out = alloc_frames(width);
+
+	for (i = 0; i < width; i++) {
+		fill_random(bu, tst->in_len);
+		osmo_ubit2pbit(in[i], bu, tst->in_len);
+	}
+
+	num = (iter + width - 1) / width;
+
+	printf("[..] Testing packed (batch %i):\n", width);
+	gettimeofday(&tv0, NULL);
+	for (i = 0; i < num; i++)
+		conv_encoder_batch_run(batch, (const pbit_t * const *) in, out);
+	gettimeofday(&tv1, NULL);
+	snprintf(engine, sizeof(engine), "batch%i", width);
+	elapsed = get_timed_results(&tv0, &tv1, tst, num * width, 1, engine);
+
+	free_frames(out, width);
+	free_frames(in, width);
+	free(bu);
+	conv_encoder_batch_free(batch);
+
+	return elapsed / (num * width) * iter;
+}
+
+/* Encoder benchmark
+ *     Unpacked encoding includes unpacking of the input bits, which callers
+ *     holding packed data need before using it.
+ */
+static int encode_benchmark(const struct conv_test_vector *tst, int iter)
+{
+	int i;
+	ubit_t *bu0, *bu1;
+	pbit_t *bp0, *bp1;
+	struct vencoder *enc;
+	struct timeval tv0, tv1;
+	double elapsed0, elapsed1, elapsed2, elapsed3;
+
+	enc = conv_encoder_create(tst->code, tst->rgen, tst->gen);
+	if (!enc) {
+		fprintf(stderr, "[!] Failed to create packed encoder\n");
+		return -1;
+	}
+
+	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
+	bp0 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+	bp1 = malloc(sizeof(pbit_t) * MAX_LEN_BYTES);
+
+	fill_random(bu0, tst->in_len);
+	osmo_ubit2pbit(bp0, bu0, tst->in_len);
+
+	printf("\n[.] Encoder benchmark:\n");
+	printf("[..] Encoding %i bursts:\n", iter);
+
+	printf("[..] Testing unpacked:\n");
+	gettimeofday(&tv0, NULL);
+	for (i = 0; i < iter; i++) {
+		osmo_pbit2ubit(bu0, bp0, tst->in_len);
+		test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
+	}
+	gettimeofday(&tv1, NULL);
+	elapsed0 = get_timed_results(&tv0, &tv1, tst, iter, 1, "unpacked");
+
+	printf("[..] Testing packed:\n");
+	gettimeofday(&tv0, NULL);
+	for (i = 0; i < iter; i++)
+		conv_encoder_run(enc, bp0, bp1);
+	gettimeofday(&tv1, NULL);
+	elapsed1 = get_timed_results(&tv0, &tv1, tst, iter, 1, "packed");
+
+	elapsed2 = batch_encode_benchmark(tst, iter, 64);
+	elapsed3 = batch_encode_benchmark(tst, iter, ENC_BATCH_MAX);
+
+	printf("[..] Speedup (packed)................... %f\n",
+	       elapsed0 / elapsed1);
+	if ((elapsed2 > 0.0) && (elapsed3 > 0.0)) {
+		printf("[..] Speedup (batch 64)................. %f\n",
+		       elapsed0 / elapsed2);
+		printf("[..] Speedup (batch %i)................ %f\n",
+		       ENC_BATCH_MAX, elapsed0 / elapsed3);
+	}
+
+	free(bp1);
+	free(bp0);
+	free(bu1);
+	free(bu0);
+	conv_encoder_free(enc);
+
+	return 0;
+}
+
+/* 8-bit path metrics are limited to K=5 and K=7 */
+static int metric8_supported(const struct conv_test_vector *tst)
+{
+	struct vdecoder *dec;
+
+	dec = conv_decoder_create_i8(tst->code);
+	if (!dec)
+		return 0;
+
+	conv_decoder_free(dec);
+	return 1;
+}
+
+/* Register exchange survivors are limited to short trellises */
+static int exchange_supported(const struct conv_test_vector *tst)
+{
+	int rc;
+	struct vdecoder *dec;
+
+	dec = conv_decoder_create(tst->code);
+	if (!dec)
+		return 0;
+
+	rc = conv_decoder_set_exchange(dec, 1);
+	conv_decoder_free(dec);
+
+	return rc == 0;
+}
+
+/* Codes with a generated decoder specialization */
+static int spec_supported(const struct conv_test_vector *tst)
+{
+	int rc;
+	struct vdecoder *dec;
+
+	dec = conv_decoder_create(tst->code);
+	if (!dec)
+		return 0;
+
+	rc = conv_decoder_set_specialized(dec, 1);
+	conv_decoder_free(dec);
+
+	return rc == 0;
+}
+
+/* Verify output lengths */
+static int length_test(const struct conv_test_vector *tst)
+{
+	int l;
+
+	l = osmo_conv_get_input_length(tst->code, 0);
+	printf("[.] Input length  : ret = %3d  exp = %3d -> %s\n",
+		l, tst->in_len, l == tst->in_len ? "OK" : "Bad !");
+
+	if (l != tst->in_len) {
+		fprintf(stderr, "[!] Failure for input length computation\n");
+		return -1;
+	}
+
+	l = osmo_conv_get_output_length(tst->code, 0);
+	printf("[.] Output length : ret = %3d  exp = %3d -> %s\n",
+		l, tst->out_len, l == tst->out_len ? "OK" : "Bad !");
+
+	if (l != tst->out_len) {
+		fprintf(stderr, "[!] Failure for output length computation\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Result fields in output order */
+enum result_field {
+	RES_TEST,
+	RES_CODE,
+	RES_K,
+	RES_N,
+	RES_ENGINE,
+	RES_SIMD,
+	RES_THREADS,
+	RES_ITER,
+	RES_BITS,
+	RES_MBPS,
+	RES_LAT,
+	RES_BER = RES_LAT + LAT_POINTS,
+	RES_FER,
+	RES_NUM_FIELDS,
+};
+
+static const char *result_field_name(int f)
+{
+	static const char *names[RES_NUM_FIELDS] = {
+		[RES_TEST]	= "test",
+		[RES_CODE]	= "code",
+		[RES_K]		= "k",
+		[RES_N]		= "n",
+		[RES_ENGINE]	= "engine",
+		[RES_SIMD]	= "simd",
+		[RES_THREADS]	= "threads",
+		[RES_ITER]	= "iter",
+		[RES_BITS]	= "bits",
+		[RES_MBPS]	= "mbps",
+		[RES_BER]	= "ber",
+		[RES_FER]	= "fer",
+	};
+
+	if ((f >= RES_LAT) && (f < RES_LAT + LAT_POINTS))
+		return lat_fields[f - RES_LAT];
+
+	return names[f];
+}
+
+/* String fields and their size, or NULL for numeric ones */
+static char *result_str(struct result *res, int f, size_t *len)
+{
+	switch (f) {
+	case RES_TEST:
+		*len = sizeof(res->test);
+		return res->test;
+	case RES_CODE:
+		*len = sizeof(res->code);
+		return res->code;
+	case RES_ENGINE:
+		*len = sizeof(res->engine);
+		return res->engine;
+	case RES_SIMD:
+		*len = sizeof(res->simd);
+		return res->simd;
+	}
+
+	return NULL;
+}
+
+/* Numeric fields, only valid where result_str() returns NULL */
+static double result_num(const struct result *res, int f)
+{
+	switch (f) {
+	case RES_K:
+		return res->k;
+	case RES_N:
+		return res->n;
+	case RES_THREADS:
+		return res->threads;
+	case RES_ITER:
+		return res->iter;
+	case RES_BITS:
+		return res->bits;
+	case RES_MBPS:
+		return res->mbps;
+	case RES_BER:
+		return res->ber;
+	case RES_FER:
+		return res->fer;
+	}
+
+	return res->lat[f - RES_LAT];
+}
+
+/* Set a field from its text value, empty or 'null' for NAN */
+static void result_set(struct result *res, int f, const char *val)
+{
+	size_t len;
+	char *str = result_str(res, f, &len);
+	double v = NAN;
+
+	if (str) {
+		snprintf(str, len, "%s", val);
+		return;
+	}
+
+	if (*val && strcmp(val, "null"))
+		v = strtod(val, NULL);
+
+	switch (f) {
+	case RES_K:
+		res->k = v;
+		break;
+	case RES_N:
+		res->n = v;
+		break;
+	case RES_THREADS:
+		res->threads = v;
+		break;
+	case RES_ITER:
+		res->iter = v;
+		break;
+	case RES_BITS:
+		res->bits = v;
+		break;
+	case RES_MBPS:
+		res->mbps = v;
+		break;
+	case RES_BER:
+		res->ber = v;
+		break;
+	case RES_FER:
+		res->fer = v;
+		break;
+	default:
+		res->lat[f - RES_LAT] = v;
+	}
+}
+
+static int result_field(const char *name)
+{
+	int f;
+
+	for (f = 0; f < RES_NUM_FIELDS; f++) {
+		if (!strcmp(name, result_field_name(f)))
+			return f;
+	}
+
+	return -1;
+}
+
+static FILE *open_output(const char *path)
+{
+	return strcmp(path, "-") ? fopen(path, "w") : stdout;
+}
+
+static void close_output(FILE *fp)
+{
+	if (fp != stdout)
+		fclose(fp);
+	else
+		fflush(fp);
+}
+
+/* Write results as CSV with a header row, empty fields for NAN */
+static int write_csv(const char *path)
+{
+	int i, f;
+	size_t len;
+	double v;
+	char *str;
+	FILE *fp;
+
+	fp = open_output(path);
+	if (!fp)
+		return -errno;
+
+	for (f = 0; f < RES_NUM_FIELDS; f++)
+		fprintf(fp, "%s%s", f ? "," : "", result_field_name(f));
+	fprintf(fp, "\n");
+
+	for (i = 0; i < num_results; i++) {
+		for (f = 0; f < RES_NUM_FIELDS; f++) {
+			if (f)
+				fprintf(fp, ",");
+			str = result_str(&results[i], f, &len);
+			if (str) {
+				fprintf(fp, "\"%s\"", str);
+				continue;
+			}
+			v = result_num(&results[i], f);
+			if (!isnan(v))
+				fprintf(fp, "%.9g", v);
+		}
+		fprintf(fp, "\n");
+	}
+
+	close_output(fp);
+
+	return 0;
+}
+
+/* Write results as a JSON array with one object per line, null for NAN */
+static int write_json(const char *path)
+{
+	int i, f;
+	size_t len;
+	double v;
+	char *str;
+	FILE *fp;
+
+	fp = open_output(path);
+	if (!fp)
+		return -errno;
+
+	fprintf(fp, "[\n");
+	for (i = 0; i < num_results; i++) {
+		fprintf(fp, "  {");
+		for (f = 0; f < RES_NUM_FIELDS; f++) {
+			fprintf(fp, "%s\"%s\": ", f ? ", " : "",
+				result_field_name(f));
+			str = result_str(&results[i], f, &len);
+			if (str) {
+				fprintf(fp, "\"%s\"", str);
+				continue;
+			}
+			v = result_num(&results[i], f);
+			if (!isnan(v))
+				fprintf(fp, "%.9g", v);
+			else
+				fprintf(fp, "null");
+		}
+		fprintf(fp, "}%s\n", i < num_results - 1 ? "," : "");
+	}
+	fprintf(fp, "]\n");
+
+	close_output(fp);
+
+	return 0;
+}
+
+/* Copy one possibly quoted value up to a delimiter
+ *     Returns a pointer past the value and its closing quote.
+ */
+static const char *parse_value(const char *p, const char *delim,
+			       char *val, int len)
+{
+	int n = 0;
+
+	while (*p == ' ')
+		p++;
+
+	if (*p == '"') {
+		for (p++; *p && (*p != '"'); p++) {
+			if ((*p == '\\') && p[1])
+				p++;
+			if (n < len - 1)
+				val[n++] = *p;
+		}
+		if (*p)
+			p++;
+	} else {
+		for (; *p && !strchr(delim, *p); p++) {
+			if (n < len - 1)
+				val[n++] = *p;
+		}
+		while (n && (val[n - 1] == ' '))
+			n--;
+	}
+	val[n] = '\0';
 
-	pthread_exit(NULL);
+	return p;
 }
 
-/* Fire off benchmark threads and measure elapsed time */
-static double run_benchmark(const struct conv_test_vector *tst,
-			    struct benchmark_thread_arg *args,
-			    int num_threads, int iter, int base)
+/* Parse one line of a JSON result file written by write_json() */
+static int parse_json_line(const char *p, struct result *res)
 {
-	int i, rc, err = 0;
-	void *status;
-	struct timeval tv0, tv1;
-	pthread_t threads[MAX_THREADS];
+	int f, num = 0;
+	char key[32], val[64];
 
-	for (i = 0; i < num_threads; i++) {
-		rc = init_thread_arg(&args[i], tst, iter, base);
-		if (rc < 0)
-			return -1.0;
-	}
+	p = strchr(p, '{');
+	if (!p)
+		return 0;
 
+	while ((p = strchr(p, '"'))) {
+		p = parse_value(p, "", key, sizeof(key));
+		p = strchr(p, ':');
+		if (!p)
+			break;
+		p = parse_value(p + 1, ",}\r\n", val, sizeof(val));
 
-	gettimeofday(&tv0, NULL);
-	for (i = 0; i < num_threads; i++) {
-		pthread_create(&threads[i], NULL,
-			       thread_test, (void *) &args[i]);
-	}
-	for (i = 0; i < num_threads; i++) {
-		pthread_join(threads[i], &status);
-		err |= args[i].err;
+		f = result_field(key);
+		if (f >= 0) {
+			result_set(res, f, val);
+			num++;
+		}
 	}
-	gettimeofday(&tv1, NULL);
 
-	if (err)
-		return -1.0;
+	return num;
+}
+
+/* Parse one CSV line against the column to field map of the header */
+static int parse_csv_line(const char *p, const int *cols, int num_cols,
+			  struct result *res)
+{
+	int c;
+	char val[64];
+
+	for (c = 0; c < num_cols; c++) {
+		p = parse_value(p, ",\r\n", val, sizeof(val));
+		if (cols[c] >= 0)
+			result_set(res, cols[c], val);
+		if (*p != ',')
+			break;
+		p++;
+	}
 
-	return get_timed_results(&tv0, &tv1, tst, iter, num_threads);
+	return c + 1;
 }
 
-/* Verify output values with predefined input */
-static int value_test(const struct conv_test_vector *tst)
+/* Load a result file written as JSON or CSV
+ *     The format is told by the first character. Returns the number of
+ *     records or a negative error.
+ */
+static int load_baseline(const char *path, struct result **list)
 {
-	int l;
-	sbit_t *bs;
-	ubit_t *bu0, *bu1;
+	int i, f, n = 0, num_cols = 0, json = -1;
+	int cols[RES_NUM_FIELDS * 2];
+	char line[1024], val[64];
+	const char *p;
+	struct result *res = NULL, *tmp, blank;
+	FILE *fp;
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return -errno;
+
+	memset(&blank, 0, sizeof(blank));
+	blank.mbps = blank.ber = blank.fer = NAN;
+	for (i = 0; i < LAT_POINTS; i++)
+		blank.lat[i] = NAN;
+
+	while (fgets(line, sizeof(line), fp)) {
+		for (p = line; (*p == ' ') || (*p == '\t'); p++);
+		if ((*p == '\n') || (*p == '\r') || !*p)
+			continue;
 
-	bu0 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
-	bu1 = malloc(sizeof(ubit_t) * MAX_LEN_BITS);
-	bs  = malloc(sizeof(sbit_t) * MAX_LEN_BITS);
+		/* Header row of a CSV file */
+		if (json < 0) {
+			json = (*p == '[') || (*p == '{');
+			if (!json) {
+				while (*p && (num_cols < RES_NUM_FIELDS * 2)) {
+					p = parse_value(p, ",\r\n",
+							val, sizeof(val));
+					cols[num_cols++] = result_field(val);
+					if (*p != ',')
+						break;
+					p++;
+				}
+				continue;
+			}
+		}
 
-	osmo_pbit2ubit(bu0, tst->vec_in, tst->in_len);
+		if (!(n & (n - 1))) {
+			tmp = realloc(res, sizeof(struct result) *
+				      (n ? n * 2 : 16));
+			if (!tmp) {
+				free(res);
+				fclose(fp);
+				return -ENOMEM;
+			}
+			res = tmp;
+		}
 
-	l = test_conv_encode(tst->code, tst->rgen, tst->gen, bu0, bu1);
-	if (l != tst->out_len) {
-		fprintf(stderr, "[!] Failed encoding length check (%i)\n", l);
-		return -1;
+		res[n] = blank;
+		if (json)
+			f = parse_json_line(p, &res[n]);
+		else
+			f = parse_csv_line(p, cols, num_cols, &res[n]);
+		if (f > 0)
+			n++;
 	}
 
-	osmo_pbit2ubit(bu0, tst->vec_out, tst->out_len);
+	fclose(fp);
+	*list = res;
 
-	if (memcmp(bu0, bu1, tst->out_len)) {
-		fprintf(stderr, "[!] Failed encoding: Results don't match\n");
-		return -1;
-	};
+	return n;
+}
 
-	printf("OK\n");
-	printf("[..] Decoding base: \n");
+static int same_result(const struct result *a, const struct result *b)
+{
+	return !strcmp(a->test, b->test) && !strcmp(a->code, b->code) &&
+	       !strcmp(a->engine, b->engine) && !strcmp(a->simd, b->simd) &&
+	       (a->threads == b->threads);
+}
 
-	ubit_to_sbit(bs, bu0, l);
-	l = osmo_conv_decode(tst->code, bs, bu1);
-	if (l != 0) {
-		fprintf(stderr, "[!] Failed decoding: non-zero path (%d)\n", l);
-		return -1;
+/* Compare results against a baseline
+ *     Records are matched by test, code, engine, kernel set and thread
+ *     count, repeated records in the order they were measured. Throughput
+ *     may drop by 'tol' percent. BER and FER may rise by 'ber_tol' percent
+ *     plus one error event, since they are measured on random bursts.
+ *     Results without a baseline record and baseline records the run did
+ *     not reproduce fail the comparison unless 'allow_missing' is set, and
+ *     so does a run that compared nothing.
+ *     Returns the number of failures or a negative error.
+ */
+static int compare_baseline(const char *path, float tol, float ber_tol,
+			    int allow_missing)
+{
+	int i, j, n, seen, num, fails = 0, missing = 0, compared = 0;
+	int unmatched;
+	double limit;
+	const struct result *r, *b;
+	struct result *base = NULL;
+	char *matched;
+
+	num = load_baseline(path, &base);
+	if (num < 0) {
+		fprintf(stderr, "[!] Failed to load baseline '%s': %s\n",
+			path, strerror(-num));
+		return num;
 	}
 
-	osmo_pbit2ubit(bu0, tst->vec_in, tst->in_len);
-	if (memcmp(bu0, bu1, tst->in_len)) {
-		fprintf(stderr, "[!] Failed decoding: Results don't match\n");
-		return -1;
+	matched = calloc(num ? num : 1, 1);
+	if (!matched) {
+		free(base);
+		return -ENOMEM;
 	}
 
-	printf("[..] Decoding SIMD: \n");
-	printf("[..] Code N %i\n", tst->code->N);
-	printf("[..] Code K %i\n", tst->code->K);
-	l = test_conv_decode(tst->code, bs, bu1);
-	if (l != 0) {
-		fprintf(stderr,
-			"[!] Failed decoding: SIMD non-zero path (%d)\n", l);
-		return -1;
-	}
+	printf("\n[+] Comparing %i results against baseline %s:\n",
+	       num_results, path);
 
-	osmo_pbit2ubit(bu0, tst->vec_in, tst->in_len);
-	if (memcmp(bu0, bu1, tst->in_len)) {
-		fprintf(stderr, "[!] Failed decoding: Results don't match\n");
-		return -1;
-	}
+	for (i = 0; i < num_results; i++) {
+		r = &results[i];
 
-	free(bs);
-	free(bu1);
-	free(bu0);
+		for (j = 0, seen = 0; j < i; j++)
+			seen += same_result(&results[j], r);
 
-	printf("[..] Decoding: OK\n");
-	return 0;
-}
+		for (j = 0, n = 0, b = NULL; j < num; j++) {
+			if (same_result(&base[j], r) && (n++ == seen)) {
+				b = &base[j];
+				matched[j] = 1;
+				break;
+			}
+		}
 
-/* Verify output lengths */
-static int length_test(const struct conv_test_vector *tst)
-{
-	int l;
+		if (!b) {
+			missing++;
+			continue;
+		}
+		compared++;
+
+		if (!isnan(r->mbps) && !isnan(b->mbps)) {
+			limit = b->mbps * (1.0 - tol / 100.0);
+			if (r->mbps < limit) {
+				printf("[!] %s %s %s (%s, %i thread(s)): "
+				       "%.3f Mbps vs %.3f Mbps (%+.1f%%)\n",
+				       r->test, r->code, r->engine, r->simd,
+				       r->threads, r->mbps, b->mbps,
+				       100.0 * (r->mbps / b->mbps - 1.0));
+				fails++;
+			}
+		}
 
-	l = osmo_conv_get_input_length(tst->code, 0);
-	printf("[.] Input length  : ret = %3d  exp = %3d -> %s\n",
-		l, tst->in_len, l == tst->in_len ? "OK" : "Bad !");
+		if (!isnan(r->ber) && !isnan(b->ber)) {
+			limit = b->ber * (1.0 + ber_tol / 100.0) +
+				1.0 / ((double) r->iter * r->bits);
+			if (r->ber > limit) {
+				printf("[!] %s %s %s (%s): BER %f vs %f\n",
+				       r->test, r->code, r->engine, r->simd,
+				       r->ber, b->ber);
+				fails++;
+			}
+		}
 
-	if (l != tst->in_len) {
-		fprintf(stderr, "[!] Failure for input length computation\n");
-		return -1;
+		if (!isnan(r->fer) && !isnan(b->fer)) {
+			limit = b->fer * (1.0 + ber_tol / 100.0) +
+				1.0 / r->iter;
+			if (r->fer > limit) {
+				printf("[!] %s %s %s (%s): FER %f vs %f\n",
+				       r->test, r->code, r->engine, r->simd,
+				       r->fer, b->fer);
+				fails++;
+			}
+		}
 	}
 
-	l = osmo_conv_get_output_length(tst->code, 0);
-	printf("[.] Output length : ret = %3d  exp = %3d -> %s\n",
-		l, tst->out_len, l == tst->out_len ? "OK" : "Bad !");
+	for (j = 0, unmatched = 0; j < num; j++) {
+		if (matched[j])
+			continue;
+		if (!allow_missing)
+			printf("[!] %s %s %s (%s, %i thread(s)): "
+			       "not reproduced\n", base[j].test, base[j].code,
+			       base[j].engine, base[j].simd, base[j].threads);
+		unmatched++;
+	}
 
-	if (l != tst->out_len) {
-		fprintf(stderr, "[!] Failure for output length computation\n");
-		return -1;
+	printf("[+] Baseline: %i compared, %i not in baseline, "
+	       "%i not reproduced, %i regression(s)\n",
+	       compared, missing, unmatched, fails);
+
+	if (missing && !allow_missing) {
+		printf("[!] %i result(s) not in baseline\n", missing);
+		fails++;
+	}
+	if (unmatched && !allow_missing) {
+		printf("[!] %i baseline record(s) not reproduced\n",
+		       unmatched);
+		fails++;
+	}
+	if (!compared) {
+		printf("[!] No results matched the baseline\n");
+		fails++;
 	}
 
-	return 0;
+	free(matched);
+	free(base);
+
+	return fails;
 }
 
 static void print_help()
@@ -714,21 +3231,87 @@ static void print_help()
 	fprintf(stdout, "Options:\n"
 		"  -h    This text\n"
 		"  -i    Number of iterations\n"
-		"  -j    Number of threads for benchmark (EXPERIMENTAL)\n"
+		"  -j    Number of threads for benchmark\n"
 		"  -a    Run all tests\n"
 		"  -b    Run benchmark tests\n"
 		"  -n    Run length checks\n"
 		"  -e    Run bit error rate tests\n"
+		"  -w    Run windowed stream decoder tests\n"
 		"  -s    Skip baseline decoder\n"
-		"  -r    Specify SNR in dB (default %2.1f dB)\n"
+		"  -r    Specify SNR in dB of test and benchmark input\n"
+		"        (default %2.1f dB)\n"
 		"  -o    Run baseline decoder only\n"
 		"  -c    Test specific code\n"
-		"  -l    List supported codes\n", DEFAULT_SOFT_SNR);
+		"  -k    Select SIMD kernel set ('list' to show available,\n"
+		"        'all' to benchmark each available set)\n"
+		"  -B, --batch <n>\n"
+		"        Also test batch decoding of 2, 4, 8 or 16 bursts\n"
+		"  -8    Also test decoding with 8-bit path metrics\n"
+		"  -m    Also test decoding with modulo path metrics\n"
+		"  -p    Also test decoding into packed output\n"
+		"  -x    Also test register exchange survivors on codes\n"
+		"        of up to 64 trellis steps\n"
+		"  -g    Also test the generic decoder path on codes with\n"
+		"        a generated specialization\n"
+		"  -A    Also test the workspace decoder and count heap\n"
+		"        allocations in the benchmark decode loops\n"
+		"  -E    Run encoder benchmark\n"
+		"  -S, --sweep <n>\n"
+		"        Run thread scaling sweep from 1 to n threads\n"
+		"  -P, --pin <policy>\n"
+		"        Pin benchmark threads 'compact', 'scatter' or\n"
+		"        'core' (one per physical core), default 'none'\n"
+		"  -R, --fifo\n"
+		"        Run benchmark threads with SCHED_FIFO priority\n"
+		"  -H, --counters\n"
+		"        Report hardware performance counters per decoded\n"
+		"        bit and trellis step in the benchmarks\n"
+		"      --json <file>\n"
+		"        Write results as JSON ('-' for stdout)\n"
+		"      --csv <file>\n"
+		"        Write results as CSV ('-' for stdout)\n"
+		"      --baseline <file>\n"
+		"        Compare results against a JSON or CSV result\n"
+		"        file and exit non-zero on regressions or\n"
+		"        records missing from either side\n"
+		"      --allow-missing\n"
+		"        Ignore records missing from either side\n"
+		"      --tolerance <pct>\n"
+		"        Allowed throughput drop (default %2.1f%%)\n"
+		"      --ber-tolerance <pct>\n"
+		"        Allowed BER and FER rise (default %2.1f%%)\n"
+		"  -l    List supported codes\n", DEFAULT_SOFT_SNR,
+		DEFAULT_TOLERANCE, DEFAULT_BER_TOLERANCE);
 }
 
+/* Options without a short form */
+enum {
+	OPT_JSON = 256,
+	OPT_CSV,
+	OPT_BASELINE,
+	OPT_TOL,
+	OPT_BER_TOL,
+	OPT_ALLOW_MISSING,
+};
+
+static const struct option long_options[] = {
+	{ "batch", required_argument, NULL, 'B' },
+	{ "sweep", required_argument, NULL, 'S' },
+	{ "pin", required_argument, NULL, 'P' },
+	{ "fifo", no_argument, NULL, 'R' },
+	{ "counters", no_argument, NULL, 'H' },
+	{ "json", required_argument, NULL, OPT_JSON },
+	{ "csv", required_argument, NULL, OPT_CSV },
+	{ "baseline", required_argument, NULL, OPT_BASELINE },
+	{ "tolerance", required_argument, NULL, OPT_TOL },
+	{ "ber-tolerance", required_argument, NULL, OPT_BER_TOL },
+	{ "allow-missing", no_argument, NULL, OPT_ALLOW_MISSING },
+	{ NULL, 0, NULL, 0 },
+};
+
 static void handle_options(int argc, char **argv, struct cmd_options *cmd)
 {
-	int option;
+	int i, option;
 
 	cmd->iter = DEFAULT_ITER;
 	cmd->threads = DEFAULT_THREADS;
@@ -737,10 +3320,33 @@ static void handle_options(int argc, char **argv, struct cmd_options *cmd)
 	cmd->skip = 0;
 	cmd->base = 0;
 	cmd->ber = 0;
+	cmd->stream = 0;
 	cmd->num = 0;
 	cmd->snr = DEFAULT_SOFT_SNR;
-
-	while ((option = getopt(argc, argv, "hi:baesoc:r:lj:")) != -1) {
+	cmd->simd = NULL;
+	cmd->simd_all = 0;
+	cmd->batch = 0;
+	cmd->metric8 = 0;
+	cmd->modulo = 0;
+	cmd->packed = 0;
+	cmd->exchange = 0;
+	cmd->generic = 0;
+	cmd->encode = 0;
+	cmd->allocs = 0;
+	cmd->sweep = 0;
+	cmd->pin = PIN_NONE;
+	cmd->fifo = 0;
+	cmd->json = NULL;
+	cmd->csv = NULL;
+	cmd->baseline = NULL;
+	cmd->tol = DEFAULT_TOLERANCE;
+	cmd->ber_tol = DEFAULT_BER_TOLERANCE;
+	cmd->missing = 0;
+	cmd->counters = 0;
+
+	while ((option = getopt_long(argc, argv,
+				     "hi:baeswoc:r:lj:k:B:8mpxgAES:P:RH",
+				     long_options, NULL)) != -1) {
 		switch (option) {
 		case 'h':
 			print_help();
@@ -767,6 +3373,9 @@ static void handle_options(int argc, char **argv, struct cmd_options *cmd)
 		case 'e':
 			cmd->ber = 1;
 			break;
+		case 'w':
+			cmd->stream = 1;
+			break;
 		case 's':
 			cmd->skip = 1;
 			break;
@@ -787,22 +3396,113 @@ static void handle_options(int argc, char **argv, struct cmd_options *cmd)
 			print_codes();
 			exit(0);
 			break;
+		case 'k':
+			if (!strcmp(optarg, "list")) {
+				print_simd_variants();
+				exit(0);
+			}
+			if (!strcmp(optarg, "all")) {
+				cmd->simd_all = 1;
+				break;
+			}
+			cmd->simd = optarg;
+			break;
+		case 'B':
+			cmd->batch = atoi(optarg);
+			if ((cmd->batch != 2) && (cmd->batch != 4) &&
+			    (cmd->batch != 8) && (cmd->batch != 16)) {
+				printf("Batch width must be 2, 4, 8 or 16\n");
+				exit(0);
+			}
+			break;
+		case '8':
+			cmd->metric8 = 1;
+			break;
+		case 'm':
+			cmd->modulo = 1;
+			break;
+		case 'p':
+			cmd->packed = 1;
+			break;
+		case 'x':
+			cmd->exchange = 1;
+			break;
+		case 'g':
+			cmd->generic = 1;
+			break;
+		case 'A':
+			if (!ALLOC_COUNT_SUPPORTED) {
+				printf("Allocation counting requires glibc\n");
+				exit(0);
+			}
+			cmd->allocs = 1;
+			break;
+		case 'E':
+			cmd->encode = 1;
+			break;
 		case 'j':
 			cmd->threads = atoi(optarg);
-			if ((cmd->threads < 1) ||
-			    (cmd->threads > MAX_THREADS)) {
-				printf("Threads must be between 1 to %i\n",
-				       MAX_THREADS);
+			if (cmd->threads < 1) {
+				printf("Threads must be at least 1\n");
+				exit(0);
+			}
+			break;
+		case 'S':
+			cmd->sweep = atoi(optarg);
+			if (cmd->sweep < 1) {
+				printf("Sweep threads must be at least 1\n");
 				exit(0);
 			}
 			break;
+		case 'P':
+			for (i = 0; i < ARRAY_SIZE(pin_names); i++) {
+				if (!strcmp(optarg, pin_names[i]))
+					break;
+			}
+			if (i == ARRAY_SIZE(pin_names)) {
+				printf("Placement must be none, compact, "
+				       "scatter or core\n");
+				exit(0);
+			}
+			cmd->pin = i;
+			break;
+		case 'R':
+			cmd->fifo = 1;
+			break;
+		case 'H':
+			cmd->counters = 1;
+			break;
+		case OPT_JSON:
+			cmd->json = optarg;
+			break;
+		case OPT_CSV:
+			cmd->csv = optarg;
+			break;
+		case OPT_BASELINE:
+			cmd->baseline = optarg;
+			break;
+		case OPT_TOL:
+		case OPT_BER_TOL:
+			if (atof(optarg) < 0.0) {
+				printf("Tolerance must not be negative\n");
+				exit(0);
+			}
+			if (option == OPT_TOL)
+				cmd->tol = atof(optarg);
+			else
+				cmd->ber_tol = atof(optarg);
+			break;
+		case OPT_ALLOW_MISSING:
+			cmd->missing = 1;
+			break;
 		default:
 			print_help();
 			exit(0);
 		}
 	}
 
-	if (!cmd->bench && !cmd->length && !cmd->ber) {
+	if (!cmd->bench && !cmd->length && !cmd->ber &&
+	    !cmd->stream && !cmd->encode && !cmd->sweep) {
 		cmd->length = 1;
 		cmd->ber = 1;
 	}
@@ -810,17 +3510,59 @@ static void handle_options(int argc, char **argv, struct cmd_options *cmd)
 
 int main(int argc, char *argv[])
 {
-	int cnt = 0;
+	int cnt = 0, rc = 0;
 	const struct conv_test_vector *tst;
-	double elapsed0 = 0.0, elapsed1 = 0.0;
-	struct benchmark_thread_arg args[MAX_THREADS * 2];
+	const struct stream_test_vector *stst;
+	double elapsed0 = 0.0, elapsed1 = 0.0, elapsed2 = 0.0, elapsed3 = 0.0;
+	double elapsed4 = 0.0, elapsed5 = 0.0, elapsed6 = 0.0, elapsed7 = 0.0;
+	double elapsed8 = 0.0, elapsed9 = 0.0;
+	int metric8, exchange, generic;
+	struct benchmark_thread_arg *args;
 	struct cmd_options cmd;
 
 	handle_options(argc, argv, &cmd);
 
+	args = malloc(sizeof(struct benchmark_thread_arg) *
+		      (cmd.sweep > cmd.threads ? cmd.sweep : cmd.threads));
+	if (!args)
+		return -1;
+
+	if (cmd.simd && conv_simd_select(cmd.simd) < 0) {
+		fprintf(stderr, "[!] SIMD kernel set '%s' not available\n",
+			cmd.simd);
+		return -1;
+	}
+
+	printf("[+] SIMD kernel set: %s\n", conv_simd_current());
+
+	alloc_check = cmd.allocs;
+	fifo_prio = cmd.fifo;
+	pin_policy = cmd.pin;
+	hw_counters = cmd.counters;
+
+	if (hw_counters && ((rc = hw_probe()) < 0)) {
+		fprintf(stderr, "[!] Hardware counters not available: %s\n",
+			strerror(-rc));
+		rc = 0;
+	}
+
+	if (pin_policy != PIN_NONE) {
+		num_pin_cpus = pin_cpu_list(pin_policy, &pin_cpus);
+		if (num_pin_cpus < 1) {
+			fprintf(stderr, "[!] Failed to list CPUs for '%s' "
+				"placement\n", pin_names[pin_policy]);
+			return -1;
+		}
+		printf("[+] Thread placement: %s over %i CPUs\n",
+		       pin_names[pin_policy], num_pin_cpus);
+	}
+
 	srandom(time(NULL));
 
 	for (tst=tests; tst->name; tst++) {
+		if (!cmd.length && !cmd.ber && !cmd.bench &&
+		    !cmd.encode && !cmd.sweep)
+			break;
 		if ((cmd.num > 0) && (cmd.num != ++cnt))
 			continue;
 
@@ -833,6 +3575,10 @@ int main(int argc, char *argv[])
 		if (length_test(tst) < 0)
 			return -1;
 
+		metric8 = cmd.metric8 && metric8_supported(tst);
+		exchange = cmd.exchange && exchange_supported(tst);
+		generic = cmd.generic && spec_supported(tst);
+
 		/* Check pre-computed vector */
 		if (cmd.length && tst->has_vec) {
 			printf("[.] Pre computed vector checks:\n");
@@ -842,54 +3588,296 @@ int main(int argc, char *argv[])
 				return -1;
 		}
 
+		/* Check packed encoder */
+		if (cmd.length && (packed_test(tst) < 0))
+			return -1;
+		if (cmd.length && (batch_encode_test(tst) < 0))
+			return -1;
+		if (cmd.length && (packed_decode_test(tst, cmd.snr) < 0))
+			return -1;
+		if (cmd.length && (full_scale_test(tst, cmd.snr) < 0))
+			return -1;
+
 		/* BER tests */
 		if (cmd.ber) {
 			printf("\n[.] BER tests:\n");
 			if (!cmd.skip) {
 				printf("[..] Testing base:\n");
-				if (error_test(tst, cmd.iter, cmd.snr, 1) < 0)
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_BASE) < 0)
 					return -1;
 			}
 
 			if (!cmd.base) {
 				printf("[..] Testing SIMD:\n");
-				if (error_test(tst, cmd.iter, cmd.snr, 0) < 0)
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_SIMD) < 0)
+					return -1;
+
+				printf("[..] Testing SIMD (persistent):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_PERSIST) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && cmd.batch) {
+				printf("[..] Testing SIMD (batch %i):\n",
+				       cmd.batch);
+				if (batch_error_test(tst, cmd.iter,
+						     cmd.snr, cmd.batch) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && metric8) {
+				printf("[..] Testing SIMD (8-bit):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_METRIC8) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && cmd.modulo) {
+				printf("[..] Testing SIMD (modulo):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_MODULO) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && cmd.packed) {
+				printf("[..] Testing SIMD (packed):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_PACKED) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && exchange) {
+				printf("[..] Testing SIMD (exchange):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_EXCHANGE) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && generic) {
+				printf("[..] Testing SIMD (generic path):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_GENERIC) < 0)
+					return -1;
+			}
+
+			if (!cmd.base && cmd.allocs) {
+				printf("[..] Testing SIMD (workspace):\n");
+				if (error_test(tst, cmd.iter,
+					       cmd.snr, DEC_WORKSPACE) < 0)
 					return -1;
 			}
 		}
 
+		if (cmd.encode && (encode_benchmark(tst, cmd.iter) < 0))
+			return -1;
+
+		if (cmd.sweep && !cmd.base &&
+		    (sweep_benchmark(tst, args, cmd.sweep,
+				     cmd.iter, cmd.snr) < 0)) {
+			rc = -1;
+			goto shutdown;
+		}
+
 		if (!cmd.bench)
 			continue;
 
 		/* Timed benchmark tests */
 		printf("\n[.] Performance benchmark:\n");
-		printf("[..] Encoding / Decoding %i bursts on %i thread(s):\n",
-		       cmd.iter * cmd.threads, cmd.threads);
+		printf("[..] Decoding %i noisy bursts at %2.1f dB SNR "
+		       "on %i thread(s):\n",
+		       cmd.iter * cmd.threads, cmd.snr, cmd.threads);
 
 		if (!cmd.skip) {
 			printf("[..] Testing base:\n");
-			elapsed0 = run_benchmark(tst, args,
-						 cmd.threads, cmd.iter, 1);
-			if (elapsed0 < 0.0)
+			elapsed0 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_BASE, 0,
+						 cmd.snr);
+			if (elapsed0 < 0.0) {
+				rc = -1;
 				goto shutdown;
+			}
 		}
 
 		if (!cmd.base) {
 			printf("[..] Testing SIMD:\n");
-			elapsed1 = run_benchmark(tst, args,
-						 cmd.threads, cmd.iter, 0);
-			if (elapsed1 < 0.0)
+			elapsed1 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_SIMD, 0,
+						 cmd.snr);
+			if (elapsed1 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+
+			printf("[..] Testing SIMD (persistent):\n");
+			elapsed2 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_PERSIST, 0,
+						 cmd.snr);
+			if (elapsed2 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && cmd.batch) {
+			printf("[..] Testing SIMD (batch %i):\n", cmd.batch);
+			elapsed3 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_BATCH,
+						 cmd.batch, cmd.snr);
+			if (elapsed3 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && metric8) {
+			printf("[..] Testing SIMD (8-bit):\n");
+			elapsed4 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_METRIC8, 0,
+						 cmd.snr);
+			if (elapsed4 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && cmd.modulo) {
+			printf("[..] Testing SIMD (modulo):\n");
+			elapsed5 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_MODULO, 0,
+						 cmd.snr);
+			if (elapsed5 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && cmd.packed) {
+			printf("[..] Testing SIMD (packed):\n");
+			elapsed6 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_PACKED, 0,
+						 cmd.snr);
+			if (elapsed6 < 0.0) {
+				rc = -1;
 				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && exchange) {
+			printf("[..] Testing SIMD (exchange):\n");
+			elapsed7 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_EXCHANGE, 0,
+						 cmd.snr);
+			if (elapsed7 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && generic) {
+			printf("[..] Testing SIMD (generic path):\n");
+			elapsed8 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_GENERIC, 0,
+						 cmd.snr);
+			if (elapsed8 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
+		}
+
+		if (!cmd.base && cmd.allocs) {
+			printf("[..] Testing SIMD (workspace):\n");
+			elapsed9 = run_benchmark(tst, args, cmd.threads,
+						 cmd.iter, DEC_WORKSPACE, 0,
+						 cmd.snr);
+			if (elapsed9 < 0.0) {
+				rc = -1;
+				goto shutdown;
+			}
 		}
 
 		if (!cmd.skip && !cmd.base) {
 			printf("[..] Speedup............................ %f\n",
 			       elapsed0 / elapsed1);
+			printf("[..] Speedup (persistent)............... %f\n",
+			       elapsed0 / elapsed2);
+			if (cmd.batch)
+				printf("[..] Speedup (batch)"
+				       ".................... %f\n",
+				       elapsed0 / elapsed3);
+			if (metric8)
+				printf("[..] Speedup (8-bit)"
+				       ".................... %f\n",
+				       elapsed0 / elapsed4);
+			if (cmd.modulo)
+				printf("[..] Speedup (modulo)"
+				       "................... %f\n",
+				       elapsed0 / elapsed5);
+		}
+
+		if (!cmd.base && cmd.modulo)
+			printf("[..] Modulo vs persistent............... %f\n",
+			       elapsed2 / elapsed5);
+
+		if (!cmd.base && cmd.packed)
+			printf("[..] Packed vs persistent............... %f\n",
+			       elapsed2 / elapsed6);
+
+		if (!cmd.base && exchange)
+			printf("[..] Exchange vs persistent............. %f\n",
+			       elapsed2 / elapsed7);
+
+		if (!cmd.base && generic)
+			printf("[..] Specialized vs generic............. %f\n",
+			       elapsed8 / elapsed2);
+
+		if (!cmd.base && cmd.allocs)
+			printf("[..] Workspace vs all-in-one............ %f\n",
+			       elapsed1 / elapsed9);
+
+		if (cmd.simd_all && !cmd.base) {
+			if (compare_kernels(tst, args, cmd.threads,
+					    cmd.iter, cmd.snr) < 0) {
+				rc = -1;
+				goto shutdown;
+			}
 		}
 		printf("\n");
 	}
 	printf("\n");
 
+	for (stst = streams; cmd.stream && stst->name; stst++) {
+		printf("\n=================================================\n");
+		printf("[+] Testing stream: %s\n", stst->name);
+		printf("[.] Specs: %s\n", stst->spec);
+		printf("[.] Stream length: %i bits\n", stst->code->len);
+
+		printf("\n[.] Windowed BER tests:\n");
+		if (stream_test(stst, cmd.snr) < 0)
+			return -1;
+	}
+
 shutdown:
-	return 0;
+	print_cache_stats();
+	conv_trellis_cache_flush();
+	free(pin_cpus);
+	free(args);
+
+	if (cmd.json && (write_json(cmd.json) < 0)) {
+		fprintf(stderr, "[!] Failed to write '%s'\n", cmd.json);
+		rc = -1;
+	}
+	if (cmd.csv && (write_csv(cmd.csv) < 0)) {
+		fprintf(stderr, "[!] Failed to write '%s'\n", cmd.csv);
+		rc = -1;
+	}
+	if (cmd.baseline &&
+	    compare_baseline(cmd.baseline, cmd.tol, cmd.ber_tol, cmd.missing))
+		rc = 1;
+
+	free(results);
+
+	return rc;
 }